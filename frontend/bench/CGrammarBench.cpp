@@ -0,0 +1,396 @@
+// Scale benchmark of the parser on the ANSI C grammar of ast/CGrammar.hpp.
+//
+// Builds its tables from scratch, then parses a generated translation unit
+// of a few megabytes: lexing alone, the full parse into an AST, and the
+// event parse that builds nothing. A second corpus that never makes GLR
+// fork compares it with LR on unambiguous input. Exits with an error when
+// a corpus does not parse, so it doubles as a regression test at a
+// realistic size.
+//
+// usage: c_grammar_bench [corpus megabytes]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+
+#include "ast/CGrammar.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/ActionTable.hpp"
+#include "parser/GLRParser.hpp"
+#include "parser/Parser.hpp"
+#include "tokens/TokenStream.hpp"
+
+using namespace compiler;
+
+namespace {
+  // Keeps the optimizer from dropping the work being measured.
+  volatile size_t sink = 0;
+
+  double measure(const std::function<void()>& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  size_t tableBytes(const ActionTable& table) {
+    return table.actions.size() * sizeof(Action) +
+           table.gotos.size() * sizeof(uint32_t);
+  }
+
+  size_t countTokens(const std::string& source) {
+    Lexer lexer("corpus.c", source);
+    size_t count = 0;
+    while (true) {
+      Lexer::LexerResult result = lexer.advance();
+      if (!result || result->type == TokenType::ENDOF) break;
+      ++count;
+    }
+    return count;
+  }
+
+  // Writes random but well-formed C: globals, struct and enum types,
+  // prototypes and function bodies that use every kind of statement and
+  // expression the grammar has.
+  class CorpusWriter {
+  public:
+    // A forkless corpus stays clear of the conflict cells of the grammar:
+    // no assignment statements, no else and no name right before the `:`
+    // of a conditional.
+    explicit CorpusWriter(uint32_t seed, bool forkless = false)
+        : rng(seed), forkless(forkless) {}
+
+    std::string write(size_t bytes) {
+      out.reserve(bytes + 4096);
+      while (out.size() < bytes) externalDeclaration();
+      return std::move(out);
+    }
+
+  private:
+    static constexpr const char* TYPES[] = {
+        "int",         "char",          "unsigned long", "const double",
+        "short",       "signed char",   "float",         "struct point",
+        "enum color",  "volatile long", "void *",        "unsigned"};
+    static constexpr const char* BINARY[] = {
+        "+",  "-",  "*",  "/",  "%",  "<<", ">>", "<", ">",
+        "<=", ">=", "==", "!=", "&",  "^",  "|",  "&&", "||"};
+    static constexpr const char* ASSIGN[] = {"=",  "+=", "-=", "*=",
+                                             "<<=", "|=", "&="};
+    static constexpr const char* UNARY[] = {"-", "!", "~", "*", "&"};
+
+    std::mt19937 rng;
+    bool forkless;
+    std::string out;
+    size_t names = 0;
+
+    size_t pick(size_t n) { return rng() % n; }
+
+    template <size_t N>
+    const char* pick(const char* const (&items)[N]) {
+      return items[pick(N)];
+    }
+
+    void name() { out += "v" + std::to_string(pick(64)); }
+
+    void fresh() { out += "n" + std::to_string(names++); }
+
+    void expr(size_t depth) {
+      if (depth == 0) {
+        switch (pick(3)) {
+          case 0: name(); break;
+          case 1: out += std::to_string(pick(1000)); break;
+          default: out += "'c'"; break;
+        }
+        return;
+      }
+
+      switch (pick(12)) {
+        case 0: case 1: case 2: case 3:
+          expr(depth - 1);
+          out += " ";
+          out += pick(BINARY);
+          out += " ";
+          expr(depth - 1);
+          break;
+        case 4:
+          // Parenthesized so that "-" and "-x" never lex as "--x"
+          out += pick(UNARY);
+          out += "(";
+          expr(depth - 1);
+          out += ")";
+          break;
+        case 5:
+          out += "(";
+          expr(depth - 1);
+          out += ")";
+          break;
+        case 6:
+          name();
+          out += "(";
+          for (size_t i = pick(4); i > 0; --i) {
+            expr(depth - 1);
+            if (i > 1) out += ", ";
+          }
+          out += ")";
+          break;
+        case 7:
+          name();
+          out += "[";
+          expr(depth - 1);
+          out += "]";
+          break;
+        case 8:
+          if (pick(2)) out += "++";
+          name();
+          out += pick(2) ? ".x" : "->next->y";
+          break;
+        case 9:
+          out += pick(2) ? "(int)" : "(char *)";
+          expr(depth - 1);
+          break;
+        case 10:
+          out += pick(2) ? "sizeof(struct point)" : "sizeof v1";
+          break;
+        default:
+          expr(depth - 1);
+          out += forkless ? " ? (" : " ? ";
+          expr(depth - 1);
+          out += forkless ? ") : " : " : ";
+          expr(depth - 1);
+          break;
+      }
+    }
+
+    void declaration() {
+      out += pick(TYPES);
+      out += " ";
+      switch (pick(4)) {
+        case 0: fresh(); break;
+        case 1: out += "*"; fresh(); break;
+        case 2: fresh(); out += "[16]"; break;
+        default: fresh(); out += " = "; expr(2); break;
+      }
+      out += ";\n";
+    }
+
+    void indent(size_t level) { out.append(2 * level, ' '); }
+
+    void statement(size_t depth, size_t level) {
+      indent(level);
+      switch (depth == 0 ? 0 : pick(10)) {
+        case 0: case 1: case 2: case 3:
+          if (pick(3) == 0 && !forkless) {
+            name();
+            out += " ";
+            out += pick(ASSIGN);
+            out += " ";
+          }
+          expr(3);
+          out += ";\n";
+          break;
+        case 4:
+          out += "if (";
+          expr(2);
+          out += ")\n";
+          statement(depth - 1, level + 1);
+          if (pick(2) && !forkless) {
+            indent(level);
+            out += "else\n";
+            statement(depth - 1, level + 1);
+          }
+          break;
+        case 5:
+          out += "while (";
+          expr(2);
+          out += ")\n";
+          statement(depth - 1, level + 1);
+          break;
+        case 6:
+          out += forkless ? "for (v1++; v1 < " : "for (v1 = 0; v1 < ";
+          expr(1);
+          out += "; v1++)\n";
+          statement(depth - 1, level + 1);
+          break;
+        case 7:
+          out += "do\n";
+          statement(depth - 1, level + 1);
+          indent(level);
+          out += "while (";
+          expr(1);
+          out += ");\n";
+          break;
+        case 8:
+          out += "switch (";
+          name();
+          out += ") {\n";
+          for (size_t i = 1 + pick(3); i > 0; --i) {
+            indent(level);
+            out += "case " + std::to_string(i) + ":\n";
+            statement(depth - 1, level + 1);
+            indent(level + 1);
+            out += "break;\n";
+          }
+          indent(level);
+          out += "default:\n";
+          statement(0, level + 1);
+          indent(level);
+          out += "}\n";
+          break;
+        default:
+          compound(depth - 1, level);
+          break;
+      }
+    }
+
+    void compound(size_t depth, size_t level) {
+      out += "{\n";
+      for (size_t i = pick(3); i > 0; --i) {
+        indent(level + 1);
+        declaration();
+      }
+      for (size_t i = 1 + pick(5); i > 0; --i) {
+        statement(depth, level + 1);
+      }
+      indent(level + 1);
+      out += "return ";
+      expr(2);
+      out += ";\n";
+      indent(level);
+      out += "}\n";
+    }
+
+    void externalDeclaration() {
+      switch (pick(8)) {
+        case 0:
+          out += "struct point { int x; int y; struct point *next; };\n";
+          break;
+        case 1:
+          out += "enum color { RED, GREEN = 2, BLUE };\n";
+          break;
+        case 2:
+          out += "static int ";
+          fresh();
+          out += "(int a, char *b, ...);\n";
+          break;
+        case 3:
+          declaration();
+          break;
+        default:
+          out += pick(TYPES);
+          out += " ";
+          fresh();
+          out += "(int a, const char *b)\n";
+          compound(3, 0);
+          break;
+      }
+    }
+  };
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+  const Grammar grammar = C_GRAMMAR.toGrammar();
+
+  // Table construction, on one thread and on every hardware thread
+  for (bool skip_unit_rules : {false, true}) {
+    for (size_t threads : {size_t{1}, size_t{0}}) {
+      size_t states = 0;
+      size_t bytes = 0;
+      const double seconds = measure([&] {
+        const ActionTable table(grammar, threads, skip_unit_rules);
+        states = table.stateCount();
+        bytes = tableBytes(table);
+      });
+      std::printf("build %-20s %-8s %8.2f ms %6zu states %9zu bytes\n",
+                  skip_unit_rules ? "skipping unit rules" : "plain",
+                  threads == 1 ? "1 thread" : "threads", seconds * 1e3, states,
+                  bytes);
+    }
+  }
+
+  std::string corpus;
+  const double generation = measure(
+      [&] { corpus = CorpusWriter(20240611).write(megabytes << 20); });
+  std::printf("corpus %12zu bytes %8.2f ms to generate\n", corpus.size(),
+              generation * 1e3);
+
+  // Lexing alone is the bound any parse is measured against
+  size_t tokens = 0;
+  const double lexing = measure([&] { tokens = countTokens(corpus); });
+
+  // Rates are per token and byte of the corpus being parsed
+  const std::string* measured = &corpus;
+  auto report = [&](const char* name, double seconds) {
+    std::printf("%-22s %10.2f ms %12.0f tokens/s %8.2f MB/s\n", name,
+                seconds * 1e3, tokens / seconds,
+                measured->size() / seconds / (1 << 20));
+  };
+  std::printf("tokens %12zu\n", tokens);
+  report("lex", lexing);
+
+  // The cached table is built once, outside of the measured parses
+  Lexer lexer("corpus.c", corpus);
+  TokenStream stream = TokenStream(lexer, 16);
+  Parser parser = Parser(stream, grammar);
+
+  Parser::ProgramResult result;
+  report("parse to AST", measure([&] { result = parser.parseInPlace(); }));
+  if (!result || !(*result)->errors.empty()) {
+    std::fprintf(stderr, "the corpus failed to parse\n%s\n",
+                 (result ? (*result)->errors.front() : result.error())
+                     .toString()
+                     .c_str());
+    return 1;
+  }
+  std::printf("%-22s %10zu\n", "  AST nodes",
+              (*result)->storage.nodeCount());
+
+  struct Counter {
+    size_t reductions = 0;
+    void onShift(const Token&) {}
+    void onReduce(uint32_t, TokenStream::Span) { ++reductions; }
+  } counter;
+
+  bool parsed = false;
+  parser.reset("corpus.c", corpus);
+  report("parse events", measure([&] {
+           parsed = parser.parseEvents(counter).has_value();
+         }));
+  sink = sink + counter.reductions;
+
+  if (!parsed) {
+    std::fprintf(stderr, "the event parse failed on the corpus\n");
+    return 1;
+  }
+
+  // GLR against LR where GLR never forks, which is what it costs on
+  // unambiguous input
+  const std::string forkless =
+      CorpusWriter(20240611, /*forkless=*/true).write(megabytes << 20);
+  tokens = countTokens(forkless);
+  measured = &forkless;
+  Lexer forkless_lexer("forkless.c", forkless);
+  TokenStream forkless_stream = TokenStream(forkless_lexer, 16);
+  Parser lr = Parser(forkless_stream, grammar);
+  report("LR, no forks", measure([&] { result = lr.parseInPlace(); }));
+
+  Lexer glr_lexer("forkless.c", forkless);
+  TokenStream glr_stream = TokenStream(glr_lexer, 16);
+  GLRParser glr = GLRParser(glr_stream, grammar);
+  GLRParser::ForestResult forest;
+  Parser::ParserResult program;
+  report("GLR, no forks", measure([&] {
+           forest = glr.parse();
+           if (forest) program = glr.buildProgram();
+         }));
+  sink = sink + (program ? program->storage.nodeCount() : 0);
+
+  if (!result || !forest || !program || glr.forkCount() != 0) {
+    std::fprintf(stderr, "the forkless corpus forked or failed to parse\n");
+    return 1;
+  }
+  return 0;
+}
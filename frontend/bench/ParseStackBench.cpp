@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#include "parser/ParseStack.hpp"
+
+using namespace compiler;
+
+namespace {
+  // Keeps the optimizer from dropping the work being measured.
+  volatile size_t sink = 0;
+
+  ASTSymbolState entry(size_t state) {
+    return ASTSymbolState{Symbol::literal(), state};
+  }
+
+  void report(const char* name, size_t operations,
+              const std::function<void()>& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::printf("%-34s %12zu ops %10.3f ms %8.3f ns/op\n", name, operations,
+                ns / 1e6, ns / operations);
+  }
+}  // namespace
+
+int main() {
+  constexpr size_t DEPTH = 1 << 20;
+  constexpr size_t ROUNDS = 16;
+  constexpr size_t OSCILLATIONS = 1 << 24;
+
+  // Deep nesting: fill the stack to a large depth and unwind it again.
+  // Only the first round may grow the buffer.
+  {
+    ParseStack stack;
+    report("deep push/pop", 2 * DEPTH * ROUNDS, [&] {
+      for (size_t round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < DEPTH; ++i) stack.push(entry(i));
+        sink = sink + stack.peekTop().state;
+        for (size_t i = 0; i < DEPTH; ++i) stack.pop(1);
+      }
+    });
+    std::printf("%-34s %12zu entries\n", "  capacity after", stack.capacity());
+  }
+
+  // Oscillating nesting right around a multiple of 64, the case that used to
+  // allocate and free a page on every crossing.
+  {
+    ParseStack stack;
+    for (size_t i = 0; i < 4 * 64 - 1; ++i) stack.push(entry(i));
+
+    report("oscillate around 64*k", 2 * OSCILLATIONS, [&] {
+      for (size_t i = 0; i < OSCILLATIONS; ++i) {
+        stack.push(entry(i));
+        stack.push(entry(i));
+        sink = sink + stack.peekTop().state;
+        stack.pop(2);
+      }
+    });
+  }
+
+  // Reduction pattern: shift three symbols, read them as one RHS, replace
+  // them by the reduced symbol.
+  {
+    ParseStack stack;
+    stack.push(entry(0));
+
+    report("shift 3 / reduce 3 -> 1", 5 * OSCILLATIONS, [&] {
+      for (size_t i = 0; i < OSCILLATIONS; ++i) {
+        stack.push(entry(1));
+        stack.push(entry(2));
+        stack.push(entry(3));
+
+        size_t sum = 0;
+        for (const ASTSymbolState& rhs : stack.peekTop(3)) sum += rhs.state;
+        stack.pop(3);
+
+        stack.push(entry(sum));
+        stack.pop(1);
+      }
+      sink = sink + stack.size();
+    });
+  }
+
+  return 0;
+}
@@ -1,65 +1,82 @@
-// #include "ASTArena.hpp"
+#include "ASTArena.hpp"
 
-// namespace compiler {
+#include <algorithm>
 
-//   ASTArena::ASTArena() noexcept
-//       : top_index(0),
-//         page_count(0),
-//         node_count(0),
-//         head(nullptr),
-//         free_nodes() {}
+namespace compiler {
 
-//   ASTArena::~ASTArena() noexcept {
-//     clear();
-//     while (!free_nodes.empty()) {
-//       free_nodes.pop();
-//     }
-//   }
+  ASTArena::ASTArena(size_t block_size,
+                     std::pmr::memory_resource* upstream) noexcept
+      : upstream(upstream),
+        head(nullptr),
+        cursor(nullptr),
+        end(nullptr),
+        first_block_size(std::max(block_size, sizeof(Block))),
+        next_block_size(first_block_size),
+        used_bytes(0),
+        reserved_bytes(0),
+        block_count(0) {}
 
-//   size_t ASTArena::used() const { return node_count; }
-//   size_t ASTArena::available() const { return page_count * Page::PAGE_SIZE; }
+  ASTArena::~ASTArena() noexcept { release(); }
 
-//   void ASTArena::free(ASTNode* node) {
-//     if (node->is_free) {
-//       // Already freed, do nothing
-//       return;
-//     }
-//     node->is_free = true;
-//     node_count--;
+  void* ASTArena::grow(size_t bytes, size_t alignment) {
+    // An allocation larger than the next block gets a block of its own
+    // size, the growth of the following ones is not affected.
+    const size_t size =
+        std::max(next_block_size, sizeof(Block) + bytes + alignment);
+    Block* block = static_cast<Block*>(
+        upstream->allocate(size, alignof(std::max_align_t)));
+    block->prev = head;
+    block->size = size;
+    head = block;
 
-//     // TODO: Add to a stack the address of the freed block to use next
-//     // time a new allocation is set up.
-//     free_nodes.push(node);
-//   }
+    cursor = reinterpret_cast<std::byte*>(block + 1);
+    end = reinterpret_cast<std::byte*>(block) + size;
+    reserved_bytes += size;
+    ++block_count;
+    next_block_size = std::min(next_block_size * 2, MAX_BLOCK_SIZE);
 
-//   void ASTArena::clear() {
-//     while (head) {
-//       removePage();
-//     }
-//   }
+    return bump(bytes, alignment);
+  }
 
-//   void ASTArena::addPage() {
-//     // Create a new page and make head reference it.
-//     Page* new_page = new Page;
-//     new_page->prev = head;
-//     head = new_page;
+  void ASTArena::reset() noexcept {
+    if (!head) return;
 
-//     // Set the top of the index inside the page to zero
-//     // and increase the page count.
-//     top_index = 0;
-//     ++page_count;
-//   }
+    // The newest block is usually the largest, but a block made for an
+    // oversized allocation can be larger than those after it
+    Block* largest = head;
+    for (Block* block = head->prev; block; block = block->prev) {
+      if (block->size > largest->size) largest = block;
+    }
 
-//   void ASTArena::removePage() {
-//     if (!head) return;
-//     // Cache current page and obtain previous page reference.
-//     Page* old_page = head;
-//     head = head->prev;
-//     delete old_page;
+    while (head) {
+      Block* prev = head->prev;
+      if (head != largest) {
+        upstream->deallocate(head, head->size, alignof(std::max_align_t));
+      }
+      head = prev;
+    }
 
-//     // Reset top index and page count
-//     top_index = Page::PAGE_SIZE;
-//     --page_count;
-//   }
+    head = largest;
+    head->prev = nullptr;
+    cursor = reinterpret_cast<std::byte*>(head + 1);
+    end = reinterpret_cast<std::byte*>(head) + head->size;
+    used_bytes = 0;
+    reserved_bytes = head->size;
+    block_count = 1;
+  }
 
-// }  // namespace compiler
+  void ASTArena::release() noexcept {
+    while (head) {
+      Block* prev = head->prev;
+      upstream->deallocate(head, head->size, alignof(std::max_align_t));
+      head = prev;
+    }
+
+    cursor = nullptr;
+    end = nullptr;
+    next_block_size = first_block_size;
+    used_bytes = 0;
+    reserved_bytes = 0;
+    block_count = 0;
+  }
+}  // namespace compiler
@@ -1,89 +1,154 @@
-// #pragma once
-
-// #include <stack>
-
-// #include "Tokens.hpp"
-
-// namespace compiler {
-
-//   class ASTArena final {
-//   public:
-//     /**
-//      * @brief Construct a new ASTArena object.
-//      *
-//      */
-//     explicit ASTArena() noexcept;
-//     ~ASTArena() noexcept;
-
-//     /**
-//      * @brief Returns the number of allocated nodes.
-//      *
-//      * @return size_t
-//      */
-//     size_t used() const;
-
-//     /**
-//      * @brief Returns the number of available nodes.
-//      *
-//      * @return size_t
-//      */
-//     size_t available() const;
-
-//     /**
-//      * @brief Allocates a new ASTNode and returns a pointer to it.
-//      *
-//      * @tparam Args
-//      * @param args
-//      * @return ASTNode*
-//      */
-//     template <typename... Args>
-//     ASTNode* allocate(Args&&... args) {
-//       if (!head || top_index >= Page::PAGE_SIZE) {
-//         // Add a new page when overflows
-//         addPage();
-//       }
-
-//       if (!free_nodes.empty()) {
-//         // Reuse a free node if available
-//         ASTNode* node = free_nodes.top();
-//         free_nodes.pop();
-//         node->is_free = false;
-//         node_count++;
-//         return new (node) ASTNode{false, std::forward<Args>(args)...};
-//       }
-
-//       // Emplace node into page slot
-//       node_count++;
-//       return new (&head->nodes[top_index++])
-//           ASTNode{false, std::forward<Args>(args)...};
-//     }
-
-//     /**
-//      * @brief Frees the given ASTNode.
-//      *
-//      * @param node
-//      */
-//     void free(ASTNode* node);
-
-//   private:
-//     struct Page {
-//       static constexpr uint8_t PAGE_SIZE = 64;
-//       Page* prev = nullptr;
-//       ASTNode nodes[PAGE_SIZE]{};
-//     };
-
-//   private:
-//     uint8_t top_index;
-//     uint64_t page_count;
-//     uint64_t node_count;
-//     Page* head;
-
-//     // TEMP
-//     std::stack<ASTNode*> free_nodes;
-
-//   private:
-//     void clear();
-//     void addPage();
-//     void removePage();
-//   };
-// }  // namespace compiler
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace compiler {
+
+  /**
+   * @brief A monotonic region for the data of one translation unit.
+   *
+   *        Memory is taken from the upstream resource in large blocks, each
+   *        twice the size of the one before, and handed out by bumping a
+   *        pointer. Nothing is freed on its own: the whole region goes at
+   *        once with reset() or release(), in time proportional to the
+   *        number of blocks. Objects placed in it are never destroyed.
+   *
+   *        As a std::pmr::memory_resource it backs std::pmr containers, so
+   *        the AST storage, later passes and their IR can all live in the
+   *        region of their unit.
+   */
+  class ASTArena final : public std::pmr::memory_resource {
+  public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    // Blocks stop doubling past this size
+    static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+  public:
+    /**
+     * @brief Construct a new ASTArena object. No memory is taken until the
+     *        first allocation.
+     *
+     * @param block_size  Size of the first block.
+     * @param upstream    Where blocks come from, must outlive the arena.
+     */
+    explicit ASTArena(size_t block_size = DEFAULT_BLOCK_SIZE,
+                      std::pmr::memory_resource* upstream =
+                          std::pmr::new_delete_resource()) noexcept;
+    ~ASTArena() noexcept override;
+
+    ASTArena(const ASTArena&) = delete;
+    ASTArena& operator=(const ASTArena&) = delete;
+
+    /**
+     * @brief Returns `bytes` of memory aligned to `alignment`, a power of
+     *        two.
+     *
+     * @param bytes
+     * @param alignment
+     * @return void*
+     */
+    void* bump(size_t bytes, size_t alignment) {
+      const uintptr_t at = (reinterpret_cast<uintptr_t>(cursor) +
+                            alignment - 1) &
+                           ~static_cast<uintptr_t>(alignment - 1);
+      if (cursor == nullptr || at + bytes > reinterpret_cast<uintptr_t>(end)) {
+        return grow(bytes, alignment);
+      }
+      cursor = reinterpret_cast<std::byte*>(at + bytes);
+      used_bytes += bytes;
+      return reinterpret_cast<void*>(at);
+    }
+
+    /**
+     * @brief Constructs an object in the arena. Its destructor never runs,
+     *        so only trivially destructible types are accepted.
+     *
+     * @tparam T
+     * @tparam Args
+     * @param args
+     * @return T*
+     */
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+      static_assert(std::is_trivially_destructible_v<T>,
+                    "objects in an ASTArena are never destroyed");
+      return new (bump(sizeof(T), alignof(T)))
+          T{std::forward<Args>(args)...};
+    }
+
+    /**
+     * @brief Drops everything allocated so far. The largest block is kept
+     *        for what comes next and every other one goes back upstream.
+     *
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief Drops everything allocated so far and gives every block back
+     *        upstream.
+     *
+     */
+    void release() noexcept;
+
+    /**
+     * @brief Returns the bytes handed out since the last reset, alignment
+     *        padding aside.
+     *
+     * @return size_t
+     */
+    size_t used() const { return used_bytes; }
+
+    /**
+     * @brief Returns the bytes held in blocks, headers included.
+     *
+     * @return size_t
+     */
+    size_t reserved() const { return reserved_bytes; }
+
+    /**
+     * @brief Returns the number of blocks held.
+     *
+     * @return size_t
+     */
+    size_t blockCount() const { return block_count; }
+
+  private:
+    // Header at the start of every block, blocks are chained newest first
+    struct Block {
+      Block* prev;
+      size_t size;
+    };
+
+  private:
+    std::pmr::memory_resource* upstream;
+    Block* head;
+    std::byte* cursor;
+    std::byte* end;
+    size_t first_block_size;
+    size_t next_block_size;
+    size_t used_bytes;
+    size_t reserved_bytes;
+    size_t block_count;
+
+  private:
+    void* grow(size_t bytes, size_t alignment);
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+      return bump(bytes, alignment);
+    }
+
+    // Memory is only given back with the whole region
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+  };
+}  // namespace compiler
@@ -0,0 +1,457 @@
+#include "ASTFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parser/Hashing.hpp"
+
+#if defined(_WIN32)
+  #define NOMINMAX
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace compiler {
+
+  namespace {
+    constexpr char MAGIC[8] = {'C', 'F', 'E', 'A', 'S', 'T', '\0', '\0'};
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    size_t alignUp(size_t offset, size_t alignment) {
+      return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    bool isStringLiteral(TokenType type) {
+      return type == TokenType::STR8_LITERAL ||
+             type == TokenType::STR16_LITERAL;
+    }
+
+    // A section on its way to the file
+    struct Pending {
+      uint32_t id;
+      uint32_t element_size;
+      uint64_t count;
+      std::vector<std::byte> bytes;
+    };
+
+    // Nodes are written member by member into zeroed memory. Padding bytes
+    // are then always zero, so equal trees give equal files and nothing
+    // uninitialized reaches the disk.
+#define PUT_MEMBER(Node, member)                       \
+  std::memcpy(out + offsetof(Node, member), &node.member, \
+              sizeof(node.member))
+
+    template <typename Node>
+    void putNode(std::byte* out, const Node& node) {
+      static_assert(std::has_unique_object_representations_v<Node>,
+                    "nodes with padding are written member by member");
+      std::memcpy(out, &node, sizeof(Node));
+    }
+
+    void putNode(std::byte* out, const IDAST& node) {
+      PUT_MEMBER(IDAST, uid);
+      PUT_MEMBER(IDAST, id);
+    }
+
+    void putNode(std::byte* out, const LiteralAST& node) {
+      // Only the bytes of the member that is set
+      const size_t size = node.type == TokenType::CHAR_LITERAL
+                              ? sizeof(node.literal.character)
+                          : node.type == TokenType::BOOL_LITERAL
+                              ? sizeof(node.literal.boolean)
+                              : sizeof(node.literal.integer);
+      std::memcpy(out + offsetof(LiteralAST, literal), &node.literal, size);
+      PUT_MEMBER(LiteralAST, type);
+    }
+
+    void putNode(std::byte* out, const ExprAST& node) {
+      PUT_MEMBER(ExprAST, type);
+      PUT_MEMBER(ExprAST, index);
+    }
+
+    void putNode(std::byte* out, const BinaryExprAST& node) {
+      PUT_MEMBER(BinaryExprAST, left);
+      PUT_MEMBER(BinaryExprAST, right);
+      PUT_MEMBER(BinaryExprAST, op);
+    }
+
+    void putNode(std::byte* out, const UnaryExprAST& node) {
+      PUT_MEMBER(UnaryExprAST, operand);
+      PUT_MEMBER(UnaryExprAST, op);
+    }
+
+    void putNode(std::byte* out, const StmtAST& node) {
+      PUT_MEMBER(StmtAST, type);
+      PUT_MEMBER(StmtAST, index);
+    }
+
+    void putNode(std::byte* out, const StmtListAST& node) {
+      PUT_MEMBER(StmtListAST, type);
+      PUT_MEMBER(StmtListAST, stmt);
+      PUT_MEMBER(StmtListAST, next);
+    }
+
+    void putNode(std::byte* out, const ParamListAST& node) {
+      PUT_MEMBER(ParamListAST, type);
+      PUT_MEMBER(ParamListAST, param);
+      PUT_MEMBER(ParamListAST, next);
+    }
+
+    void putNode(std::byte* out, const ParamsAST& node) {
+      PUT_MEMBER(ParamsAST, type);
+      PUT_MEMBER(ParamsAST, index);
+    }
+
+#undef PUT_MEMBER
+
+    template <typename Node>
+    std::vector<std::byte> encode(std::span<const Node> nodes) {
+      std::vector<std::byte> bytes(nodes.size() * sizeof(Node));
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        putNode(bytes.data() + i * sizeof(Node), nodes[i]);
+      }
+      return bytes;
+    }
+
+    std::vector<std::byte> encode(std::string_view pool) {
+      const std::byte* data = reinterpret_cast<const std::byte*>(pool.data());
+      return {data, data + pool.size()};
+    }
+
+    template <typename Kinds, size_t... I>
+    constexpr auto elementSizes(std::index_sequence<I...>) {
+      return std::array<uint32_t, sizeof...(I) + 3>{
+          static_cast<uint32_t>(sizeof(std::tuple_element_t<I, Kinds>))...,
+          static_cast<uint32_t>(sizeof(ASTFile::Name)), 1, 1};
+    }
+  }  // namespace
+
+  std::string ASTFileError::toString() const noexcept {
+    std::ostringstream oss;
+    oss << "error: ";
+    switch (type) {
+      case ASTFileErrorType::IO_ERROR:
+        oss << "cannot access AST file";
+        break;
+      case ASTFileErrorType::NOT_AN_AST_FILE:
+        oss << "not an AST file";
+        break;
+      case ASTFileErrorType::VERSION_MISMATCH:
+        oss << "AST file written by another version of the format";
+        break;
+      case ASTFileErrorType::LAYOUT_MISMATCH:
+        oss << "AST file written for other node layouts";
+        break;
+      case ASTFileErrorType::CORRUPT:
+        oss << "corrupt AST file";
+        break;
+    }
+    oss << " `" << path << "`";
+    return oss.str();
+  }
+
+  std::unexpected<ASTFileError> ASTFileError::makeIOError(
+      std::string_view path) {
+    return std::unexpected(ASTFileError{.type = ASTFileErrorType::IO_ERROR,
+                                        .path = std::string(path)});
+  }
+
+  std::unexpected<ASTFileError> ASTFileError::makeFormatError(
+      ASTFileErrorType type, std::string_view path) {
+    return std::unexpected(
+        ASTFileError{.type = type, .path = std::string(path)});
+  }
+
+  ASTFile::WriteResult ASTFile::write(const std::string& path,
+                                      const ASTStorage& storage, Index root,
+                                      std::string_view source) {
+    // String literals are moved into a pool of their own, the file does
+    // not need the source to be read
+    std::vector<LiteralAST> literals(storage.literals.begin(),
+                                     storage.literals.end());
+    std::string strings;
+    for (LiteralAST& literal : literals) {
+      if (!isStringLiteral(literal.type)) continue;
+      const std::string_view text = literal.literal.string.view(source);
+      const uint32_t start = static_cast<uint32_t>(strings.size());
+      strings += text;
+      literal.literal.string = {start, static_cast<uint32_t>(strings.size())};
+    }
+
+    // Identifiers are interned by their spelling. In the file the uid of
+    // an IDAST is the index of its name: the hashes are not the same on
+    // every toolchain, and two names with the same hash stay apart.
+    std::vector<IDAST> ids(storage.ids.begin(), storage.ids.end());
+    std::vector<Name> names;
+    std::string spellings;
+    std::unordered_map<std::string_view, uint32_t> interned;
+    for (IDAST& id : ids) {
+      const std::string_view text = id.id.start <= id.id.end &&
+                                            id.id.end <= source.size()
+                                        ? id.id.view(source)
+                                        : std::string_view();
+      auto [name, inserted] =
+          interned.try_emplace(text, static_cast<uint32_t>(names.size()));
+      if (inserted) {
+        names.push_back({static_cast<uint32_t>(spellings.size()),
+                         static_cast<uint32_t>(text.size())});
+        spellings += text;
+      }
+      id.uid = name->second;
+    }
+
+    std::vector<Pending> pending;
+    auto add = [&](uint32_t id, uint32_t element_size, uint64_t count,
+                   std::vector<std::byte> bytes) {
+      if (count != 0) {
+        pending.push_back({id, element_size, count, std::move(bytes)});
+      }
+    };
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      (
+          [&] {
+            using Node = std::tuple_element_t<I, NodeKinds>;
+            std::span<const Node> nodes = storage.nodes<Node>();
+            if constexpr (std::is_same_v<Node, LiteralAST>) {
+              nodes = literals;
+            } else if constexpr (std::is_same_v<Node, IDAST>) {
+              nodes = ids;
+            }
+            add(I, sizeof(Node), nodes.size(), encode(nodes));
+          }(),
+          ...);
+    }(std::make_index_sequence<std::tuple_size_v<NodeKinds>>{});
+    add(NAMES, sizeof(Name), names.size(),
+        encode(std::span<const Name>(names)));
+    add(NAME_POOL, 1, spellings.size(), encode(spellings));
+    add(STRING_POOL, 1, strings.size(), encode(strings));
+
+    // Sections follow the table of contents, each at an aligned offset
+    std::vector<Section> toc;
+    size_t cursor = sizeof(Header) + pending.size() * sizeof(Section);
+    for (const Pending& section : pending) {
+      cursor = alignUp(cursor, SECTION_ALIGNMENT);
+      toc.push_back(
+          {section.id, section.element_size, section.count, cursor});
+      cursor += section.count * section.element_size;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.file_size = cursor;
+    header.source_hash = hashSource(source);
+    header.source_size = source.size();
+    header.root = root;
+    header.section_count = static_cast<uint32_t>(toc.size());
+
+    // Written next to the old file and renamed over it, a reader never
+    // maps half a file
+    const std::string temporary = path + ".tmp";
+    {
+      std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+      if (!out) return ASTFileError::makeIOError(temporary);
+
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char*>(toc.data()),
+                static_cast<std::streamsize>(toc.size() * sizeof(Section)));
+      size_t written = sizeof(Header) + toc.size() * sizeof(Section);
+      static constexpr char PADDING[SECTION_ALIGNMENT] = {};
+      for (size_t i = 0; i < pending.size(); ++i) {
+        out.write(PADDING,
+                  static_cast<std::streamsize>(toc[i].offset - written));
+        const std::vector<std::byte>& bytes = pending[i].bytes;
+        out.write(reinterpret_cast<const char*>(bytes.data()),
+                  static_cast<std::streamsize>(bytes.size()));
+        written = toc[i].offset + bytes.size();
+      }
+      if (!out.flush()) return ASTFileError::makeIOError(temporary);
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) return ASTFileError::makeIOError(path);
+    return {};
+  }
+
+  ASTFile::OpenResult ASTFile::open(const std::string& path) {
+    ASTFile file;
+
+#if defined(_WIN32)
+    const HANDLE handle =
+        ::CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ,
+                      FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                      FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return ASTFileError::makeIOError(path);
+    LARGE_INTEGER length;
+    if (!::GetFileSizeEx(handle, &length)) {
+      ::CloseHandle(handle);
+      return ASTFileError::makeIOError(path);
+    }
+    if (length.QuadPart == 0) {
+      ::CloseHandle(handle);
+      return ASTFileError::makeFormatError(ASTFileErrorType::NOT_AN_AST_FILE,
+                                           path);
+    }
+    file.size = static_cast<size_t>(length.QuadPart);
+    // The view keeps the mapping alive, neither handle is needed after it
+    const HANDLE mapping =
+        ::CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(handle);
+    if (mapping == nullptr) return ASTFileError::makeIOError(path);
+    const void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (view == nullptr) return ASTFileError::makeIOError(path);
+    file.base = static_cast<const std::byte*>(view);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return ASTFileError::makeIOError(path);
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+      ::close(fd);
+      return ASTFileError::makeIOError(path);
+    }
+    if (status.st_size == 0) {
+      ::close(fd);
+      return ASTFileError::makeFormatError(ASTFileErrorType::NOT_AN_AST_FILE,
+                                           path);
+    }
+    file.size = static_cast<size_t>(status.st_size);
+    void* mapping =
+        ::mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) return ASTFileError::makeIOError(path);
+    file.base = static_cast<const std::byte*>(mapping);
+#endif
+
+    auto reject = [&](ASTFileErrorType type) {
+      return ASTFileError::makeFormatError(type, path);
+    };
+
+    if (file.size < sizeof(Header) ||
+        std::memcmp(file.header().magic, MAGIC, sizeof(MAGIC)) != 0) {
+      return reject(ASTFileErrorType::NOT_AN_AST_FILE);
+    }
+    const Header& header = file.header();
+    if (header.version != VERSION) {
+      return reject(ASTFileErrorType::VERSION_MISMATCH);
+    }
+    if (header.byte_order != BYTE_ORDER_MARK) {
+      return reject(ASTFileErrorType::LAYOUT_MISMATCH);
+    }
+    if (header.file_size != file.size || header.section_count > SECTION_COUNT ||
+        sizeof(Header) + header.section_count * sizeof(Section) > file.size) {
+      return reject(ASTFileErrorType::CORRUPT);
+    }
+
+    // Only the table of contents is checked, the sections are used as
+    // they are
+    static constexpr auto ELEMENT_SIZES = elementSizes<NodeKinds>(
+        std::make_index_sequence<std::tuple_size_v<NodeKinds>>{});
+    const Section* toc =
+        reinterpret_cast<const Section*>(file.base + sizeof(Header));
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+      const Section& section = toc[i];
+      if (section.id >= SECTION_COUNT ||
+          file.sections[section.id].count != 0) {
+        return reject(ASTFileErrorType::CORRUPT);
+      }
+      if (section.element_size != ELEMENT_SIZES[section.id]) {
+        return reject(ASTFileErrorType::LAYOUT_MISMATCH);
+      }
+      if (section.offset % SECTION_ALIGNMENT != 0 ||
+          section.offset > file.size ||
+          section.count > (file.size - section.offset) / section.element_size) {
+        return reject(ASTFileErrorType::CORRUPT);
+      }
+      file.sections[section.id] = section;
+    }
+    return file;
+  }
+
+  ASTFile::ASTFile() noexcept : base(nullptr), size(0), sections{} {}
+
+  ASTFile::ASTFile(ASTFile&& other) noexcept
+      : base(std::exchange(other.base, nullptr)),
+        size(std::exchange(other.size, 0)) {
+    std::copy(std::begin(other.sections), std::end(other.sections),
+              sections);
+  }
+
+  ASTFile& ASTFile::operator=(ASTFile&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      base = std::exchange(other.base, nullptr);
+      size = std::exchange(other.size, 0);
+      std::copy(std::begin(other.sections), std::end(other.sections),
+                sections);
+    }
+    return *this;
+  }
+
+  ASTFile::~ASTFile() noexcept { unmap(); }
+
+  void ASTFile::unmap() noexcept {
+    if (base == nullptr) return;
+#if defined(_WIN32)
+    ::UnmapViewOfFile(base);
+#else
+    ::munmap(const_cast<std::byte*>(base), size);
+#endif
+    base = nullptr;
+  }
+
+  bool ASTFile::matches(std::string_view source) const {
+    return header().source_size == source.size() &&
+           header().source_hash == hashSource(source);
+  }
+
+  std::string_view ASTFile::nameOf(const IDAST& id) const {
+    const std::span<const Name> names = sectionAs<Name>(NAMES);
+    if (id.uid >= names.size()) return {};
+
+    const Name& name = names[id.uid];
+    const std::span<const char> pool = sectionAs<char>(NAME_POOL);
+    if (name.offset > pool.size() || name.length > pool.size() - name.offset) {
+      return {};
+    }
+    return {pool.data() + name.offset, name.length};
+  }
+
+  std::string_view ASTFile::stringOf(const string_lit& string) const {
+    const std::span<const char> pool = sectionAs<char>(STRING_POOL);
+    if (string.start > string.end || string.end > pool.size()) return {};
+    return {pool.data() + string.start, string.end - string.start};
+  }
+
+  uint64_t ASTFile::hashSource(std::string_view source) {
+    // Eight bytes to a word, the last one padded with zeros
+    StreamHasher hasher;
+    size_t at = 0;
+    for (; at + sizeof(uint64_t) <= source.size(); at += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, source.data() + at, sizeof(word));
+      hasher.add(word);
+    }
+    uint64_t tail = 0;
+    if (at < source.size()) {
+      std::memcpy(&tail, source.data() + at, source.size() - at);
+    }
+    hasher.add(tail);
+    return hasher.finish();
+  }
+}  // namespace compiler
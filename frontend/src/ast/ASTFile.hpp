@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "StorageAST.hpp"
+
+namespace compiler {
+
+  enum class ASTFileErrorType {
+    IO_ERROR,         // The file could not be read, written or mapped
+    NOT_AN_AST_FILE,  // The file does not start with the AST file magic
+    VERSION_MISMATCH,  // Written by another version of the format
+    LAYOUT_MISMATCH,   // Written by a build with other node layouts
+    CORRUPT,           // Sections lie outside of the file or are misaligned
+  };
+
+  class ASTFileError final {
+  public:
+    ASTFileErrorType type;
+    std::string path;
+
+  public:
+    /**
+     * @brief Describes the error and the file it happened on.
+     *
+     * @return std::string
+     */
+    std::string toString() const noexcept;
+
+  public:
+    /**
+     * @brief Creates an ASTFileError for a failed read, write or mapping.
+     *
+     * @param path
+     * @return std::unexpected<ASTFileError>
+     */
+    static std::unexpected<ASTFileError> makeIOError(std::string_view path);
+
+    /**
+     * @brief Creates an ASTFileError for a file that cannot be used as it
+     *        is.
+     *
+     * @param type
+     * @param path
+     * @return std::unexpected<ASTFileError>
+     */
+    static std::unexpected<ASTFileError> makeFormatError(
+        ASTFileErrorType type, std::string_view path);
+  };
+
+  /**
+   * @brief A parsed program stored on disk in the layout of ASTStorage.
+   *
+   *        The file is a header, a table of contents and one section per
+   *        node kind, each one laid out like its ASTStorage vector and
+   *        aligned to 64 bytes. Nodes are written member by member, their
+   *        padding bytes are zero. Two pools make it independent of the
+   *        source: the interned names of the identifiers, whose uid in the
+   *        file is the index of their name, and the contents of the string
+   *        literals, which point into their pool instead of the source.
+   *
+   *        Opening a file maps it read-only, with mmap or MapViewOfFile on
+   *        Windows, and checks its header and table of contents. The nodes
+   *        are then used where they lie in the mapping, nothing is decoded
+   *        or copied. A build system keeps one per source and, while
+   *        matches() holds, skips lexing and parsing the source altogether.
+   *
+   *        Files are only read by builds with the same format version, byte
+   *        order and node layouts as the one that wrote them.
+   */
+  class ASTFile final {
+  public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr size_t SECTION_ALIGNMENT = 64;
+
+    // Node kinds in the order of their sections. Adding a kind or changing
+    // the layout of one changes the format, VERSION goes up with it.
+    using NodeKinds =
+        std::tuple<ProgramAST, FunctionAST, IDAST, LiteralAST, ExprAST,
+                   BinaryExprAST, UnaryExprAST, ConditionalExprAST, StmtAST,
+                   IfStmtAST, ReturnStmtAST, StmtListAST, BlockAST, ParamAST,
+                   ParamListAST, ParamsAST, ErrorAST>;
+
+    // Where the spelling of a name lies in the name pool
+    struct Name {
+      uint32_t offset;
+      uint32_t length;
+    };
+
+    using OpenResult = std::expected<ASTFile, ASTFileError>;
+    using WriteResult = std::expected<void, ASTFileError>;
+
+  public:
+    /**
+     * @brief Writes the nodes of a program to a file, replacing it.
+     *
+     * @param path
+     * @param storage
+     * @param root    The root node of the program.
+     * @param source  The source the program was parsed from.
+     * @return WriteResult
+     */
+    static WriteResult write(const std::string& path,
+                             const ASTStorage& storage, Index root,
+                             std::string_view source);
+
+    /**
+     * @brief Maps a file written by write().
+     *
+     * @param path
+     * @return OpenResult
+     */
+    static OpenResult open(const std::string& path);
+
+    ASTFile(ASTFile&& other) noexcept;
+    ASTFile& operator=(ASTFile&& other) noexcept;
+    ~ASTFile() noexcept;
+
+    ASTFile(const ASTFile&) = delete;
+    ASTFile& operator=(const ASTFile&) = delete;
+
+    /**
+     * @brief Returns the nodes of a kind, in place in the mapping.
+     *
+     * @tparam Node
+     * @return std::span<const Node>
+     */
+    template <typename Node>
+    std::span<const Node> nodes() const {
+      const Section& section = sections[sectionOf<Node>()];
+      return {reinterpret_cast<const Node*>(base + section.offset),
+              static_cast<size_t>(section.count)};
+    }
+
+    template <typename Node>
+    const Node& operator[](Handle<Node> handle) const {
+      return nodes<Node>()[handle.index];
+    }
+
+    /**
+     * @brief Returns the root node of the program.
+     *
+     * @return Index
+     */
+    Index root() const { return header().root; }
+
+    /**
+     * @brief Returns whether the file was written for this exact source.
+     *
+     * @param source
+     * @return true if the program in the file is the parse of `source`
+     */
+    bool matches(std::string_view source) const;
+
+    /**
+     * @brief Returns the name of an identifier of the file, whose uid is
+     *        the index of its name. Empty for uids that are not one.
+     *
+     * @param id
+     * @return std::string_view
+     */
+    std::string_view nameOf(const IDAST& id) const;
+
+    /**
+     * @brief Returns the contents of a string literal of the file.
+     *
+     * @param string
+     * @return std::string_view
+     */
+    std::string_view stringOf(const string_lit& string) const;
+
+  private:
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t byte_order;
+      uint64_t file_size;
+      uint64_t source_hash;
+      uint64_t source_size;
+      Index root;
+      uint32_t section_count;  // Entries of the table of contents after it
+    };
+
+    struct Section {
+      uint32_t id;
+      uint32_t element_size;
+      uint64_t count;
+      uint64_t offset;
+    };
+
+    // Sections after those of the node kinds
+    static constexpr uint32_t NAMES = std::tuple_size_v<NodeKinds>;
+    static constexpr uint32_t NAME_POOL = NAMES + 1;
+    static constexpr uint32_t STRING_POOL = NAMES + 2;
+    static constexpr uint32_t SECTION_COUNT = NAMES + 3;
+
+    template <typename Node, uint32_t I = 0>
+    static constexpr uint32_t sectionOf() {
+      if constexpr (std::is_same_v<Node, std::tuple_element_t<I, NodeKinds>>) {
+        return I;
+      } else {
+        return sectionOf<Node, I + 1>();
+      }
+    }
+
+  private:
+    const std::byte* base;
+    size_t size;
+    Section sections[SECTION_COUNT];
+
+  private:
+    ASTFile() noexcept;
+
+    const Header& header() const {
+      return *reinterpret_cast<const Header*>(base);
+    }
+
+    template <typename T>
+    std::span<const T> sectionAs(uint32_t id) const {
+      return {reinterpret_cast<const T*>(base + sections[id].offset),
+              static_cast<size_t>(sections[id].count)};
+    }
+
+    static uint64_t hashSource(std::string_view source);
+    void unmap() noexcept;
+  };
+}  // namespace compiler
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "Reductions.hpp"
+#include "parser/StaticGrammar.hpp"
+
+namespace compiler {
+
+  // C expressions, following the precedence levels of the ANSI C grammar
+  // (https://www.lysator.liu.se/c/ANSI-C-grammar-y.html). Casts, calls,
+  // subscripts, member access and sizeof are left out for now, they need
+  // type names and argument lists first.
+  //
+  // expr        → expr , assign | assign
+  // assign      → unary assign_op assign | cond
+  // cond        → lor ? expr : cond | lor
+  // lor         → lor || land | land
+  // land        → land && or | or
+  // or          → or '|' xor | xor
+  // xor         → xor ^ and | and
+  // and         → and & eq | eq
+  // eq          → eq == rel | eq != rel | rel
+  // rel         → rel < shift | rel > shift | rel <= shift | rel >= shift
+  //             | shift
+  // shift       → shift << add | shift >> add | add
+  // add         → add + mul | add - mul | mul
+  // mul         → mul * cast | mul / cast | mul % cast | cast
+  // cast        → unary
+  // unary       → ++ unary | -- unary | unary_op cast | postfix
+  // postfix     → postfix ++ | postfix -- | primary
+  // primary     → IDENTIFIER | LITERAL | ( expr )
+  //
+  // Every level that only forwards the level below is a unit rule without
+  // a handler, the kind of rule ActionTable can skip over.
+
+  inline constexpr auto C_EXPR_GRAMMAR = [] {
+    using NT = NonTerminal;
+    using PU = Punctuator;
+    using reductions::binaryExpr;
+
+    return makeGrammar(
+        rule(NT::START, nt(NT::EXPR)),
+
+        rule(NT::EXPR, nt(NT::EXPR), pun(PU::COMMA), nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EXPR, nt(NT::ASSIGNMENT_EXPR)),
+
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::PLUS_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::DASH_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::STAR_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::SLASH_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::MOD_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::LSHIFT_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::RSHIFT_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::AND_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::XOR_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::OR_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::CONDITIONAL_EXPR)),
+
+        rule(NT::CONDITIONAL_EXPR, nt(NT::LOGICAL_OR_EXPR), pun(PU::QUESTION),
+             nt(NT::EXPR), pun(PU::COLON), nt(NT::CONDITIONAL_EXPR))
+            .reduceWith(reductions::conditionalExpr),
+        rule(NT::CONDITIONAL_EXPR, nt(NT::LOGICAL_OR_EXPR)),
+
+        rule(NT::LOGICAL_OR_EXPR, nt(NT::LOGICAL_OR_EXPR), pun(PU::OR),
+             nt(NT::LOGICAL_AND_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::LOGICAL_OR_EXPR, nt(NT::LOGICAL_AND_EXPR)),
+
+        rule(NT::LOGICAL_AND_EXPR, nt(NT::LOGICAL_AND_EXPR), pun(PU::AND),
+             nt(NT::INCLUSIVE_OR_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::LOGICAL_AND_EXPR, nt(NT::INCLUSIVE_OR_EXPR)),
+
+        rule(NT::INCLUSIVE_OR_EXPR, nt(NT::INCLUSIVE_OR_EXPR), pun(PU::BOR),
+             nt(NT::EXCLUSIVE_OR_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::INCLUSIVE_OR_EXPR, nt(NT::EXCLUSIVE_OR_EXPR)),
+
+        rule(NT::EXCLUSIVE_OR_EXPR, nt(NT::EXCLUSIVE_OR_EXPR), pun(PU::BXOR),
+             nt(NT::AND_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EXCLUSIVE_OR_EXPR, nt(NT::AND_EXPR)),
+
+        rule(NT::AND_EXPR, nt(NT::AND_EXPR), pun(PU::BAND),
+             nt(NT::EQUALITY_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::AND_EXPR, nt(NT::EQUALITY_EXPR)),
+
+        rule(NT::EQUALITY_EXPR, nt(NT::EQUALITY_EXPR), pun(PU::EQ_EQ),
+             nt(NT::RELATIONAL_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EQUALITY_EXPR, nt(NT::EQUALITY_EXPR), pun(PU::NEQ),
+             nt(NT::RELATIONAL_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EQUALITY_EXPR, nt(NT::RELATIONAL_EXPR)),
+
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::LT),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::GT),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::LTE),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::GTE),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::SHIFT_EXPR)),
+
+        rule(NT::SHIFT_EXPR, nt(NT::SHIFT_EXPR), pun(PU::LSHIFT),
+             nt(NT::ADDITIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::SHIFT_EXPR, nt(NT::SHIFT_EXPR), pun(PU::RSHIFT),
+             nt(NT::ADDITIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::SHIFT_EXPR, nt(NT::ADDITIVE_EXPR)),
+
+        rule(NT::ADDITIVE_EXPR, nt(NT::ADDITIVE_EXPR), pun(PU::PLUS),
+             nt(NT::MULTIPLICATIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ADDITIVE_EXPR, nt(NT::ADDITIVE_EXPR), pun(PU::DASH),
+             nt(NT::MULTIPLICATIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ADDITIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR)),
+
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR),
+             pun(PU::STAR), nt(NT::CAST_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR),
+             pun(PU::SLASH), nt(NT::CAST_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR),
+             pun(PU::MOD), nt(NT::CAST_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::CAST_EXPR)),
+
+        rule(NT::CAST_EXPR, nt(NT::UNARY_EXPR)),
+
+        rule(NT::UNARY_EXPR, pun(PU::PLUS_PLUS), nt(NT::UNARY_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::DASH_DASH), nt(NT::UNARY_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::BAND), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::STAR), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::PLUS), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::DASH), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::BNOT), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::NOT), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, nt(NT::POSTFIX_EXPR)),
+
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::PLUS_PLUS))
+            .reduceWith(reductions::postfixExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::DASH_DASH))
+            .reduceWith(reductions::postfixExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::PRIMARY_EXPR)),
+
+        rule(NT::PRIMARY_EXPR, id()).reduceWith(reductions::identifierExpr),
+        rule(NT::PRIMARY_EXPR, lit()).reduceWith(reductions::literalExpr),
+        rule(NT::PRIMARY_EXPR, pun(PU::LPAREN), nt(NT::EXPR),
+             pun(PU::RPAREN))
+            .reduceWith(reductions::parenExpr));
+  }();
+}  // namespace compiler
@@ -0,0 +1,456 @@
+#pragma once
+
+#include "Reductions.hpp"
+#include "parser/StaticGrammar.hpp"
+
+namespace compiler {
+
+  // The ANSI C grammar of C_Grammar_Reference.hpp
+  // (https://www.lysator.liu.se/c/ANSI-C-grammar-y.html), at the size a
+  // real front end has to handle. It is what the parser benchmarks build
+  // and parse, see bench/CGrammarBench.cpp.
+  //
+  // It differs from the reference where this front end has to:
+  //  - Typedef names are left out. Telling them from identifiers takes a
+  //    symbol table in the lexer, or a GLR parse, see GLRParser.
+  //  - K&R parameter lists and declarations before a function body are
+  //    left out, they only make sense together with typedef names gone.
+  //  - `register` is not a keyword of the lexer.
+  //
+  // Expressions build the nodes C_EXPR_GRAMMAR builds: subscripts and
+  // calls become binary nodes of `[` and `(`, member accesses postfix
+  // nodes of `.` and `->` that drop the member. Types, declarations and
+  // most statements have no nodes in StorageAST yet and reduce without a
+  // handler.
+
+  inline constexpr auto C_GRAMMAR = [] {
+    using NT = NonTerminal;
+    using PU = Punctuator;
+    using KW = Keyword;
+    using reductions::binaryExpr;
+
+    return makeGrammar(
+        rule(NT::START, nt(NT::TRANSLATION_UNIT)),
+
+        // Expressions, as in C_EXPR_GRAMMAR plus casts, sizeof, calls,
+        // subscripts and member access
+        rule(NT::EXPR, nt(NT::EXPR), pun(PU::COMMA), nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EXPR, nt(NT::ASSIGNMENT_EXPR)),
+
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::PLUS_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::DASH_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::STAR_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::SLASH_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::MOD_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::LSHIFT_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::RSHIFT_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::AND_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::XOR_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::UNARY_EXPR), pun(PU::OR_EQ),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ASSIGNMENT_EXPR, nt(NT::CONDITIONAL_EXPR)),
+
+        rule(NT::CONDITIONAL_EXPR, nt(NT::LOGICAL_OR_EXPR), pun(PU::QUESTION),
+             nt(NT::EXPR), pun(PU::COLON), nt(NT::CONDITIONAL_EXPR))
+            .reduceWith(reductions::conditionalExpr),
+        rule(NT::CONDITIONAL_EXPR, nt(NT::LOGICAL_OR_EXPR)),
+
+        rule(NT::LOGICAL_OR_EXPR, nt(NT::LOGICAL_OR_EXPR), pun(PU::OR),
+             nt(NT::LOGICAL_AND_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::LOGICAL_OR_EXPR, nt(NT::LOGICAL_AND_EXPR)),
+
+        rule(NT::LOGICAL_AND_EXPR, nt(NT::LOGICAL_AND_EXPR), pun(PU::AND),
+             nt(NT::INCLUSIVE_OR_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::LOGICAL_AND_EXPR, nt(NT::INCLUSIVE_OR_EXPR)),
+
+        rule(NT::INCLUSIVE_OR_EXPR, nt(NT::INCLUSIVE_OR_EXPR), pun(PU::BOR),
+             nt(NT::EXCLUSIVE_OR_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::INCLUSIVE_OR_EXPR, nt(NT::EXCLUSIVE_OR_EXPR)),
+
+        rule(NT::EXCLUSIVE_OR_EXPR, nt(NT::EXCLUSIVE_OR_EXPR), pun(PU::BXOR),
+             nt(NT::AND_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EXCLUSIVE_OR_EXPR, nt(NT::AND_EXPR)),
+
+        rule(NT::AND_EXPR, nt(NT::AND_EXPR), pun(PU::BAND),
+             nt(NT::EQUALITY_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::AND_EXPR, nt(NT::EQUALITY_EXPR)),
+
+        rule(NT::EQUALITY_EXPR, nt(NT::EQUALITY_EXPR), pun(PU::EQ_EQ),
+             nt(NT::RELATIONAL_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EQUALITY_EXPR, nt(NT::EQUALITY_EXPR), pun(PU::NEQ),
+             nt(NT::RELATIONAL_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::EQUALITY_EXPR, nt(NT::RELATIONAL_EXPR)),
+
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::LT),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::GT),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::LTE),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::RELATIONAL_EXPR), pun(PU::GTE),
+             nt(NT::SHIFT_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::RELATIONAL_EXPR, nt(NT::SHIFT_EXPR)),
+
+        rule(NT::SHIFT_EXPR, nt(NT::SHIFT_EXPR), pun(PU::LSHIFT),
+             nt(NT::ADDITIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::SHIFT_EXPR, nt(NT::SHIFT_EXPR), pun(PU::RSHIFT),
+             nt(NT::ADDITIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::SHIFT_EXPR, nt(NT::ADDITIVE_EXPR)),
+
+        rule(NT::ADDITIVE_EXPR, nt(NT::ADDITIVE_EXPR), pun(PU::PLUS),
+             nt(NT::MULTIPLICATIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ADDITIVE_EXPR, nt(NT::ADDITIVE_EXPR), pun(PU::DASH),
+             nt(NT::MULTIPLICATIVE_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::ADDITIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR)),
+
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR),
+             pun(PU::STAR), nt(NT::CAST_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR),
+             pun(PU::SLASH), nt(NT::CAST_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::MULTIPLICATIVE_EXPR),
+             pun(PU::MOD), nt(NT::CAST_EXPR))
+            .reduceWith(binaryExpr),
+        rule(NT::MULTIPLICATIVE_EXPR, nt(NT::CAST_EXPR)),
+
+        rule(NT::CAST_EXPR, nt(NT::UNARY_EXPR)),
+        rule(NT::CAST_EXPR, pun(PU::LPAREN), nt(NT::TYPE_NAME),
+             pun(PU::RPAREN), nt(NT::CAST_EXPR)),
+
+        rule(NT::UNARY_EXPR, pun(PU::PLUS_PLUS), nt(NT::UNARY_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::DASH_DASH), nt(NT::UNARY_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::BAND), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::STAR), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::PLUS), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::DASH), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::BNOT), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, pun(PU::NOT), nt(NT::CAST_EXPR))
+            .reduceWith(reductions::unaryExpr),
+        rule(NT::UNARY_EXPR, kw(KW::SIZEOF), nt(NT::UNARY_EXPR)),
+        rule(NT::UNARY_EXPR, kw(KW::SIZEOF), pun(PU::LPAREN),
+             nt(NT::TYPE_NAME), pun(PU::RPAREN)),
+        rule(NT::UNARY_EXPR, nt(NT::POSTFIX_EXPR)),
+
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::PLUS_PLUS))
+            .reduceWith(reductions::postfixExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::DASH_DASH))
+            .reduceWith(reductions::postfixExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::LBRACKET),
+             nt(NT::EXPR), pun(PU::RBRACKET))
+            .reduceWith(binaryExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::LPAREN),
+             pun(PU::RPAREN))
+            .reduceWith(reductions::postfixExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::LPAREN),
+             nt(NT::ARG_EXPR_LIST), pun(PU::RPAREN))
+            .reduceWith(binaryExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::DOT), id())
+            .reduceWith(reductions::postfixExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::POSTFIX_EXPR), pun(PU::RARROW), id())
+            .reduceWith(reductions::postfixExpr),
+        rule(NT::POSTFIX_EXPR, nt(NT::PRIMARY_EXPR)),
+
+        rule(NT::PRIMARY_EXPR, id()).reduceWith(reductions::identifierExpr),
+        rule(NT::PRIMARY_EXPR, lit()).reduceWith(reductions::literalExpr),
+        rule(NT::PRIMARY_EXPR, pun(PU::LPAREN), nt(NT::EXPR),
+             pun(PU::RPAREN))
+            .reduceWith(reductions::parenExpr),
+
+        rule(NT::ARG_EXPR_LIST, nt(NT::ASSIGNMENT_EXPR)),
+        rule(NT::ARG_EXPR_LIST, nt(NT::ARG_EXPR_LIST), pun(PU::COMMA),
+             nt(NT::ASSIGNMENT_EXPR))
+            .reduceWith(binaryExpr),
+
+        rule(NT::CONSTANT_EXPR, nt(NT::CONDITIONAL_EXPR)),
+
+        // Declarations
+        rule(NT::DECLARATION, nt(NT::DECLARATION_SPECIFIERS),
+             pun(PU::SEMI_COLON)),
+        rule(NT::DECLARATION, nt(NT::DECLARATION_SPECIFIERS),
+             nt(NT::INIT_DECLARATOR_LIST), pun(PU::SEMI_COLON)),
+
+        rule(NT::DECLARATION_SPECIFIERS, nt(NT::STORAGE_CLASS_SPECIFIER)),
+        rule(NT::DECLARATION_SPECIFIERS, nt(NT::STORAGE_CLASS_SPECIFIER),
+             nt(NT::DECLARATION_SPECIFIERS)),
+        rule(NT::DECLARATION_SPECIFIERS, nt(NT::TYPE_SPECIFIER)),
+        rule(NT::DECLARATION_SPECIFIERS, nt(NT::TYPE_SPECIFIER),
+             nt(NT::DECLARATION_SPECIFIERS)),
+        rule(NT::DECLARATION_SPECIFIERS, nt(NT::TYPE_QUALIFIER)),
+        rule(NT::DECLARATION_SPECIFIERS, nt(NT::TYPE_QUALIFIER),
+             nt(NT::DECLARATION_SPECIFIERS)),
+
+        rule(NT::INIT_DECLARATOR_LIST, nt(NT::INIT_DECLARATOR)),
+        rule(NT::INIT_DECLARATOR_LIST, nt(NT::INIT_DECLARATOR_LIST),
+             pun(PU::COMMA), nt(NT::INIT_DECLARATOR)),
+
+        rule(NT::INIT_DECLARATOR, nt(NT::DECLARATOR)),
+        rule(NT::INIT_DECLARATOR, nt(NT::DECLARATOR), pun(PU::EQ),
+             nt(NT::INITIALIZER)),
+
+        rule(NT::STORAGE_CLASS_SPECIFIER, kw(KW::TYPEDEF)),
+        rule(NT::STORAGE_CLASS_SPECIFIER, kw(KW::EXTERN)),
+        rule(NT::STORAGE_CLASS_SPECIFIER, kw(KW::STATIC)),
+        rule(NT::STORAGE_CLASS_SPECIFIER, kw(KW::AUTO)),
+
+        rule(NT::TYPE_SPECIFIER, kw(KW::VOID)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::CHAR)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::SHORT)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::INT)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::LONG)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::FLOAT)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::DOUBLE)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::SIGNED)),
+        rule(NT::TYPE_SPECIFIER, kw(KW::UNSIGNED)),
+        rule(NT::TYPE_SPECIFIER, nt(NT::STRUCT_OR_UNION_SPECIFIER)),
+        rule(NT::TYPE_SPECIFIER, nt(NT::ENUM_SPECIFIER)),
+
+        rule(NT::STRUCT_OR_UNION_SPECIFIER, nt(NT::STRUCT_OR_UNION), id(),
+             pun(PU::LBRACE), nt(NT::STRUCT_DECLARATION_LIST),
+             pun(PU::RBRACE)),
+        rule(NT::STRUCT_OR_UNION_SPECIFIER, nt(NT::STRUCT_OR_UNION),
+             pun(PU::LBRACE), nt(NT::STRUCT_DECLARATION_LIST),
+             pun(PU::RBRACE)),
+        rule(NT::STRUCT_OR_UNION_SPECIFIER, nt(NT::STRUCT_OR_UNION), id()),
+
+        rule(NT::STRUCT_OR_UNION, kw(KW::STRUCT)),
+        rule(NT::STRUCT_OR_UNION, kw(KW::UNION)),
+
+        rule(NT::STRUCT_DECLARATION_LIST, nt(NT::STRUCT_DECLARATION)),
+        rule(NT::STRUCT_DECLARATION_LIST, nt(NT::STRUCT_DECLARATION_LIST),
+             nt(NT::STRUCT_DECLARATION)),
+
+        rule(NT::STRUCT_DECLARATION, nt(NT::SPECIFIER_QUALIFIER_LIST),
+             nt(NT::STRUCT_DECLARATOR_LIST), pun(PU::SEMI_COLON)),
+
+        rule(NT::SPECIFIER_QUALIFIER_LIST, nt(NT::TYPE_SPECIFIER),
+             nt(NT::SPECIFIER_QUALIFIER_LIST)),
+        rule(NT::SPECIFIER_QUALIFIER_LIST, nt(NT::TYPE_SPECIFIER)),
+        rule(NT::SPECIFIER_QUALIFIER_LIST, nt(NT::TYPE_QUALIFIER),
+             nt(NT::SPECIFIER_QUALIFIER_LIST)),
+        rule(NT::SPECIFIER_QUALIFIER_LIST, nt(NT::TYPE_QUALIFIER)),
+
+        rule(NT::STRUCT_DECLARATOR_LIST, nt(NT::STRUCT_DECLARATOR)),
+        rule(NT::STRUCT_DECLARATOR_LIST, nt(NT::STRUCT_DECLARATOR_LIST),
+             pun(PU::COMMA), nt(NT::STRUCT_DECLARATOR)),
+
+        rule(NT::STRUCT_DECLARATOR, nt(NT::DECLARATOR)),
+        rule(NT::STRUCT_DECLARATOR, pun(PU::COLON), nt(NT::CONSTANT_EXPR)),
+        rule(NT::STRUCT_DECLARATOR, nt(NT::DECLARATOR), pun(PU::COLON),
+             nt(NT::CONSTANT_EXPR)),
+
+        rule(NT::ENUM_SPECIFIER, kw(KW::ENUM), pun(PU::LBRACE),
+             nt(NT::ENUMERATOR_LIST), pun(PU::RBRACE)),
+        rule(NT::ENUM_SPECIFIER, kw(KW::ENUM), id(), pun(PU::LBRACE),
+             nt(NT::ENUMERATOR_LIST), pun(PU::RBRACE)),
+        rule(NT::ENUM_SPECIFIER, kw(KW::ENUM), id()),
+
+        rule(NT::ENUMERATOR_LIST, nt(NT::ENUMERATOR)),
+        rule(NT::ENUMERATOR_LIST, nt(NT::ENUMERATOR_LIST), pun(PU::COMMA),
+             nt(NT::ENUMERATOR)),
+
+        rule(NT::ENUMERATOR, id()),
+        rule(NT::ENUMERATOR, id(), pun(PU::EQ), nt(NT::CONSTANT_EXPR)),
+
+        rule(NT::TYPE_QUALIFIER, kw(KW::CONST)),
+        rule(NT::TYPE_QUALIFIER, kw(KW::VOLATILE)),
+
+        rule(NT::DECLARATOR, nt(NT::POINTER), nt(NT::DIRECT_DECLARATOR)),
+        rule(NT::DECLARATOR, nt(NT::DIRECT_DECLARATOR)),
+
+        rule(NT::DIRECT_DECLARATOR, id()),
+        rule(NT::DIRECT_DECLARATOR, pun(PU::LPAREN), nt(NT::DECLARATOR),
+             pun(PU::RPAREN)),
+        rule(NT::DIRECT_DECLARATOR, nt(NT::DIRECT_DECLARATOR),
+             pun(PU::LBRACKET), nt(NT::CONSTANT_EXPR), pun(PU::RBRACKET)),
+        rule(NT::DIRECT_DECLARATOR, nt(NT::DIRECT_DECLARATOR),
+             pun(PU::LBRACKET), pun(PU::RBRACKET)),
+        rule(NT::DIRECT_DECLARATOR, nt(NT::DIRECT_DECLARATOR),
+             pun(PU::LPAREN), nt(NT::PARAMETER_TYPE_LIST), pun(PU::RPAREN)),
+        rule(NT::DIRECT_DECLARATOR, nt(NT::DIRECT_DECLARATOR),
+             pun(PU::LPAREN), pun(PU::RPAREN)),
+
+        rule(NT::POINTER, pun(PU::STAR)),
+        rule(NT::POINTER, pun(PU::STAR), nt(NT::TYPE_QUALIFIER_LIST)),
+        rule(NT::POINTER, pun(PU::STAR), nt(NT::POINTER)),
+        rule(NT::POINTER, pun(PU::STAR), nt(NT::TYPE_QUALIFIER_LIST),
+             nt(NT::POINTER)),
+
+        rule(NT::TYPE_QUALIFIER_LIST, nt(NT::TYPE_QUALIFIER)),
+        rule(NT::TYPE_QUALIFIER_LIST, nt(NT::TYPE_QUALIFIER_LIST),
+             nt(NT::TYPE_QUALIFIER)),
+
+        rule(NT::PARAMETER_TYPE_LIST, nt(NT::PARAMETER_LIST)),
+        rule(NT::PARAMETER_TYPE_LIST, nt(NT::PARAMETER_LIST), pun(PU::COMMA),
+             pun(PU::ELLIPSIS)),
+
+        rule(NT::PARAMETER_LIST, nt(NT::PARAMETER_DECLARATION)),
+        rule(NT::PARAMETER_LIST, nt(NT::PARAMETER_LIST), pun(PU::COMMA),
+             nt(NT::PARAMETER_DECLARATION)),
+
+        rule(NT::PARAMETER_DECLARATION, nt(NT::DECLARATION_SPECIFIERS),
+             nt(NT::DECLARATOR)),
+        rule(NT::PARAMETER_DECLARATION, nt(NT::DECLARATION_SPECIFIERS),
+             nt(NT::ABSTRACT_DECLARATOR)),
+        rule(NT::PARAMETER_DECLARATION, nt(NT::DECLARATION_SPECIFIERS)),
+
+        rule(NT::TYPE_NAME, nt(NT::SPECIFIER_QUALIFIER_LIST)),
+        rule(NT::TYPE_NAME, nt(NT::SPECIFIER_QUALIFIER_LIST),
+             nt(NT::ABSTRACT_DECLARATOR)),
+
+        rule(NT::ABSTRACT_DECLARATOR, nt(NT::POINTER)),
+        rule(NT::ABSTRACT_DECLARATOR, nt(NT::DIRECT_ABSTRACT_DECLARATOR)),
+        rule(NT::ABSTRACT_DECLARATOR, nt(NT::POINTER),
+             nt(NT::DIRECT_ABSTRACT_DECLARATOR)),
+
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR, pun(PU::LPAREN),
+             nt(NT::ABSTRACT_DECLARATOR), pun(PU::RPAREN)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR, pun(PU::LBRACKET),
+             pun(PU::RBRACKET)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR, pun(PU::LBRACKET),
+             nt(NT::CONSTANT_EXPR), pun(PU::RBRACKET)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR,
+             nt(NT::DIRECT_ABSTRACT_DECLARATOR), pun(PU::LBRACKET),
+             pun(PU::RBRACKET)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR,
+             nt(NT::DIRECT_ABSTRACT_DECLARATOR), pun(PU::LBRACKET),
+             nt(NT::CONSTANT_EXPR), pun(PU::RBRACKET)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR, pun(PU::LPAREN),
+             pun(PU::RPAREN)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR, pun(PU::LPAREN),
+             nt(NT::PARAMETER_TYPE_LIST), pun(PU::RPAREN)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR,
+             nt(NT::DIRECT_ABSTRACT_DECLARATOR), pun(PU::LPAREN),
+             pun(PU::RPAREN)),
+        rule(NT::DIRECT_ABSTRACT_DECLARATOR,
+             nt(NT::DIRECT_ABSTRACT_DECLARATOR), pun(PU::LPAREN),
+             nt(NT::PARAMETER_TYPE_LIST), pun(PU::RPAREN)),
+
+        rule(NT::INITIALIZER, nt(NT::ASSIGNMENT_EXPR)),
+        rule(NT::INITIALIZER, pun(PU::LBRACE), nt(NT::INITIALIZER_LIST),
+             pun(PU::RBRACE)),
+        rule(NT::INITIALIZER, pun(PU::LBRACE), nt(NT::INITIALIZER_LIST),
+             pun(PU::COMMA), pun(PU::RBRACE)),
+
+        rule(NT::INITIALIZER_LIST, nt(NT::INITIALIZER)),
+        rule(NT::INITIALIZER_LIST, nt(NT::INITIALIZER_LIST), pun(PU::COMMA),
+             nt(NT::INITIALIZER)),
+
+        // Statements
+        rule(NT::STMT, nt(NT::LABELED_STMT)),
+        rule(NT::STMT, nt(NT::COMPOUND_STMT)),
+        rule(NT::STMT, nt(NT::EXPRESSION_STMT)),
+        rule(NT::STMT, nt(NT::SELECTION_STMT)),
+        rule(NT::STMT, nt(NT::ITERATION_STMT)),
+        rule(NT::STMT, nt(NT::JUMP_STMT)),
+
+        rule(NT::LABELED_STMT, id(), pun(PU::COLON), nt(NT::STMT)),
+        rule(NT::LABELED_STMT, kw(KW::CASE), nt(NT::CONSTANT_EXPR),
+             pun(PU::COLON), nt(NT::STMT)),
+        rule(NT::LABELED_STMT, kw(KW::DEFAULT), pun(PU::COLON),
+             nt(NT::STMT)),
+
+        rule(NT::COMPOUND_STMT, pun(PU::LBRACE), pun(PU::RBRACE)),
+        rule(NT::COMPOUND_STMT, pun(PU::LBRACE), nt(NT::STMT_LIST),
+             pun(PU::RBRACE)),
+        rule(NT::COMPOUND_STMT, pun(PU::LBRACE), nt(NT::DECLARATION_LIST),
+             pun(PU::RBRACE)),
+        rule(NT::COMPOUND_STMT, pun(PU::LBRACE), nt(NT::DECLARATION_LIST),
+             nt(NT::STMT_LIST), pun(PU::RBRACE)),
+
+        rule(NT::DECLARATION_LIST, nt(NT::DECLARATION)),
+        rule(NT::DECLARATION_LIST, nt(NT::DECLARATION_LIST),
+             nt(NT::DECLARATION)),
+
+        rule(NT::STMT_LIST, nt(NT::STMT)),
+        rule(NT::STMT_LIST, nt(NT::STMT_LIST), nt(NT::STMT)),
+
+        rule(NT::EXPRESSION_STMT, pun(PU::SEMI_COLON)),
+        rule(NT::EXPRESSION_STMT, nt(NT::EXPR), pun(PU::SEMI_COLON))
+            .reduceWith(reductions::exprStmt),
+
+        rule(NT::SELECTION_STMT, kw(KW::IF), pun(PU::LPAREN), nt(NT::EXPR),
+             pun(PU::RPAREN), nt(NT::STMT)),
+        rule(NT::SELECTION_STMT, kw(KW::IF), pun(PU::LPAREN), nt(NT::EXPR),
+             pun(PU::RPAREN), nt(NT::STMT), kw(KW::ELSE), nt(NT::STMT)),
+        rule(NT::SELECTION_STMT, kw(KW::SWITCH), pun(PU::LPAREN),
+             nt(NT::EXPR), pun(PU::RPAREN), nt(NT::STMT)),
+
+        rule(NT::ITERATION_STMT, kw(KW::WHILE), pun(PU::LPAREN),
+             nt(NT::EXPR), pun(PU::RPAREN), nt(NT::STMT)),
+        rule(NT::ITERATION_STMT, kw(KW::DO), nt(NT::STMT), kw(KW::WHILE),
+             pun(PU::LPAREN), nt(NT::EXPR), pun(PU::RPAREN),
+             pun(PU::SEMI_COLON)),
+        rule(NT::ITERATION_STMT, kw(KW::FOR), pun(PU::LPAREN),
+             nt(NT::EXPRESSION_STMT), nt(NT::EXPRESSION_STMT),
+             pun(PU::RPAREN), nt(NT::STMT)),
+        rule(NT::ITERATION_STMT, kw(KW::FOR), pun(PU::LPAREN),
+             nt(NT::EXPRESSION_STMT), nt(NT::EXPRESSION_STMT), nt(NT::EXPR),
+             pun(PU::RPAREN), nt(NT::STMT)),
+
+        rule(NT::JUMP_STMT, kw(KW::GOTO), id(), pun(PU::SEMI_COLON)),
+        rule(NT::JUMP_STMT, kw(KW::CONTINUE), pun(PU::SEMI_COLON)),
+        rule(NT::JUMP_STMT, kw(KW::BREAK), pun(PU::SEMI_COLON)),
+        rule(NT::JUMP_STMT, kw(KW::RETURN), pun(PU::SEMI_COLON)),
+        rule(NT::JUMP_STMT, kw(KW::RETURN), nt(NT::EXPR),
+             pun(PU::SEMI_COLON)),
+
+        // Translation units
+        rule(NT::TRANSLATION_UNIT, nt(NT::EXTERNAL_DECLARATION)),
+        rule(NT::TRANSLATION_UNIT, nt(NT::TRANSLATION_UNIT),
+             nt(NT::EXTERNAL_DECLARATION)),
+
+        rule(NT::EXTERNAL_DECLARATION, nt(NT::FUNCTION_DEFINITION)),
+        rule(NT::EXTERNAL_DECLARATION, nt(NT::DECLARATION)),
+
+        rule(NT::FUNCTION_DEFINITION, nt(NT::DECLARATION_SPECIFIERS),
+             nt(NT::DECLARATOR), nt(NT::COMPOUND_STMT)),
+        rule(NT::FUNCTION_DEFINITION, nt(NT::DECLARATOR),
+             nt(NT::COMPOUND_STMT)));
+  }();
+}  // namespace compiler
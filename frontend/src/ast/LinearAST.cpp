@@ -0,0 +1,212 @@
+#include "LinearAST.hpp"
+
+namespace compiler {
+
+  LinearAST::LinearAST(std::pmr::memory_resource* resource) noexcept
+      : buffer(resource), root_nodes(resource) {}
+
+  uint32_t LinearAST::append(const ASTStorage& storage,
+                             Handle<ExprAST> root) {
+    return layOut(storage, {Ref::Type::EXPR, root.index});
+  }
+
+  uint32_t LinearAST::append(const ASTStorage& storage,
+                             Handle<StmtListAST> root) {
+    return layOut(storage, {Ref::Type::STMT_LIST, root.index});
+  }
+
+  void LinearAST::clear() {
+    buffer.clear();
+    root_nodes.clear();
+  }
+
+  uint32_t LinearAST::layOut(const ASTStorage& storage, Ref root) {
+    // Post-order with a stack of its own, chains of operators and long
+    // statement lists nest far deeper than the call stack allows
+    frames.clear();
+    frames.push_back({root, 0, NO_INDEX});
+
+    while (!frames.empty()) {
+      Frame& frame = frames.back();
+      if (frame.arity == NO_INDEX) {
+        frame.first = static_cast<uint32_t>(buffer.size());
+        frame.arity = childrenOf(storage, frame.ref);
+
+        // The first child ends up on top and is laid out first
+        for (auto child = children.rbegin(); child != children.rend();
+             ++child) {
+          frames.push_back({*child, 0, NO_INDEX});
+        }
+        continue;
+      }
+
+      Node node = nodeOf(storage, frame.ref);
+      node.size = static_cast<uint32_t>(buffer.size()) - frame.first + 1;
+      node.arity = frame.arity;
+      buffer.push_back(node);
+      frames.pop_back();
+    }
+
+    root_nodes.push_back(static_cast<uint32_t>(buffer.size() - 1));
+    return root_nodes.back();
+  }
+
+  uint32_t LinearAST::childrenOf(const ASTStorage& storage, Ref ref) {
+    children.clear();
+    auto expr = [&](Handle<ExprAST> handle) {
+      if (handle.valid()) children.push_back({Ref::Type::EXPR, handle.index});
+    };
+
+    switch (ref.type) {
+      case Ref::Type::EXPR: {
+        const ExprAST& node = storage[Handle<ExprAST>{ref.index}];
+        switch (node.type) {
+          case ExprAST::Type::PAREN_EXPR:
+            expr({node.index});
+            break;
+          case ExprAST::Type::BINARY_EXPR: {
+            const BinaryExprAST& binary = storage.binary_exprs[node.index];
+            expr(binary.left);
+            expr(binary.right);
+            break;
+          }
+          case ExprAST::Type::UNARY_EXPR:
+          case ExprAST::Type::POSTFIX_EXPR:
+            expr(storage.unary_exprs[node.index].operand);
+            break;
+          case ExprAST::Type::CONDITIONAL_EXPR: {
+            const ConditionalExprAST& conditional =
+                storage.conditional_exprs[node.index];
+            expr(conditional.condition);
+            expr(conditional.then_expr);
+            expr(conditional.else_expr);
+            break;
+          }
+          default:
+            break;
+        }
+        break;
+      }
+
+      case Ref::Type::STMT: {
+        const StmtAST& node = storage[Handle<StmtAST>{ref.index}];
+        switch (node.type) {
+          case StmtAST::Type::EXPR:
+            expr({node.index});
+            break;
+          case StmtAST::Type::IF: {
+            const IfStmtAST& if_stmt = storage.if_stmts[node.index];
+            expr(if_stmt.condition);
+            if (if_stmt.block.valid()) {
+              children.push_back({Ref::Type::BLOCK, if_stmt.block.index});
+            }
+            break;
+          }
+          case StmtAST::Type::RETURN:
+            expr(storage.return_stmts[node.index].index);
+            break;
+          default:
+            break;
+        }
+        break;
+      }
+
+      case Ref::Type::STMT_LIST:
+        // The chain of lists becomes one node with every statement
+        for (Handle<StmtListAST> list{ref.index}; list.valid();
+             list = storage[list].next) {
+          if (storage[list].stmt.valid()) {
+            children.push_back({Ref::Type::STMT, storage[list].stmt.index});
+          }
+        }
+        break;
+
+      case Ref::Type::BLOCK: {
+        const BlockAST& block = storage[Handle<BlockAST>{ref.index}];
+        if (block.stmt_list.valid()) {
+          children.push_back({Ref::Type::STMT_LIST, block.stmt_list.index});
+        }
+        break;
+      }
+    }
+    return static_cast<uint32_t>(children.size());
+  }
+
+  LinearAST::Node LinearAST::nodeOf(const ASTStorage& storage,
+                                    Ref ref) const {
+    Node node{};
+    node.origin = ref.index;
+
+    switch (ref.type) {
+      case Ref::Type::EXPR: {
+        const ExprAST& expr = storage[Handle<ExprAST>{ref.index}];
+        if (expr.type != ExprAST::Type::PAREN_EXPR) node.origin = expr.index;
+        switch (expr.type) {
+          case ExprAST::Type::ID:
+            node.kind = Kind::ID;
+            node.uid = storage.ids[expr.index].uid;
+            break;
+          case ExprAST::Type::LITERAL:
+            node.kind = Kind::LITERAL;
+            node.token_type = storage.literals[expr.index].type;
+            node.literal = storage.literals[expr.index].literal;
+            break;
+          case ExprAST::Type::PAREN_EXPR:
+            node.kind = Kind::PAREN_EXPR;
+            break;
+          case ExprAST::Type::BINARY_EXPR:
+            node.kind = Kind::BINARY_EXPR;
+            node.op = storage.binary_exprs[expr.index].op;
+            break;
+          case ExprAST::Type::UNARY_EXPR:
+          case ExprAST::Type::POSTFIX_EXPR:
+            node.kind = expr.type == ExprAST::Type::UNARY_EXPR
+                            ? Kind::UNARY_EXPR
+                            : Kind::POSTFIX_EXPR;
+            node.op = storage.unary_exprs[expr.index].op;
+            break;
+          case ExprAST::Type::CONDITIONAL_EXPR:
+            node.kind = Kind::CONDITIONAL_EXPR;
+            break;
+          case ExprAST::Type::ERROR:
+            node.kind = Kind::ERROR;
+            node.diagnostic = storage.errors[expr.index].diagnostic;
+            break;
+        }
+        break;
+      }
+
+      case Ref::Type::STMT: {
+        const StmtAST& stmt = storage[Handle<StmtAST>{ref.index}];
+        switch (stmt.type) {
+          case StmtAST::Type::EXPR:
+            node.kind = Kind::EXPR_STMT;
+            break;
+          case StmtAST::Type::IF:
+            node.kind = Kind::IF_STMT;
+            node.origin = stmt.index;
+            break;
+          case StmtAST::Type::RETURN:
+            node.kind = Kind::RETURN_STMT;
+            node.origin = stmt.index;
+            break;
+          case StmtAST::Type::ERROR:
+            node.kind = Kind::ERROR_STMT;
+            node.origin = stmt.index;
+            node.diagnostic = storage.errors[stmt.index].diagnostic;
+            break;
+        }
+        break;
+      }
+
+      case Ref::Type::STMT_LIST:
+        node.kind = Kind::STMT_LIST;
+        break;
+
+      case Ref::Type::BLOCK:
+        node.kind = Kind::BLOCK;
+        break;
+    }
+    return node;
+  }
+}  // namespace compiler
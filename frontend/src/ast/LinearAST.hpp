@@ -0,0 +1,165 @@
+#pragma once
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "StorageAST.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief The nodes of parsed trees laid out again in post-order, in a
+   *        single buffer. Every child comes before its parent and the nodes
+   *        of a subtree are contiguous, so a pass that computes something
+   *        from the children of each node is one forward scan over the
+   *        buffer, which touches no other memory.
+   *
+   *        Leaves carry their value, and the ExprAST and StmtAST that only
+   *        wrap another node are folded into it. A statement list becomes
+   *        one node whose children are its statements.
+   *
+   *        Nodes link to their children through their subtree sizes: the
+   *        last child of node N is N - 1, and the sibling before a child C
+   *        is C - size(C).
+   */
+  class LinearAST final {
+  public:
+    enum class Kind : uint8_t {
+      ID,
+      LITERAL,
+      PAREN_EXPR,
+      BINARY_EXPR,
+      UNARY_EXPR,
+      POSTFIX_EXPR,
+      CONDITIONAL_EXPR,
+      ERROR,
+      EXPR_STMT,
+      IF_STMT,
+      RETURN_STMT,
+      ERROR_STMT,
+      STMT_LIST,
+      BLOCK,
+    };
+
+    struct Node {
+      Kind kind;
+      union {
+        Punctuator op;         // Operator of unary and binary expressions
+        TokenType token_type;  // Type of literals
+      };
+      uint32_t size;   // Nodes of its subtree, itself included
+      uint32_t arity;  // Number of children
+      Index origin;    // Index of the node it was made from, in the vector
+                       // of ASTStorage its kind was built in
+      union {
+        uint64_t uid;         // ID
+        Literal literal;      // LITERAL
+        uint32_t diagnostic;  // ERROR and ERROR_STMT
+      };
+    };
+
+  public:
+    /**
+     * @brief Construct a new LinearAST object.
+     *
+     * @param resource  Where the node buffer lives, must outlive it.
+     */
+    explicit LinearAST(std::pmr::memory_resource* resource =
+                           std::pmr::get_default_resource()) noexcept;
+
+    /**
+     * @brief Lays out the tree of an expression after the nodes appended
+     *        so far.
+     *
+     * @param storage
+     * @param root
+     * @return uint32_t  Position of the root in the buffer.
+     */
+    uint32_t append(const ASTStorage& storage, Handle<ExprAST> root);
+
+    /**
+     * @brief Lays out the tree of a statement list after the nodes
+     *        appended so far.
+     *
+     * @param storage
+     * @param root
+     * @return uint32_t  Position of the root in the buffer.
+     */
+    uint32_t append(const ASTStorage& storage, Handle<StmtListAST> root);
+
+    /**
+     * @brief Drops every node, the memory of the buffer stays.
+     *
+     */
+    void clear();
+
+    std::span<const Node> nodes() const { return buffer; }
+
+    const Node& operator[](uint32_t node) const { return buffer[node]; }
+
+    /**
+     * @brief Returns the positions of the roots, in the order they were
+     *        appended.
+     *
+     * @return std::span<const uint32_t>
+     */
+    std::span<const uint32_t> roots() const { return root_nodes; }
+
+    /**
+     * @brief Returns the position of the first node of a subtree.
+     *
+     * @param node
+     * @return uint32_t
+     */
+    uint32_t firstOf(uint32_t node) const {
+      return node + 1 - buffer[node].size;
+    }
+
+    /**
+     * @brief Returns the position of a child, counted from the first one.
+     *        Walks back from the last child, so the last ones are the
+     *        cheapest to reach.
+     *
+     * @param node
+     * @param child  Lower than the arity of the node.
+     * @return uint32_t
+     */
+    uint32_t childAt(uint32_t node, uint32_t child) const {
+      uint32_t at = node - 1;
+      for (uint32_t i = buffer[node].arity - 1; i > child; --i) {
+        at -= buffer[at].size;
+      }
+      return at;
+    }
+
+  private:
+    // A node of the storage still to be laid out
+    struct Ref {
+      enum class Type : uint8_t { EXPR, STMT, STMT_LIST, BLOCK } type;
+      Index index;
+    };
+
+    struct Frame {
+      Ref ref;
+      uint32_t first;  // Buffer size when its children started
+      uint32_t arity;  // NO_INDEX until its children were pushed
+    };
+
+  private:
+    std::pmr::vector<Node> buffer;
+    std::pmr::vector<uint32_t> root_nodes;
+
+    // Work stack, kept to reuse its memory
+    std::vector<Frame> frames;
+    std::vector<Ref> children;
+
+  private:
+    uint32_t layOut(const ASTStorage& storage, Ref root);
+    uint32_t childrenOf(const ASTStorage& storage, Ref ref);
+    Node nodeOf(const ASTStorage& storage, Ref ref) const;
+  };
+
+  // Eight nodes to three cache lines
+  static_assert(sizeof(LinearAST::Node) == 24);
+}  // namespace compiler
@@ -0,0 +1,114 @@
+#include "Reductions.hpp"
+
+#include <functional>
+
+namespace compiler::reductions {
+
+  namespace {
+    Handle<ExprAST> operand(std::span<const ASTSymbolState> rhs, size_t i) {
+      return {rhs[i].node};
+    }
+
+    Index pushExpr(ASTStorage& storage, ExprAST::Type type, Index index) {
+      return storage.push(ExprAST{type, index}).index;
+    }
+  }  // namespace
+
+  Index tokenLeaf(ASTStorage& storage, const Token& token,
+                  std::string_view source) {
+    switch (token.type) {
+      case TokenType::CHAR_LITERAL:
+      case TokenType::BOOL_LITERAL:
+      case TokenType::STR8_LITERAL:
+      case TokenType::STR16_LITERAL:
+      case TokenType::INT8_LITERAL:
+      case TokenType::INT16_LITERAL:
+      case TokenType::INT32_LITERAL:
+      case TokenType::INT64_LITERAL:
+      case TokenType::UINT8_LITERAL:
+      case TokenType::UINT16_LITERAL:
+      case TokenType::UINT32_LITERAL:
+      case TokenType::UINT64_LITERAL:
+      case TokenType::FLOAT32_LITERAL:
+      case TokenType::FLOAT64_LITERAL:
+        return storage.push(LiteralAST{token.value.literal, token.type})
+            .index;
+
+      case TokenType::IDENTIFIER: {
+        // Equal names get equal uids, wherever they appear in the source.
+        const Identifier& id = token.value.identifier;
+        uint64_t uid = std::hash<std::string_view>{}(id.view(source));
+        return storage.push(IDAST{uid, id}).index;
+      }
+
+      default:
+        // Keywords and punctuators carry no node of their own
+        return NO_INDEX;
+    }
+  }
+
+  Index binaryExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    Handle<BinaryExprAST> binary = storage.push(BinaryExprAST{
+        operand(rhs, 0), operand(rhs, 2), rhs[1].symbol.terminal.punctuator});
+    return pushExpr(storage, ExprAST::Type::BINARY_EXPR, binary.index);
+  }
+
+  Index unaryExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    Handle<UnaryExprAST> unary = storage.push(
+        UnaryExprAST{operand(rhs, 1), rhs[0].symbol.terminal.punctuator});
+    return pushExpr(storage, ExprAST::Type::UNARY_EXPR, unary.index);
+  }
+
+  Index postfixExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    Handle<UnaryExprAST> postfix = storage.push(
+        UnaryExprAST{operand(rhs, 0), rhs[1].symbol.terminal.punctuator});
+    return pushExpr(storage, ExprAST::Type::POSTFIX_EXPR, postfix.index);
+  }
+
+  Index conditionalExpr(ASTStorage& storage,
+                        std::span<const ASTSymbolState> rhs) {
+    Handle<ConditionalExprAST> conditional = storage.push(ConditionalExprAST{
+        operand(rhs, 0), operand(rhs, 2), operand(rhs, 4)});
+    return pushExpr(storage, ExprAST::Type::CONDITIONAL_EXPR,
+                    conditional.index);
+  }
+
+  Index parenExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    return pushExpr(storage, ExprAST::Type::PAREN_EXPR, rhs[1].node);
+  }
+
+  Index literalExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    return pushExpr(storage, ExprAST::Type::LITERAL, rhs[0].node);
+  }
+
+  Index identifierExpr(ASTStorage& storage,
+                       std::span<const ASTSymbolState> rhs) {
+    return pushExpr(storage, ExprAST::Type::ID, rhs[0].node);
+  }
+
+  Index errorExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    return pushExpr(storage, ExprAST::Type::ERROR, rhs[0].node);
+  }
+
+  Index exprStmt(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    return storage.push(StmtAST{StmtAST::Type::EXPR, rhs[0].node}).index;
+  }
+
+  Index errorStmt(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    return storage.push(StmtAST{StmtAST::Type::ERROR, rhs[0].node}).index;
+  }
+
+  Index stmtList(ASTStorage& storage, std::span<const ASTSymbolState> rhs) {
+    return storage
+        .push(StmtListAST{StmtListAST::Type::MULTIPLE, {rhs[0].node},
+                          {rhs[1].node}})
+        .index;
+  }
+
+  Index singleStmtList(ASTStorage& storage,
+                       std::span<const ASTSymbolState> rhs) {
+    return storage
+        .push(StmtListAST{StmtListAST::Type::SINGLE, {rhs[0].node}, {}})
+        .index;
+  }
+}  // namespace compiler::reductions
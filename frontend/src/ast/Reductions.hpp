@@ -0,0 +1,58 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "StorageAST.hpp"
+#include "parser/ParseStack.hpp"
+
+namespace compiler::reductions {
+
+  // Semantic actions for the expression rules of StorageAST.hpp. Each one
+  // matches the ReductionHandler signature and can be set as the handler
+  // of a Rule whose RHS has the shape described next to it.
+
+  // IDENTIFIER | LITERAL, the leaf a shifted token leaves on the stack.
+  // Keywords and punctuators have none and get NO_INDEX.
+  Index tokenLeaf(ASTStorage& storage, const Token& token,
+                  std::string_view source);
+
+  // expr → expr op expr
+  Index binaryExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // expr → op expr
+  Index unaryExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // expr → expr op
+  Index postfixExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // expr → expr ? expr : expr
+  Index conditionalExpr(ASTStorage& storage,
+                        std::span<const ASTSymbolState> rhs);
+
+  // expr → ( expr )
+  Index parenExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // expr → LITERAL
+  Index literalExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // expr → IDENTIFIER
+  Index identifierExpr(ASTStorage& storage,
+                       std::span<const ASTSymbolState> rhs);
+
+  // expr → error
+  Index errorExpr(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // stmt → expr ;
+  Index exprStmt(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // stmt → error ;
+  Index errorStmt(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // stmt_list → stmt stmt_list
+  Index stmtList(ASTStorage& storage, std::span<const ASTSymbolState> rhs);
+
+  // stmt_list → stmt
+  Index singleStmtList(ASTStorage& storage,
+                       std::span<const ASTSymbolState> rhs);
+}  // namespace compiler::reductions
@@ -1,5 +1,6 @@
 #include "Lexer.hpp"
 
+#include <algorithm>
 #include <cctype>
 #include <charconv>
 #include <cmath>
@@ -22,8 +23,28 @@ namespace compiler {
         prev_line_pos(0),    // Previous position within the line
         token_start_pos(0),  // Start position of the current token
         source(src),
+        filename(filename),
         last_token(Token::endOF()),
-        filename(filename) {}
+        terminals(nullptr) {}
+
+  void Lexer::reset(std::string_view filename, std::string_view src) noexcept {
+    pos = line = line_pos = 0;
+    prev_pos = prev_line = prev_line_pos = 0;
+    token_start_pos = 0;
+    source = src;
+    this->filename = filename;
+    last_token = Token::endOF();
+  }
+
+  void Lexer::seek(size_t offset) noexcept {
+    pos = prev_pos = token_start_pos = std::min(offset, source.size());
+
+    line = prev_line = std::count(source.begin(), source.begin() + pos, '\n');
+    const size_t line_start =
+        pos > 0 ? source.rfind('\n', pos - 1) : std::string_view::npos;
+    line_pos = prev_line_pos =
+        line_start == std::string_view::npos ? 0 : line_start + 1;
+  }
 
   LexerState Lexer::state() const noexcept {
     size_t column = (token_start_pos - prev_line_pos) + 1;  // 1-based column
@@ -44,7 +65,9 @@ namespace compiler {
 
     // If we are at the end of the source code, return an EOF token
     if (pos >= source.length()) {
-      return Token::endOF();
+      Token eof = Token::endOF();
+      if (terminals) eof.terminal = terminals->terminalOf(eof);
+      return eof;
     }
 
     // Save the starting position of the token
@@ -69,8 +92,13 @@ namespace compiler {
       result = lexerError(LexerErrorType::UNKNOWN_TOKEN);
     }
 
-    // Save a copy of the last token
-    last_token = *result;
+    if (result) {
+      // The parser reads the terminal id straight from the token
+      if (terminals) result->terminal = terminals->terminalOf(*result);
+
+      // Save a copy of the last token
+      last_token = *result;
+    }
 
     return result;
   }
@@ -418,8 +446,10 @@ namespace compiler {
   }
 
   TokenType Lexer::typeSufixFrom() noexcept {
+    // The suffix is at most two characters, and never starts before the
+    // number does.
     size_t sufix_end = pos;
-    size_t sufix_start = pos - 2;
+    size_t sufix_start = pos - std::min<size_t>(2, pos - token_start_pos);
     std::string_view sufix(source.data() + sufix_start,
                            sufix_end - sufix_start);
 
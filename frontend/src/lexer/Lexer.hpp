@@ -4,6 +4,7 @@
 #include <string_view>
 
 #include "LexerError.hpp"
+#include "tokens/TerminalMap.hpp"
 #include "tokens/Tokens.hpp"
 
 namespace compiler {
@@ -33,6 +34,30 @@ namespace compiler {
      */
     LexerResult advance();
 
+    /**
+     * @brief Starts over on a new source. The terminal map is kept.
+     *
+     * @param filename The name of the source file.
+     * @param src The source code to tokenize.
+     */
+    void reset(std::string_view filename, std::string_view src) noexcept;
+
+    /**
+     * @brief Moves to an offset of the source, which must not be inside of
+     *        a token or a comment. Lines are counted again up to it.
+     *
+     * @param offset
+     */
+    void seek(size_t offset) noexcept;
+
+    /**
+     * @brief Stamps every token produced from now on with its terminal id
+     *        in the given map. The map must outlive the lexer.
+     *
+     * @param map terminal ids of a grammar, nullptr to stop mapping
+     */
+    void mapTerminals(const TerminalMap* map) noexcept { terminals = map; }
+
     /**
      * @brief Returns the current state of the lexer.
      *
@@ -55,6 +80,7 @@ namespace compiler {
     std::string_view filename;
 
     Token last_token;
+    const TerminalMap* terminals;
 
     using DParseResult = std::expected<double, LexerError>;
     using IParseResult = std::expected<uint64_t, LexerError>;
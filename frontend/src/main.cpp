@@ -1,6 +1,19 @@
+#include "tests/ASTArenaTests.hpp"
+#include "tests/ASTFileTests.hpp"
+#include "tests/ASTStorageTests.hpp"
 #include "tests/ActionTableTests.hpp"
+#include "tests/CGrammarTests.hpp"
+#include "tests/DirectParserTests.hpp"
+#include "tests/GLRTests.hpp"
+#include "tests/IncrementalTests.hpp"
+#include "tests/LinearASTTests.hpp"
 #include "tests/LexerTests.hpp"
+#include "tests/ParseEventTests.hpp"
+#include "tests/ParserStatsTests.hpp"
 #include "tests/ParserTests.hpp"
+#include "tests/StaticGrammarTests.hpp"
+#include "tests/TokenStreamTests.hpp"
+#include "tests/UnitRuleTests.hpp"
 
 using namespace compiler;
 
@@ -18,7 +31,43 @@ int main() {
   // )",
   //           "LEXER TEST");
 
-  // testActionTable();
+  testActionTable();
+
+  testStaticGrammar();
+
+  testTableCache();
+
+  testUnitRuleElimination();
+
+  testDirectParser();
+
+  testTerminalMapping();
+
+  testTokenStream();
+
+  testASTArena();
+
+  testASTStorage();
+
+  testParserAST();
+
+  testLinearAST();
+
+  testASTFile();
+
+  testParserRecovery();
+
+  testParseSession();
+
+  testParseEvents();
+
+  testParserStats();
+
+  testIncrementalParsing();
+
+  testGLRParser();
+
+  testCGrammar();
 
   testParser(R"(
     &&*** + (2 * 4)
@@ -1,252 +1,642 @@
 #include "ActionTable.hpp"
 
-#include <iostream>
-#include <queue>
-#include <stack>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+
+#include "StateRegistry.hpp"
 
 namespace compiler {
 
-  bool ActionTable::Item::operator==(const Item& other) const {
-    return rule_index == other.rule_index && dot_position == other.dot_position;
-  }
+  namespace {
+    // Levels narrower than this are expanded on the calling thread when the
+    // thread count is picked automatically, spawning workers would cost more
+    // than the closures themselves.
+    constexpr size_t MIN_PARALLEL_LEVEL = 64;
+
+    /**
+     * @brief Runs fn(i) for every i in [0, count) on up to `threads` threads.
+     *
+     */
+    template <typename Fn>
+    void parallelFor(size_t count, size_t threads, Fn&& fn) {
+      if (threads <= 1 || count < 2) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+      }
 
-  size_t ActionTable::ItemHasher::operator()(const Item& item) const {
-    return std::hash<size_t>()(item.rule_index) ^
-           (std::hash<size_t>()(item.dot_position) << 1);
-  }
+      std::atomic<size_t> next = 0;
+      auto work = [&] {
+        for (size_t i; (i = next.fetch_add(1)) < count;) fn(i);
+      };
 
-  size_t ActionTable::ItemSetHasher::operator()(const ItemSet& set) const {
-    size_t hash = set.size();
-    for (const Item& element : set) {
-      hash ^= ItemHasher{}(element);
+      std::vector<std::jthread> workers;
+      for (size_t t = 1; t < std::min(threads, count); ++t) {
+        workers.emplace_back(work);
+      }
+      work();
+    }
+  }  // namespace
+
+  uint64_t ActionTable::KernelHasher::operator()(const ItemSet& kernel) const {
+    // Two packed items per word, the kernel is already in canonical order.
+    StreamHasher hasher;
+    size_t i = 0;
+    for (; i + 1 < kernel.size(); i += 2) {
+      hasher.add((static_cast<uint64_t>(kernel[i].packed()) << 32) |
+                 kernel[i + 1].packed());
+    }
+    if (i < kernel.size()) {
+      hasher.add(kernel[i].packed());
     }
-    return hash;
+    return hasher.finish();
   }
 
-  ActionTable::ActionTable(const Grammar& grammar) noexcept
-      : grammar(grammar), terminals() {
-    obtainAllTerminals();
+  ActionTable::ActionTable(const Grammar& grammar, size_t threads,
+                           bool skip_unit_rules) noexcept
+      : grammar(grammar),
+        threads(threads),
+        symbols(grammar),
+        terminals(symbols.terminalCount()) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point phase_start = Clock::now();
+    auto endPhase = [&phase_start](std::chrono::nanoseconds& time) {
+      const Clock::time_point now = Clock::now();
+      time = now - phase_start;
+      phase_start = now;
+    };
+
+    // Translate every rule to symbol ids once, and precompute everything
+    // closure() needs, so that building the item sets never has to look at
+    // Symbol values or scan the whole grammar again.
+    numberRules();
+    indexRulesByLhs();
+    computeNonTerminalClosures();
+    endPhase(build_times.rules);
 
     // Stack allocate the table transitions and item-set states.
     // This is just a one time creation, meaning that there is no need
     // to keep a reference alive after build method returns. Unless
     // its for debugging.
-    // Table transitions;
+    // std::vector<Transitions> transitions;
     // std::vector<ItemSet> states;
+    // std::vector<ItemSet> kernels;
 
     // Build the action table
-    buildStates(states, transitions);
+    buildStates(states, kernels, transitions);
+    endPhase(build_times.states);
     buildTables(states, transitions);
+    endPhase(build_times.tables);
+    recordConflicts(states, transitions);
+    endPhase(build_times.conflicts);
+    if (skip_unit_rules) skipUnitRules();
+    endPhase(build_times.unit_rules);
+    buildDiagnostics();
+    endPhase(build_times.diagnostics);
   }
 
-  Action ActionTable::actionFrom(StateSymbol&& state_symbol) {
-    auto it = action_table.find(state_symbol);
-    return it != action_table.end() ? it->second : Action::error();
+  ActionTable::ActionTable(const Grammar& grammar,
+                           const Prebuilt& prebuilt) noexcept
+      : grammar(grammar),
+        threads(1),
+        symbols(grammar),
+        terminals(symbols.terminalCount()) {
+    view(prebuilt);
+
+    // Every column of a prebuilt table comes from a terminal of the grammar
+    for (size_t t = 0; t < symbols.terminalCount(); ++t) terminals.set(t);
+    conflict_cells = BitSet(stateCount() * symbols.terminalCount());
+    conflict_offsets.push_back(0);
   }
 
-  ActionTable::State ActionTable::gotoFrom(StateSymbol&& state_symbol) {
-    auto it = goto_table.find(state_symbol);
-    return it != goto_table.end() ? it->second : -1;
+  void ActionTable::view(const Prebuilt& arrays) {
+    actions = arrays.actions;
+    gotos = arrays.gotos;
+    rule_lhs = arrays.rule_lhs;
+    rhs_offsets = arrays.rhs_offsets;
+    rhs_ids = arrays.rhs_ids;
+    lhs_offsets = arrays.lhs_offsets;
+    lhs_rules = arrays.lhs_rules;
+    expected_offsets = arrays.expected_offsets;
+    expected_terminals = arrays.expected_terminals;
+    example_offsets = arrays.example_offsets;
+    example_rules = arrays.example_rules;
   }
 
-  void ActionTable::obtainAllTerminals() {
-    for (const auto& rule : grammar) {
-      for (const auto& sym : rule.rhs) {
-        if (sym.type != Symbol::Type::NON_TERMINAL) {
-          terminals.insert(sym);
-        }
-      }
+  void ActionTable::viewStorage() {
+    view({storage.actions, storage.gotos, storage.rule_lhs,
+          storage.rhs_offsets, storage.rhs_ids, storage.lhs_offsets,
+          storage.lhs_rules, storage.expected_offsets,
+          storage.expected_terminals, storage.example_offsets,
+          storage.example_rules});
+  }
+
+  void ActionTable::numberRules() {
+    // The grammar already keeps every RHS back to back, so the id array
+    // mirrors its symbol pool and shares its offsets.
+    std::span<const Symbol> pool = grammar.symbols();
+    storage.rhs_ids.reserve(pool.size());
+    for (const Symbol& sym : pool) {
+      SymbolId id = symbols.idOf(sym);
+      storage.rhs_ids.push_back(id);
+      if (symbols.isTerminal(id)) terminals.set(id);
+    }
+
+    storage.rule_lhs.reserve(grammar.size());
+    storage.rhs_offsets.reserve(grammar.size() + 1);
+    for (size_t i = 0; i < grammar.size(); ++i) {
+      const Grammar::Record& record = grammar.recordOf(i);
+      storage.rule_lhs.push_back(symbols.idOf(record.lhs));
+      storage.rhs_offsets.push_back(record.offset);
     }
+    storage.rhs_offsets.push_back(static_cast<uint32_t>(pool.size()));
 
-    terminals.insert(Symbol::endOF());
+    terminals.set(SymbolTable::ENDOF);
+    viewStorage();
   }
 
-  ActionTable::ItemSet ActionTable::closure(const ItemSet& items) {
-    bool changed = true;
-    ItemSet result = items;
+  void ActionTable::indexRulesByLhs() {
+    lr0::indexByLhs(rules(), symbols.nonTerminalCount(), storage.lhs_offsets,
+                    storage.lhs_rules);
+    viewStorage();
+  }
 
+  void ActionTable::computeNonTerminalClosures() {
+    const size_t nonterminal_count = symbols.nonTerminalCount();
+    const size_t first_nonterminal = symbols.terminalCount();
+    nonterminal_closure.assign(nonterminal_count, BitSet(grammar.size()));
+
+    // Seed every non-terminal with its own rules.
+    for (size_t nt = 0; nt < nonterminal_count; ++nt) {
+      for (uint32_t i = lhs_offsets[nt]; i < lhs_offsets[nt + 1]; ++i) {
+        nonterminal_closure[nt].set(lhs_rules[i]);
+      }
+    }
+
+    // If a rule of N starts with the non-terminal M, everything in the
+    // closure of M is also in the closure of N. Iterate until stable, the
+    // number of rounds is bounded by the longest chain of left corners.
+    bool changed = true;
     while (changed) {
       changed = false;
-      ItemSet new_items;
-
-      // For every item obtain the rule associated
-      for (const auto& item : result) {
-        const Rule& rule = grammar[item.rule_index];
+      for (size_t nt = 0; nt < nonterminal_count; ++nt) {
+        BitSet reachable = nonterminal_closure[nt];
+        reachable.forEach([&](size_t rule_index) {
+          SymbolId corner =
+              symbolAfterDot({static_cast<uint16_t>(rule_index), 0});
+          if (corner == SymbolTable::NONE || symbols.isTerminal(corner)) {
+            return;
+          }
 
-        // Make sure the position hasnt reached the end of the rule
-        if (item.dot_position >= rule.rhs.size()) {
-          continue;
-        }
+          changed |= nonterminal_closure[nt].merge(
+              nonterminal_closure[corner - first_nonterminal]);
+        });
+      }
+    }
+  }
 
-        // Obtain the symbol from the current position
-        auto it = rule.rhs.begin();
-        std::advance(it, item.dot_position);
-        const Symbol& sym = *it;
+  ActionTable::ItemSet ActionTable::closure(const ItemSet& kernel) const {
+    // Gather the initial items introduced by every non-terminal that
+    // appears right after a dot in the kernel.
+    BitSet added(grammar.size());
+    for (const Item& item : kernel) {
+      SymbolId sym = symbolAfterDot(item);
+      if (sym == SymbolTable::NONE || symbols.isTerminal(sym)) {
+        continue;
+      }
+      added.merge(nonterminal_closure[sym - symbols.terminalCount()]);
+    }
 
-        // If its a terminal, skip operation
-        if (sym.type != Symbol::Type::NON_TERMINAL) {
-          continue;
-        }
+    ItemSet result;
+    result.reserve(kernel.size() + added.count());
+    result.insert(result.end(), kernel.begin(), kernel.end());
+    added.forEach([&result](size_t rule_index) {
+      result.push_back({static_cast<uint16_t>(rule_index), 0});
+    });
 
-        // Look for the LHS non-terminal that matches the RHS of the current
-        // rule we are scanning.
-        for (size_t i = 0; i < grammar.size(); ++i) {
-          if (grammar[i].lhs != sym.nonterminal) {
-            continue;
-          }
+    lr0::canonicalize(result);
+    return result;
+  }
 
-          Item new_item{i, 0};
+  void ActionTable::buildStates(std::vector<ItemSet>& states,
+                                std::vector<ItemSet>& kernels,
+                                std::vector<Transitions>& transitions) {
+    using Entry = StateRegistry::Entry;
+
+    const bool automatic = threads == 0;
+    const size_t workers =
+        automatic ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    const size_t min_parallel = automatic ? MIN_PARALLEL_LEVEL : 2;
+
+    // States are identified by their kernel alone. Successors are interned
+    // before their closure is computed, so states that already exist never
+    // pay for a closure again.
+    StateRegistry registry;
+
+    auto number = [&](Entry* entry) {
+      entry->state = states.size();
+      states.push_back(std::move(entry->items));
+      kernels.push_back(entry->kernel);
+      transitions.emplace_back();
+      return entry->state;
+    };
 
-          // Make sure the new_item doesn't exist in set.
-          if (result.find(new_item) != result.end()) {
-            continue;
+    // Augmented start rule: assume rule 0 is S' → S
+    ItemSet start_kernel = {Item{0, 0}};
+    const uint64_t start_hash = KernelHasher{}(start_kernel);
+    Entry* start = registry.intern(std::move(start_kernel), start_hash).first;
+    start->items = closure(start->kernel);
+
+    std::vector<State> level = {number(start)};
+    std::vector<State> next_level;
+
+    // Successors of every state of the level, in the order a sequential
+    // breadth-first build would visit them.
+    std::vector<std::vector<std::pair<SymbolId, Entry*>>> edges;
+
+    while (!level.empty()) {
+      // Expand the whole level. Each worker finds the successor kernels of
+      // its states, interns them and computes the closure of the ones it
+      // registered first. `states` is not modified during this phase.
+      edges.assign(level.size(), {});
+      const size_t level_workers = level.size() >= min_parallel ? workers : 1;
+
+      parallelFor(level.size(), level_workers, [&](size_t i) {
+        std::vector<std::pair<SymbolId, ItemSet>> successors;
+        lr0::successorsOf(rules(), states[level[i]], successors);
+
+        edges[i].reserve(successors.size());
+        for (auto& [sym, kernel] : successors) {
+          const uint64_t hash = KernelHasher{}(kernel);
+          auto [entry, inserted] = registry.intern(std::move(kernel), hash);
+          if (inserted) {
+            entry->items = closure(entry->kernel);
           }
-
-          new_items.insert(new_item);
-          changed = true;
+          edges[i].push_back({sym, entry});
+        }
+      });
+
+      // Number the new states on this thread, in breadth-first order. This
+      // is what makes the output independent of the thread count.
+      next_level.clear();
+      for (size_t i = 0; i < level.size(); ++i) {
+        for (const auto& [sym, entry] : edges[i]) {
+          if (entry->state == StateRegistry::NONE) {
+            next_level.push_back(number(entry));
+          }
+          transitions[level[i]].push_back({sym, entry->state});
         }
       }
 
-      result.insert(new_items.begin(), new_items.end());
+      level.swap(next_level);
     }
-
-    return result;
   }
 
-  ActionTable::ItemSet ActionTable::goTo(const ItemSet& items,
-                                         const Symbol& symbol) {
-    ItemSet moved;
+  void ActionTable::buildTables(std::vector<ItemSet>& states,
+                                std::vector<Transitions>& transitions) {
+    const size_t terminal_count = symbols.terminalCount();
+    const size_t nonterminal_count = symbols.nonTerminalCount();
 
-    for (const auto& item : items) {
-      const Rule& rule = grammar[item.rule_index];
+    storage.actions.assign(states.size() * terminal_count, Action::error());
+    storage.gotos.assign(states.size() * nonterminal_count, NO_GOTO);
+
+    for (size_t state = 0; state < states.size(); ++state) {
+      lr0::fillRow(rules(), states[state], transitions[state],
+                   &storage.actions[state * terminal_count],
+                   &storage.gotos[state * nonterminal_count]);
+    }
+    viewStorage();
+  }
+
+  void ActionTable::skipUnitRules() {
+    const size_t terminal_count = symbols.terminalCount();
+    const size_t nonterminal_count = symbols.nonTerminalCount();
+    const size_t lr0_states = stateCount();
+
+    // Unit rules whose reduction does nothing but relabel the top of the
+    // stack. Rule 0 is never reduced.
+    BitSet unit_rules(grammar.size());
+    for (uint32_t rule = 1; rule < grammar.size(); ++rule) {
+      const Grammar::Record& record = grammar.recordOf(rule);
+      if (record.length == 1 && !record.handler &&
+          !symbols.isTerminal(rhs_ids[rhs_offsets[rule]])) {
+        unit_rules.set(rule);
+      }
+    }
+    if (unit_rules.none()) return;
+
+    // The unit rule each state reduces by. A state with more than one
+    // complete item has a reduce/reduce conflict, which lookahead decides
+    // cell by cell, so a climb never goes through it.
+    std::vector<uint32_t> unit_rule_of(lr0_states, NO_GOTO);
+    for (size_t state = 0; state < lr0_states; ++state) {
+      uint32_t complete = NO_GOTO;
+      size_t count = 0;
+      for (const Item& item : states[state]) {
+        if (symbolAfterDot(item) == SymbolTable::NONE) {
+          complete = item.rule_index;
+          ++count;
+        }
+      }
+      if (count == 1 && unit_rules.test(complete)) {
+        unit_rule_of[state] = complete;
+      }
+    }
 
-      // Skip if dot is at the end
-      if (item.dot_position >= rule.rhs.size()) continue;
+    // Collect every climb and the goto cells that lead into it. Chains are
+    // followed through the original gotos only, merged states are never
+    // part of a chain. Merging grows the storage, so it is written directly
+    // until the views are pointed at it again.
+    std::map<std::vector<uint32_t>, std::vector<uint32_t>> chains;
+    for (size_t state = 0; state < lr0_states; ++state) {
+      for (size_t nt = 0; nt < nonterminal_count; ++nt) {
+        const uint32_t cell = state * nonterminal_count + nt;
+        const uint32_t target = storage.gotos[cell];
+        if (target == NO_GOTO) continue;
+
+        // Reducing A → B in the target pops back to this state and goes
+        // on with goto(state, A). Collect every state of that climb, a
+        // cycle of unit rules is cut after one lap.
+        std::vector<uint32_t> chain = {target};
+        for (uint32_t rule; chain.size() <= nonterminal_count &&
+                            (rule = unit_rule_of[chain.back()]) != NO_GOTO;) {
+          const uint32_t next =
+              storage.gotos[state * nonterminal_count +
+                            (rule_lhs[rule] - terminal_count)];
+          if (next == NO_GOTO) break;
+          chain.push_back(next);
+        }
+        if (chain.size() > 1) chains[std::move(chain)].push_back(cell);
+      }
+    }
 
-      // Get symbol at the current dot position
-      auto it = rule.rhs.begin();
-      std::advance(it, item.dot_position);
-      const Symbol& curr_sym = *it;
+    // Each merged state costs a full row, so their number is bounded by
+    // the LR(0) state count. The climbs that save the most reductions are
+    // merged first.
+    std::vector<std::pair<size_t, const decltype(chains)::value_type*>>
+        ranked;
+    for (const auto& entry : chains) {
+      ranked.emplace_back((entry.first.size() - 1) * entry.second.size(),
+                          &entry);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto& a, const auto& b) {
+                       return a.first > b.first;
+                     });
+
+    const std::vector<uint32_t> lr0_gotos = storage.gotos;
+    std::vector<std::pair<const std::vector<uint32_t>*, uint32_t>> merges;
+    for (const auto& [saved, entry] : ranked) {
+      if (merges.size() >= lr0_states * MAX_MERGED_STATES_PER_STATE) break;
+      const uint32_t merged = mergeChain(entry->first, lr0_gotos, unit_rules);
+      if (merged == NO_GOTO) continue;
+      for (uint32_t cell : entry->second) storage.gotos[cell] = merged;
+      merges.emplace_back(&entry->first, merged);
+    }
 
-      // If it matches the input symbol, move the dot forward
-      if (curr_sym == symbol) {
-        moved.insert({item.rule_index, item.dot_position + 1});
+    // A goto out of a merged state can lead to a merged state as well,
+    // wherever every state of its climb now agrees on one
+    for (const auto& [chain, merged] : merges) {
+      for (size_t nt = 0; nt < nonterminal_count; ++nt) {
+        uint32_t target = NO_GOTO;
+        bool agree = true;
+        for (uint32_t state : *chain) {
+          const uint32_t next = storage.gotos[state * nonterminal_count + nt];
+          if (next == NO_GOTO) continue;
+          agree = agree && (target == NO_GOTO || target == next);
+          target = next;
+        }
+        if (agree && target != NO_GOTO) {
+          storage.gotos[merged * nonterminal_count + nt] = target;
+        }
       }
     }
 
-    // Return closure of all advanced items
-    return closure(moved);
+    // Merged states are new rows of the conflict bitmap as well
+    viewStorage();
+    conflict_cells = BitSet(stateCount() * terminal_count);
+    for (uint32_t cell : conflict_keys) conflict_cells.set(cell);
   }
 
-  void ActionTable::buildStates(std::vector<ItemSet>& states,
-                                Table& transitions) {
-    // Augmented start rule: assume rule 0 is S' → S
-    states.push_back(closure({Item{0, 0}}));
+  uint32_t ActionTable::mergeChain(const std::vector<uint32_t>& chain,
+                                   const std::vector<uint32_t>& lr0_gotos,
+                                   const BitSet& unit_rules) {
+    const size_t terminal_count = symbols.terminalCount();
+    const size_t nonterminal_count = symbols.nonTerminalCount();
+
+    // The merged state stands for whichever state of the chain ends up on
+    // top of the stack, so it needs the gotos of all of them. Give up if
+    // two of them disagree.
+    std::vector<uint32_t> goto_row(nonterminal_count, NO_GOTO);
+    for (uint32_t state : chain) {
+      for (size_t nt = 0; nt < nonterminal_count; ++nt) {
+        const uint32_t target = lr0_gotos[state * nonterminal_count + nt];
+        if (target == NO_GOTO) continue;
+        if (goto_row[nt] != NO_GOTO && goto_row[nt] != target) return NO_GOTO;
+        goto_row[nt] = target;
+      }
+    }
 
-    ItemSetState itemset_to_state;
-    itemset_to_state[states[0]] = 0;
+    // For every terminal, take the action of the first state of the chain
+    // that does something else than a skipped unit reduction. That is the
+    // action the unoptimized parser ends up taking with that lookahead. A
+    // skipped cell never has a conflict, the climb stops at reduce/reduce
+    // states and a shift always wins over a reduce, so the merged cell
+    // keeps the conflict of the state its action comes from.
+    const uint32_t merged =
+        static_cast<uint32_t>(storage.actions.size() / terminal_count);
+    for (size_t t = 0; t < terminal_count; ++t) {
+      Action action = Action::error();
+      uint32_t from = chain.back();
+      for (uint32_t state : chain) {
+        action = storage.actions[state * terminal_count + t];
+        from = state;
+        const bool skipped = action.type == Action::REDUCE &&
+                             unit_rules.test(action.rule_index);
+        if (!skipped) break;
+      }
+      storage.actions.push_back(action);
+
+      if (hasConflict(from, static_cast<SymbolId>(t))) {
+        const std::span<const Action> conflict =
+            conflictsAt(from, static_cast<SymbolId>(t));
+        const std::vector<Action> copy(conflict.begin(), conflict.end());
+        conflict_actions.insert(conflict_actions.end(), copy.begin(),
+                                copy.end());
+        conflict_keys.push_back(
+            static_cast<uint32_t>(merged * terminal_count + t));
+        conflict_offsets.push_back(
+            static_cast<uint32_t>(conflict_actions.size()));
+      }
+    }
+    storage.gotos.insert(storage.gotos.end(), goto_row.begin(),
+                         goto_row.end());
+    return merged;
+  }
 
-    std::queue<State> worklist;
-    worklist.push(0);
+  void ActionTable::buildDiagnostics() {
+    lr0::diagnose(rules(), actions, symbols.errorId(),
+                  storage.expected_offsets, storage.expected_terminals,
+                  storage.example_offsets, storage.example_rules);
+    viewStorage();
+  }
+
+  std::vector<BitSet> ActionTable::followSets() const {
+    const size_t terminal_count = symbols.terminalCount();
+    const size_t nonterminal_count = symbols.nonTerminalCount();
 
-    while (!worklist.empty()) {
-      State current_state = worklist.front();
-      worklist.pop();
+    std::vector<bool> nullable(nonterminal_count, false);
+    std::vector<BitSet> first(nonterminal_count, BitSet(terminal_count));
+    std::vector<BitSet> follow(nonterminal_count, BitSet(terminal_count));
+    follow[rule_lhs[0] - terminal_count].set(SymbolTable::ENDOF);
 
-      ItemSet state_items = states[current_state];
+    auto add = [](BitSet& set, SymbolId terminal) {
+      if (set.test(terminal)) return false;
+      set.set(terminal);
+      return true;
+    };
 
-      // Collect all symbols that appear just after a dot
-      SymbolSet next_symbols;
-      for (const Item& item : state_items) {
-        const Rule& rule = grammar[item.rule_index];
-        if (item.dot_position < rule.rhs.size()) {
-          // Get symbol at the current dot position
-          auto it = rule.rhs.begin();
-          std::advance(it, item.dot_position);
-          next_symbols.insert(*it);
+    // FIRST, nullability and FOLLOW only ever grow, so they are all
+    // iterated together until none of them changes.
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (uint32_t rule = 0; rule < grammar.size(); ++rule) {
+        const size_t lhs = rule_lhs[rule] - terminal_count;
+        const uint32_t begin = rhs_offsets[rule];
+        const uint32_t end = rhs_offsets[rule + 1];
+
+        bool all_nullable = true;
+        for (uint32_t i = begin; i < end && all_nullable; ++i) {
+          const SymbolId sym = rhs_ids[i];
+          if (symbols.isTerminal(sym)) {
+            changed |= add(first[lhs], sym);
+            all_nullable = false;
+          } else {
+            changed |= first[lhs].merge(first[sym - terminal_count]);
+            all_nullable = nullable[sym - terminal_count];
+          }
+        }
+        if (all_nullable && !nullable[lhs]) {
+          nullable[lhs] = true;
+          changed = true;
         }
-      }
 
-      for (const Symbol& sym : next_symbols) {
-        ItemSet next = goTo(state_items, sym);
-        if (next.empty()) continue;
+        // Walk the RHS backwards carrying what may follow each symbol
+        BitSet trailer = follow[lhs];
+        for (uint32_t i = end; i-- > begin;) {
+          const SymbolId sym = rhs_ids[i];
+          if (symbols.isTerminal(sym)) {
+            trailer.clear();
+            trailer.set(sym);
+            continue;
+          }
 
-        State target_state;
-        auto it = itemset_to_state.find(next);
-        if (it != itemset_to_state.end()) {
-          target_state = it->second;
-        } else {
-          target_state = states.size();
-          states.push_back(next);
-          itemset_to_state[next] = target_state;
-          worklist.push(target_state);
+          const size_t nt = sym - terminal_count;
+          changed |= follow[nt].merge(trailer);
+          if (!nullable[nt]) trailer.clear();
+          trailer.merge(first[nt]);
         }
-
-        transitions[{current_state, sym}] = target_state;
       }
     }
+    return follow;
   }
 
-  void ActionTable::buildTables(std::vector<ItemSet>& states,
-                                Table& transitions) {
+  void ActionTable::recordConflicts(
+      const std::vector<ItemSet>& states,
+      const std::vector<Transitions>& transitions) {
+    const size_t terminal_count = symbols.terminalCount();
+    const std::vector<BitSet> follow = followSets();
+
+    conflict_cells = BitSet(stateCount() * terminal_count);
+    conflict_offsets.push_back(0);
+
+    // A reduction only makes sense on a terminal that can follow its LHS,
+    // that is SLR(1) lookahead on top of the LR(0) automaton.
+    auto viable = [&](const Action& action, SymbolId terminal) {
+      return action.type != Action::REDUCE ||
+             follow[rule_lhs[action.rule_index] - terminal_count].test(
+                 terminal);
+    };
+
+    std::vector<Action> candidates;
     for (size_t state = 0; state < states.size(); ++state) {
-      const auto& items = states[state];
-
-      for (const Item& item : items) {
-        const Rule& rule = grammar[item.rule_index];
-
-        if (item.dot_position < rule.rhs.size()) {
-          // Get symbol at the current dot position
-          auto it = rule.rhs.begin();
-          std::advance(it, item.dot_position);
-
-          // Dot is not at end → try shift
-          Symbol sym = *it;
-          if (sym.type != Symbol::Type::NON_TERMINAL) {
-            auto it = transitions.find({state, sym});
-            if (it != transitions.end()) {
-              action_table[{state, sym}] = Action::shift(it->second);
-            }
-          }
-        } else {
-          // Dot at end → reduce or accept
-          if (item.rule_index == 0) {
-            // Accept on end-of-input symbol
-            action_table[{state, Symbol::endOF()}] = Action::accept();
-          } else {
-            // Reduce by this rule for all terminals
-            for (const Symbol& terminal : terminals) {
-              action_table[{state, terminal}] = Action::reduce(item.rule_index);
-            }
-          }
+      std::vector<uint32_t> complete;
+      for (const Item& item : states[state]) {
+        if (symbolAfterDot(item) == SymbolTable::NONE) {
+          complete.push_back(item.rule_index);
         }
       }
+      if (complete.empty()) continue;
 
-      // Handle gotos for non-terminals
-      for (const auto& [key, target] : transitions) {
-        if (key.first == state &&
-            key.second.type == Symbol::Type::NON_TERMINAL) {
-          goto_table[{state, key.second}] = target;
+      terminals.forEach([&](size_t terminal) {
+        // Every action fillRow() offered this cell
+        candidates.clear();
+        for (const auto& [sym, target] : transitions[state]) {
+          if (sym == terminal) candidates.push_back(Action::shift(target));
         }
-      }
+        for (uint32_t rule : complete) {
+          if (rule != 0) {
+            candidates.push_back(Action::reduce(rule));
+          } else if (terminal == SymbolTable::ENDOF) {
+            candidates.push_back(Action::accept());
+          }
+        }
+        if (candidates.size() < 2) return;
+
+        const size_t cell = state * terminal_count + terminal;
+        const Action resolved = actions[cell];
+        const size_t begin = conflict_actions.size();
+        if (viable(resolved, terminal)) conflict_actions.push_back(resolved);
+        for (const Action& action : candidates) {
+          if (!(action == resolved) && viable(action, terminal)) {
+            conflict_actions.push_back(action);
+          }
+        }
+        if (conflict_actions.size() == begin) {
+          conflict_actions.push_back(resolved);
+        }
+
+        conflict_cells.set(cell);
+        conflict_keys.push_back(static_cast<uint32_t>(cell));
+        conflict_offsets.push_back(
+            static_cast<uint32_t>(conflict_actions.size()));
+      });
     }
   }
 
+  std::span<const Action> ActionTable::conflictsAt(State state,
+                                                   SymbolId terminal) const {
+    if (!hasConflict(state, terminal)) return {};
+
+    const uint32_t cell =
+        static_cast<uint32_t>(state * symbols.terminalCount() + terminal);
+    const size_t i =
+        std::lower_bound(conflict_keys.begin(), conflict_keys.end(), cell) -
+        conflict_keys.begin();
+    return {conflict_actions.data() + conflict_offsets[i],
+            conflict_offsets[i + 1] - conflict_offsets[i]};
+  }
+
+  size_t ActionTable::conflictCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < conflict_offsets.size(); ++i) {
+      count += conflict_offsets[i + 1] - conflict_offsets[i] > 1;
+    }
+    return count;
+  }
+
   std::vector<Symbol> compiler::ActionTable::validSymbols(State state) const {
     std::vector<Symbol> result;
-    std::unordered_set<Symbol, SymbolHash> seen;
-
-    for (const auto& [state_symbol, action] : action_table) {
-      if (state_symbol.first == state && action.type != Action::ERROR) {
-        const Symbol& sym = state_symbol.second;
-        // Avoid duplicates
-        if (seen.insert(sym).second) {
-          result.push_back(sym);
-        }
-      }
+    std::span<const SymbolId> expected = expectedTerminals(state);
+
+    result.reserve(expected.size());
+    for (SymbolId terminal : expected) {
+      result.push_back(symbols.symbolOf(terminal));
     }
 
     return result;
   }
 
-}  // namespace compiler
\ No newline at end of file
+}  // namespace compiler
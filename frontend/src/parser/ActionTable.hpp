@@ -1,9 +1,13 @@
 #pragma once
 
-#include <unordered_map>
-#include <unordered_set>
+#include <chrono>
+#include <span>
 #include <vector>
 
+#include "BitSet.hpp"
+#include "Grammar.hpp"
+#include "LR0.hpp"
+#include "SymbolTable.hpp"
 #include "Symbols.hpp"
 
 namespace compiler {
@@ -12,81 +16,152 @@ namespace compiler {
    * @brief
    *
    */
-  struct Action {
-    enum Type { SHIFT, REDUCE, ACCEPT, ERROR } type;
-    union {
-      uint32_t rule_index;
-      uint32_t next_state;
+  class ActionTable final {
+  public:
+    using State = size_t;
+
+    static constexpr State NO_STATE = static_cast<State>(-1);
+
+    /**
+     * @brief Time spent in each phase of the construction.
+     *
+     */
+    struct BuildTimes {
+      std::chrono::nanoseconds rules{0};  // Numbering and closure sets
+      std::chrono::nanoseconds states{0};
+      std::chrono::nanoseconds tables{0};
+      std::chrono::nanoseconds unit_rules{0};
+      std::chrono::nanoseconds conflicts{0};
+      std::chrono::nanoseconds diagnostics{0};
     };
 
     /**
-     * @brief Prepares a reduce action
+     * @brief Every array of a table whose automaton was built elsewhere, by
+     *        StaticTable in the compiler. Numbered for the grammar the
+     *        table is made for, laid out like the members of the same name.
      *
-     * @param rule_index
-     * @return Action
      */
-    static Action reduce(uint32_t rule_index) {
-      return Action{.type = REDUCE, .rule_index = rule_index};
-    }
+    struct Prebuilt {
+      std::span<const Action> actions;
+      std::span<const uint32_t> gotos;
+      std::span<const SymbolId> rule_lhs;
+      std::span<const uint32_t> rhs_offsets;
+      std::span<const SymbolId> rhs_ids;
+      std::span<const uint32_t> lhs_offsets;
+      std::span<const uint32_t> lhs_rules;
+      std::span<const uint32_t> expected_offsets;
+      std::span<const SymbolId> expected_terminals;
+      std::span<const uint32_t> example_offsets;
+      std::span<const uint32_t> example_rules;
+    };
 
+  public:
     /**
-     * @brief Prepares a shift action
+     * @brief Construct a new Action Table object
      *
-     * @param next_state
-     * @return Action
+     *        The automaton is built level by level. Levels that are wide
+     *        enough are expanded by several threads, the result is identical
+     *        for any thread count.
+     *
+     *        With `skip_unit_rules` the tables avoid reducing by unit rules
+     *        A → B that have no handler. A goto that leads to such a
+     *        reduction goes straight to a merged state that acts like the
+     *        whole chain of reductions would, so a bare operand climbs a
+     *        precedence chain in one goto instead of one reduction per
+     *        level. Every merged state is a new row, so at most one per
+     *        LR(0) state is added, for the chains that save the most
+     *        reductions. Chains stop at states with a reduce/reduce
+     *        conflict, and merged cells keep the conflicts of the cell their
+     *        action comes from.
+     *
+     * @param grammar
+     * @param threads         worker threads to use, 0 picks one per hardware
+     *                        thread
+     * @param skip_unit_rules short-circuit unit rules without a handler
      */
-    static Action shift(uint32_t next_state) {
-      return Action{.type = SHIFT, .next_state = next_state};
-    }
+    explicit ActionTable(const Grammar& grammar, size_t threads = 0,
+                         bool skip_unit_rules = false) noexcept;
 
     /**
-     * @brief Prepares an accept action
+     * @brief Construct an Action Table around an automaton built elsewhere.
+     *        The table is a view over the given arrays, which are read
+     *        where they lie and must outlive it, nothing is built or
+     *        copied. The LR(0) states are not known, so neither are the
+     *        conflicts: hasConflict() is always false and the table is only
+     *        fit for deterministic parsing.
      *
-     * @return Action
+     * @param grammar
+     * @param prebuilt
      */
-    static Action accept() { return Action{.type = ACCEPT}; }
+    explicit ActionTable(const Grammar& grammar,
+                         const Prebuilt& prebuilt) noexcept;
+
+    // The views may point into the table's own storage
+    ActionTable(const ActionTable&) = delete;
+    ActionTable& operator=(const ActionTable&) = delete;
 
     /**
-     * @brief Prepares an error action
+     * @brief Returns the action for a state and a terminal id. Terminals
+     *        outside of the grammar always map to an error.
      *
+     * @param state
+     * @param terminal
      * @return Action
      */
-    static Action error() { return Action{.type = ERROR}; }
-  };
+    Action actionFrom(State state, SymbolId terminal) const {
+      return terminal < symbols.terminalCount()
+                 ? actions[state * symbols.terminalCount() + terminal]
+                 : Action::error();
+    }
 
-  /**
-   * @brief
-   *
-   */
-  class ActionTable final {
-  public:
-    using State = size_t;
-    using StateSymbol = std::pair<State, Symbol>;
+    /**
+     * @brief Returns the state reached from a state through a non-terminal
+     *        id. Returns NO_STATE if there is no such transition.
+     *
+     * @param state
+     * @param nonterminal
+     * @return State
+     */
+    State gotoFrom(State state, SymbolId nonterminal) const {
+      uint32_t target =
+          gotos[state * symbols.nonTerminalCount() +
+                (nonterminal - symbols.terminalCount())];
+      return target != NO_GOTO ? target : NO_STATE;
+    }
 
-  public:
     /**
-     * @brief Construct a new Action Table object
+     * @brief Returns whether the grammar allowed more than one action for a
+     *        state and a terminal before actionFrom() settled on one.
      *
-     * @param grammar
+     * @param state
+     * @param terminal
+     * @return true if conflictsAt() has the actions of the cell
      */
-    explicit ActionTable(const Grammar& grammar) noexcept;
+    bool hasConflict(State state, SymbolId terminal) const {
+      return terminal < symbols.terminalCount() &&
+             conflict_cells.test(state * symbols.terminalCount() + terminal);
+    }
 
     /**
-     * @brief Returns the corresponding action from a state symbol.
+     * @brief Returns every action a conflict cell could take, the one
+     *        actionFrom() resolved to first. Reductions by a rule whose LHS
+     *        is never followed by the terminal are left out, so a cell can
+     *        come down to a single action that only corrects the LR(0)
+     *        default. Empty for cells without a conflict.
      *
-     * @param state_symbol
-     * @return Action
+     * @param state
+     * @param terminal
+     * @return std::span<const Action>
      */
-    Action actionFrom(StateSymbol&& state_symbol);
+    std::span<const Action> conflictsAt(State state, SymbolId terminal) const;
 
     /**
-     * @brief Returns the corresponding state from a state symbol.
-     *        Returns (-1) if the state symbol doesnt map to a state.
+     * @brief Returns the number of cells left with more than one action,
+     *        the places where a GLR parser forks.
      *
-     * @param state_symbol
-     * @return State
+     * @return size_t
      */
-    State gotoFrom(StateSymbol&& state_symbol);
+    size_t conflictCount() const;
 
     /**
      * @brief Returns a list of valid terminal symbols for a given state.
@@ -96,49 +171,203 @@ namespace compiler {
      */
     std::vector<Symbol> validSymbols(State state) const;
 
+    /**
+     * @brief Returns the ids of every terminal with a non-error action in a
+     *        state. Precomputed, so reporting a syntax error never scans the
+     *        table.
+     *
+     * @param state
+     * @return std::span<const SymbolId>
+     */
+    std::span<const SymbolId> expectedTerminals(State state) const {
+      return {expected_terminals.data() + expected_offsets[state],
+              expected_offsets[state + 1] - expected_offsets[state]};
+    }
+
+    /**
+     * @brief Returns the rules whose RHS starts with one of the expected
+     *        terminals of a state, used as examples of valid syntax.
+     *
+     * @param state
+     * @return std::span<const uint32_t>
+     */
+    std::span<const uint32_t> exampleRules(State state) const {
+      return {example_rules.data() + example_offsets[state],
+              example_offsets[state + 1] - example_offsets[state]};
+    }
+
+    /**
+     * @brief Returns the id of the non-terminal a rule reduces to.
+     *
+     * @param rule_index
+     * @return SymbolId
+     */
+    SymbolId lhsOf(size_t rule_index) const { return rule_lhs[rule_index]; }
+
+    /**
+     * @brief Returns the indices of every rule of a non-terminal, in
+     *        grammar order. Empty if the grammar never uses it.
+     *
+     * @param lhs
+     * @return std::span<const uint32_t>
+     */
+    std::span<const uint32_t> rulesOf(NonTerminal lhs) const {
+      const SymbolId id = symbols.idOf(lhs);
+      if (id == SymbolTable::NONE) return {};
+      const size_t nt = id - symbols.terminalCount();
+      return {lhs_rules.data() + lhs_offsets[nt],
+              lhs_offsets[nt + 1] - lhs_offsets[nt]};
+    }
+
+    /**
+     * @brief Returns the number of states of the tables. This includes the
+     *        merged states added when skipping unit rules, `states` only
+     *        holds the LR(0) ones.
+     *
+     * @return size_t
+     */
+    size_t stateCount() const {
+      return actions.size() / symbols.terminalCount();
+    }
+
+    /**
+     * @brief Returns how long each phase of the construction took.
+     *
+     * @return const BuildTimes&
+     */
+    const BuildTimes& buildTimes() const { return build_times; }
+
   private:
     const Grammar& grammar;
+    size_t threads;
+    BuildTimes build_times;
 
   public:
-    struct Item {
-      size_t rule_index;
-      size_t dot_position;
-      bool operator==(const Item& other) const;
-    };
+    using Item = lr0::Item;
+    using ItemSet = lr0::ItemSet;
 
-    struct ItemHasher {
-      size_t operator()(const Item& item) const;
+    /**
+     * @brief Hashes the packed items of a sorted item set. Only kernels are
+     *        ever hashed, closures are fully determined by them.
+     *
+     */
+    struct KernelHasher {
+      uint64_t operator()(const ItemSet& kernel) const;
     };
 
-    using ItemSet = std::unordered_set<Item, ItemHasher>;
-
-    struct ItemSetHasher {
-      size_t operator()(const ItemSet& set) const;
-    };
+    /**
+     * @brief Outgoing transitions of a single state, in the order in which
+     *        their symbols first appear in the state's items.
+     *
+     */
+    using Transitions = std::vector<std::pair<SymbolId, State>>;
 
   public:
-    using SymbolSet = std::unordered_set<Symbol, SymbolHash>;
-    using ItemSetState = std::unordered_map<ItemSet, State, ItemSetHasher>;
+    // Dense numbering of every symbol of the grammar
+    SymbolTable symbols;
 
-    using Table = std::unordered_map<StateSymbol, State, StateSymbolHash>;
-    using ATable = std::unordered_map<StateSymbol, Action, StateSymbolHash>;
-    using GTable = std::unordered_map<StateSymbol, State, StateSymbolHash>;
+    // Ids of every terminal the action table has a column for
+    BitSet terminals;
 
-    GTable goto_table;
-    ATable action_table;
-    SymbolSet terminals;
+    // Row-major [state][terminal] actions and [state][non-terminal] gotos.
+    // Non-terminal columns are offset by the terminal count. Like every
+    // array below, they view either `storage` or a prebuilt table.
+    std::span<const Action> actions;
+    std::span<const uint32_t> gotos;
 
     // // Just for testing, can be removed once everything works
-    Table transitions;
+    std::vector<Transitions> transitions;
     std::vector<ItemSet> states;
+    std::vector<ItemSet> kernels;
 
   private:
-    void obtainAllTerminals();
+    static constexpr uint32_t NO_GOTO = lr0::NO_GOTO;
+
+    // Merged states a table skipping unit rules may add per LR(0) state
+    static constexpr size_t MAX_MERGED_STATES_PER_STATE = 1;
+
+    // Symbol ids of every rule: the LHS of rule R is rule_lhs[R], and its
+    // RHS is rhs_ids[rhs_offsets[R] .. rhs_offsets[R + 1]).
+    std::span<const SymbolId> rule_lhs;
+    std::span<const uint32_t> rhs_offsets;
+    std::span<const SymbolId> rhs_ids;
+
+    // Rules grouped by their LHS. The rules of non-terminal N are
+    // lhs_rules[lhs_offsets[N] .. lhs_offsets[N + 1]), where N is counted
+    // from the first non-terminal id.
+    std::span<const uint32_t> lhs_offsets;
+    std::span<const uint32_t> lhs_rules;
+
+    // Diagnostics of every state: expected terminals and example rules of
+    // state S live in [offsets[S], offsets[S + 1]) of their arrays.
+    std::span<const uint32_t> expected_offsets;
+    std::span<const SymbolId> expected_terminals;
+    std::span<const uint32_t> example_offsets;
+    std::span<const uint32_t> example_rules;
+
+    // The arrays of a table built here. The construction writes them and
+    // points the views above at them once a phase is done.
+    struct Storage {
+      std::vector<Action> actions;
+      std::vector<uint32_t> gotos;
+      std::vector<SymbolId> rule_lhs;
+      std::vector<uint32_t> rhs_offsets;
+      std::vector<SymbolId> rhs_ids;
+      std::vector<uint32_t> lhs_offsets;
+      std::vector<uint32_t> lhs_rules;
+      std::vector<uint32_t> expected_offsets;
+      std::vector<SymbolId> expected_terminals;
+      std::vector<uint32_t> example_offsets;
+      std::vector<uint32_t> example_rules;
+    } storage;
+
+    // For every non-terminal N, the rules whose initial item [R -> . a]
+    // belongs to closure({[X -> . N]}). Computed once per grammar, so the
+    // closure of a kernel is just the union of these sets.
+    std::vector<BitSet> nonterminal_closure;
+
+    // Cells with more than one candidate action. Bit S * T + t is set for
+    // the cell of state S and terminal t, its actions are
+    // conflict_actions[conflict_offsets[i] .. conflict_offsets[i + 1]) where
+    // i is the position of the cell in the sorted conflict_keys.
+    BitSet conflict_cells;
+    std::vector<uint32_t> conflict_keys;
+    std::vector<uint32_t> conflict_offsets;
+    std::vector<Action> conflict_actions;
+
+  private:
+    void view(const Prebuilt& arrays);
+    void viewStorage();
+
+    void numberRules();
+    void indexRulesByLhs();
+    void computeNonTerminalClosures();
+
+    lr0::Rules rules() const {
+      return {rule_lhs, rhs_offsets, rhs_ids, symbols.terminalCount()};
+    }
+
+    SymbolId symbolAfterDot(const Item& item) const {
+      return rules().symbolAfterDot(item);
+    }
+
+    ItemSet closure(const ItemSet& kernel) const;
+
+    void buildStates(std::vector<ItemSet>& states,
+                     std::vector<ItemSet>& kernels,
+                     std::vector<Transitions>& transitions);
+    void buildTables(std::vector<ItemSet>& states,
+                     std::vector<Transitions>& transitions);
+
+    void skipUnitRules();
+    uint32_t mergeChain(const std::vector<uint32_t>& chain,
+                        const std::vector<uint32_t>& lr0_gotos,
+                        const BitSet& unit_rules);
 
-    ItemSet closure(const ItemSet& items);
-    ItemSet goTo(const ItemSet& items, const Symbol& symbol);
+    void buildDiagnostics();
 
-    void buildStates(std::vector<ItemSet>& states, Table& transitions);
-    void buildTables(std::vector<ItemSet>& states, Table& transitions);
+    std::vector<BitSet> followSets() const;
+    void recordConflicts(const std::vector<ItemSet>& states,
+                         const std::vector<Transitions>& transitions);
   };
 }  // namespace compiler
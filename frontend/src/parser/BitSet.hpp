@@ -0,0 +1,82 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace compiler {
+
+  /**
+   * @brief Dynamically sized set of small integers stored as packed bits.
+   *
+   *        Used by the table builder for sets indexed by rule or symbol
+   *        numbers, where a hash set would spend most of its time hashing.
+   */
+  class BitSet final {
+  public:
+    explicit BitSet(size_t bits = 0) noexcept : words((bits + 63) / 64, 0) {}
+
+    void set(size_t bit) { words[bit >> 6] |= uint64_t{1} << (bit & 63); }
+
+    void reset(size_t bit) { words[bit >> 6] &= ~(uint64_t{1} << (bit & 63)); }
+
+    bool test(size_t bit) const {
+      return (words[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    /**
+     * @brief Adds every bit of other into this set.
+     *
+     * @param other set of the same size
+     * @return true if any new bit was added
+     */
+    bool merge(const BitSet& other) {
+      bool changed = false;
+      for (size_t i = 0; i < words.size(); ++i) {
+        uint64_t merged = words[i] | other.words[i];
+        changed |= merged != words[i];
+        words[i] = merged;
+      }
+      return changed;
+    }
+
+    void clear() {
+      for (uint64_t& word : words) word = 0;
+    }
+
+    bool none() const {
+      for (uint64_t word : words) {
+        if (word) return false;
+      }
+      return true;
+    }
+
+    size_t count() const {
+      size_t total = 0;
+      for (uint64_t word : words) total += std::popcount(word);
+      return total;
+    }
+
+    /**
+     * @brief Calls fn(bit) for every set bit, in increasing order.
+     *
+     * @param fn
+     */
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+      for (size_t i = 0; i < words.size(); ++i) {
+        uint64_t word = words[i];
+        while (word) {
+          fn(i * 64 + std::countr_zero(word));
+          word &= word - 1;
+        }
+      }
+    }
+
+    bool operator==(const BitSet& other) const = default;
+
+  private:
+    std::vector<uint64_t> words;
+  };
+}  // namespace compiler
@@ -0,0 +1,494 @@
+#include "GLRParser.hpp"
+
+#include <algorithm>
+
+#include "BitSet.hpp"
+#include "TableCache.hpp"
+#include "ast/Reductions.hpp"
+
+namespace compiler {
+
+  GLRParser::GLRParser(TokenStream& tokens, const Grammar& grammar) noexcept
+      : GLRParser(tokens, grammar,
+                  TableCache::tableFor(grammar, /*skip_unit_rules=*/false)) {}
+
+  GLRParser::GLRParser(TokenStream& tokens, const Grammar& grammar,
+                       const ActionTable& table) noexcept
+      : grammar(grammar),
+        tokens(tokens),
+        action_table(table),
+        forest(),
+        lookahead(SymbolTable::ENDOF),
+        lookahead_token(Token::endOF()),
+        position(0),
+        forks(0) {
+    tokens.mapTerminals(action_table.symbols.terminalMap());
+  }
+
+  GLRParser::ForestResult GLRParser::parse() {
+    forest.clear();
+    nodes.clear();
+    links.clear();
+    level.clear();
+    symbols.clear();
+    pending.clear();
+    shifts.clear();
+    prebuilt.clear();
+    position = 0;
+    forks = 0;
+
+    program.storage.clear();
+    program.storage.reserve(tokens.source().size() /
+                            Parser::BYTES_PER_TOKEN);
+    program.errors.clear();
+    program.root = NO_INDEX;
+    stack.clear();
+    stack.push({Symbol::start(), 0});
+    lookahead = nextSymbol();
+
+    // The LR loop of Parser, for as long as no cell offers a choice. A
+    // conflict cell left with a single viable action is no choice either.
+    while (true) {
+      if (!lookahead) {
+        return std::unexpected(lookahead.error());
+      }
+      const SymbolId terminal = *lookahead;
+
+      const ActionTable::State state = stack.peekTop().state;
+      Action action = action_table.actionFrom(state, terminal);
+      std::span<const Action> actions =
+          action_table.conflictsAt(state, terminal);
+      if (actions.size() > 1) break;
+      if (actions.size() == 1) action = actions.front();
+
+      switch (action.type) {
+        case Action::SHIFT:
+          stack.push({action_table.symbols.symbolOf(terminal),
+                      action.next_state,
+                      reductions::tokenLeaf(program.storage, lookahead_token,
+                                            tokens.source()),
+                      position});
+          ++position;
+          lookahead = nextSymbol();
+          break;
+
+        case Action::REDUCE: {
+          const Grammar::Record& r = grammar.recordOf(action.rule_index);
+          const SymbolId lhs = action_table.lhsOf(action.rule_index);
+          std::span<const ASTSymbolState> rhs = stack.peekTop(r.length);
+          const uint32_t begin = rhs.empty() ? position : rhs.front().token;
+          const Index node = r.handler ? r.handler(program.storage, rhs)
+                             : rhs.empty() ? NO_INDEX
+                                           : rhs.front().node;
+          stack.pop(r.length);
+
+          const ActionTable::State next =
+              action_table.gotoFrom(stack.peekTop().state, lhs);
+          if (next == ActionTable::NO_STATE) {
+            return ParserError::makeInternalError();
+          }
+          stack.push({action_table.symbols.symbolOf(lhs), next, node, begin});
+          break;
+        }
+
+        case Action::ACCEPT:
+          forkStack();
+          return accept(level.front());
+
+        case Action::ERROR:
+          forkStack();
+          return std::unexpected(syntaxError());
+      }
+    }
+
+    forkStack();
+    return parseForked();
+  }
+
+  void GLRParser::forkStack() {
+    // Every entry becomes a node of the graph linked to the one below it
+    // by a forest node, which stands for the AST the entry already has
+    std::span<const ASTSymbolState> entries = stack.peekTop(stack.size());
+    forest.first_token = position;
+    nodes.push_back({0, 0, NONE, false});  // The bottom of every stack
+    uint32_t below = 0;
+    for (size_t i = 1; i < entries.size(); ++i) {
+      const ASTSymbolState& entry = entries[i];
+      const uint32_t end =
+          i + 1 < entries.size() ? entries[i + 1].token : position;
+
+      const uint32_t forest_node = static_cast<uint32_t>(forest.nodes.size());
+      forest.nodes.push_back({action_table.symbols.idOf(entry.symbol),
+                              entry.token, end, ParseForest::NONE});
+      prebuilt.push_back(entry.node);
+
+      const uint32_t node = static_cast<uint32_t>(nodes.size());
+      nodes.push_back({entry.state, end, NONE, false});
+      link(node, below, forest_node);
+      below = node;
+    }
+
+    level.push_back(below);
+    pending.push_back({below, NONE});
+  }
+
+  GLRParser::ForestResult GLRParser::parseForked() {
+    while (true) {
+      if (!lookahead) {
+        return std::unexpected(lookahead.error());
+      }
+      const SymbolId terminal = *lookahead;
+
+      // A single stack top on a cell with a single action is a plain LR
+      // step. The top is popped or left behind by its action, so it leaves
+      // the level and nothing else at this position merges with it.
+      const uint32_t top = level.front();
+      Action action = action_table.actionFrom(nodes[top].state, terminal);
+      std::span<const Action> actions =
+          action_table.conflictsAt(nodes[top].state, terminal);
+      if (actions.size() == 1) action = actions.front();
+
+      if (level.size() == 1 && actions.size() <= 1) {
+        nodes[top].done = true;
+        pending.clear();
+
+        switch (action.type) {
+          case Action::SHIFT:
+            shifts.push_back({top, action.next_state});
+            shift();
+            break;
+
+          case Action::REDUCE:
+            level.clear();
+            reduceFrom(top, action.rule_index);
+            if (level.empty()) return ParserError::makeInternalError();
+            break;
+
+          case Action::ACCEPT:
+            return accept(top);
+
+          case Action::ERROR:
+            return std::unexpected(syntaxError());
+        }
+        continue;
+      }
+
+      // Otherwise every stack top takes every action of its cell. New tops
+      // and new edges under tops already done are queued until no parse
+      // can reduce any further, then all of them shift at once.
+      uint32_t accepted = NONE;
+      while (!pending.empty()) {
+        const Task task = pending.back();
+        pending.pop_back();
+        takeActions(task, terminal, accepted);
+      }
+
+      if (accepted != NONE) return accept(accepted);
+      if (shifts.empty()) return std::unexpected(syntaxError());
+      shift();
+    }
+  }
+
+  void GLRParser::takeActions(const Task& task, SymbolId terminal,
+                              uint32_t& accepted) {
+    const ActionTable::State state = nodes[task.node].state;
+
+    std::span<const Action> actions =
+        action_table.conflictsAt(state, terminal);
+    const Action resolved = action_table.actionFrom(state, terminal);
+    if (actions.empty()) actions = {&resolved, 1};
+    if (task.link == NONE) {
+      nodes[task.node].done = true;
+      forks += actions.size() > 1;
+    }
+
+    for (const Action& action : actions) {
+      switch (action.type) {
+        case Action::SHIFT:
+          if (task.link == NONE) {
+            shifts.push_back({task.node, action.next_state});
+          }
+          break;
+
+        case Action::REDUCE:
+          // A new edge only brings new paths to reductions that cross it
+          if (task.link == NONE) {
+            reduceFrom(task.node, action.rule_index);
+          } else if (grammar.recordOf(action.rule_index).length > 0) {
+            reduceFrom(task.node, action.rule_index, task.link);
+          }
+          break;
+
+        case Action::ACCEPT:
+          accepted = task.node;
+          break;
+
+        case Action::ERROR:
+          break;
+      }
+    }
+  }
+
+  void GLRParser::reduceFrom(uint32_t top, uint32_t rule,
+                             uint32_t first_link) {
+    const uint32_t length = grammar.recordOf(rule).length;
+    path.resize(length);
+
+    if (first_link == NONE) {
+      walk(top, length, rule);
+      return;
+    }
+    path[length - 1] = links[first_link].forest;
+    walk(links[first_link].below, length - 1, rule);
+  }
+
+  void GLRParser::walk(uint32_t node, uint32_t remaining, uint32_t rule) {
+    if (remaining == 0) {
+      reduce(node, rule);
+      return;
+    }
+
+    // Every path down the stack is a parse to reduce, the RHS is filled
+    // from its last symbol on. Edges added meanwhile are queued as tasks
+    // and never seen here.
+    for (uint32_t l = nodes[node].links; l != NONE; l = links[l].next) {
+      path[remaining - 1] = links[l].forest;
+      walk(links[l].below, remaining - 1, rule);
+    }
+  }
+
+  void GLRParser::reduce(uint32_t bottom, uint32_t rule) {
+    const SymbolId lhs = action_table.lhsOf(rule);
+    const ActionTable::State state =
+        action_table.gotoFrom(nodes[bottom].state, lhs);
+    if (state == ActionTable::NO_STATE) return;
+
+    // A parse already went from the bottom to this state over the same
+    // span, this one is another derivation of its symbol.
+    uint32_t node = nodeAt(state);
+    if (node != NONE) {
+      for (uint32_t l = nodes[node].links; l != NONE; l = links[l].next) {
+        if (links[l].below == bottom) {
+          addAlternative(links[l].forest, rule);
+          return;
+        }
+      }
+    }
+
+    const uint32_t symbol = symbolNode(lhs, nodes[bottom].position);
+    addAlternative(symbol, rule);
+
+    if (node == NONE) {
+      node = pushNode(state);
+      level.push_back(node);
+      link(node, bottom, symbol);
+      pending.push_back({node, NONE});
+    } else {
+      const uint32_t l = link(node, bottom, symbol);
+      if (nodes[node].done) pending.push_back({node, l});
+    }
+  }
+
+  void GLRParser::shift() {
+    // Every parse shifts the same token, it gets a single leaf
+    const uint32_t leaf = static_cast<uint32_t>(forest.nodes.size());
+    forest.nodes.push_back(
+        {*lookahead, position, position + 1, ParseForest::NONE});
+    forest.tokens.push_back(lookahead_token);
+
+    ++position;
+    level.clear();
+    symbols.clear();
+    for (const auto& [below, state] : shifts) {
+      uint32_t node = nodeAt(state);
+      if (node == NONE) {
+        node = pushNode(state);
+        level.push_back(node);
+        pending.push_back({node, NONE});
+      }
+      link(node, below, leaf);
+    }
+    shifts.clear();
+
+    lookahead = nextSymbol();
+  }
+
+  GLRParser::ForestResult GLRParser::accept(uint32_t top) {
+    // The accepting top sits right on the bottom of the stack, the edge
+    // in between carries the whole input.
+    for (uint32_t l = nodes[top].links; l != NONE; l = links[l].next) {
+      if (links[l].below == 0) {
+        forest.root = links[l].forest;
+        return &forest;
+      }
+    }
+    return ParserError::makeInternalError();
+  }
+
+  uint32_t GLRParser::pushNode(ActionTable::State state) {
+    nodes.push_back({state, position, NONE, false});
+    return static_cast<uint32_t>(nodes.size() - 1);
+  }
+
+  uint32_t GLRParser::link(uint32_t node, uint32_t below,
+                           uint32_t forest_node) {
+    links.push_back({below, forest_node, nodes[node].links});
+    nodes[node].links = static_cast<uint32_t>(links.size() - 1);
+    return nodes[node].links;
+  }
+
+  uint32_t GLRParser::nodeAt(ActionTable::State state) const {
+    // Levels hold a handful of nodes, a scan beats any index
+    for (uint32_t node : level) {
+      if (nodes[node].state == state) return node;
+    }
+    return NONE;
+  }
+
+  uint32_t GLRParser::symbolNode(SymbolId symbol, uint32_t start) {
+    for (uint32_t node : symbols) {
+      if (forest.nodes[node].symbol == symbol &&
+          forest.nodes[node].start == start) {
+        return node;
+      }
+    }
+
+    forest.nodes.push_back({symbol, start, position, ParseForest::NONE});
+    symbols.push_back(static_cast<uint32_t>(forest.nodes.size() - 1));
+    return symbols.back();
+  }
+
+  void GLRParser::addAlternative(uint32_t forest_node, uint32_t rule) {
+    // Parses that merged below the RHS walk the same path more than once
+    ParseForest::Node& node = forest.nodes[forest_node];
+    for (uint32_t alt = node.first; alt != ParseForest::NONE;
+         alt = forest.alternatives[alt].next) {
+      std::span<const uint32_t> children = forest.childrenOf(alt);
+      if (forest.alternatives[alt].rule == rule &&
+          std::equal(children.begin(), children.end(), path.begin(),
+                     path.end())) {
+        return;
+      }
+    }
+
+    forest.alternatives.push_back(
+        {rule, static_cast<uint32_t>(forest.children.size()),
+         static_cast<uint32_t>(path.size()), node.first});
+    forest.children.insert(forest.children.end(), path.begin(), path.end());
+    node.first = static_cast<uint32_t>(forest.alternatives.size() - 1);
+  }
+
+  GLRParser::SymbolResult GLRParser::nextSymbol() {
+    auto result = tokens.next();
+    if (!result) {
+      return ParserError::makeLexerError(result.error());
+    }
+
+    lookahead_token = *result;
+    SymbolId terminal = lookahead_token.terminal;
+    if (terminal == SymbolTable::NONE &&
+        Symbol::fromToken(lookahead_token).type == Symbol::Type::UNKNOWN) {
+      return ParserError::makeUnknownSymbolError();
+    }
+    return terminal;
+  }
+
+  ParserError GLRParser::syntaxError() const {
+    // What any of the parses that died here could have taken
+    BitSet seen_terminals(action_table.symbols.terminalCount());
+    BitSet seen_rules(grammar.size());
+    std::vector<Symbol> expected_symbols;
+    std::vector<std::vector<Symbol>> expected_rhs;
+
+    for (uint32_t node : level) {
+      const ActionTable::State state = nodes[node].state;
+      for (SymbolId terminal : action_table.expectedTerminals(state)) {
+        if (seen_terminals.test(terminal)) continue;
+        seen_terminals.set(terminal);
+        expected_symbols.push_back(action_table.symbols.symbolOf(terminal));
+      }
+      for (uint32_t rule : action_table.exampleRules(state)) {
+        if (seen_rules.test(rule)) continue;
+        seen_rules.set(rule);
+        std::span<const Symbol> rhs = grammar.rhsOf(rule);
+        expected_rhs.emplace_back(rhs.begin(), rhs.end());
+      }
+    }
+
+    return ParserError::makeUnexSymbolError(
+               Symbol::fromToken(lookahead_token), tokens.state(),
+               std::move(expected_symbols), std::move(expected_rhs))
+        .error();
+  }
+
+  Parser::ParserResult GLRParser::buildProgram(const Disambiguator& choose) {
+    if (forest.root == ParseForest::NONE) {
+      return ParserError::makeInternalError();
+    }
+
+    auto pick = [&](uint32_t node) {
+      if (forest.isToken(node)) return ParseForest::NONE;
+      const uint32_t first = forest.nodes[node].first;
+      return choose && forest.alternatives[first].next != ParseForest::NONE
+                 ? choose(forest, node)
+                 : first;
+    };
+
+    // Post-order over the chosen tree, every node is built right after
+    // its children so handlers see their RHS like the LR parser hands it.
+    struct Frame {
+      uint32_t node;
+      uint32_t alternative;
+      uint32_t child;
+    };
+
+    // The nodes made from the stack are done, the handlers build the rest
+    // next to them
+    std::vector<Index> built(forest.nodes.size(), NO_INDEX);
+    std::copy(prebuilt.begin(), prebuilt.end(), built.begin());
+    std::vector<Frame> frames = {{forest.root, pick(forest.root), 0}};
+    std::vector<ASTSymbolState> rhs;
+
+    while (!frames.empty()) {
+      const Frame frame = frames.back();
+      const ParseForest::Node& node = forest.nodes[frame.node];
+
+      if (frame.node < prebuilt.size()) {
+        frames.pop_back();
+        continue;
+      }
+      if (forest.isToken(frame.node)) {
+        built[frame.node] = reductions::tokenLeaf(
+            program.storage, forest.tokenAt(node.start), tokens.source());
+        frames.pop_back();
+        continue;
+      }
+
+      std::span<const uint32_t> children =
+          forest.childrenOf(frame.alternative);
+      if (frame.child < children.size()) {
+        ++frames.back().child;
+        const uint32_t child = children[frame.child];
+        frames.push_back({child, pick(child), 0});
+        continue;
+      }
+
+      rhs.clear();
+      for (uint32_t child : children) {
+        const ParseForest::Node& child_node = forest.nodes[child];
+        rhs.push_back({action_table.symbols.symbolOf(child_node.symbol), 0,
+                       built[child], child_node.start});
+      }
+
+      const Grammar::Record& r =
+          grammar.recordOf(forest.alternatives[frame.alternative].rule);
+      built[frame.node] = r.handler ? r.handler(program.storage, rhs)
+                          : rhs.empty() ? NO_INDEX
+                                        : rhs.front().node;
+      frames.pop_back();
+    }
+
+    program.root = built[forest.root];
+    return std::move(program);
+  }
+}  // namespace compiler
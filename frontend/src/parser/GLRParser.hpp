@@ -0,0 +1,173 @@
+#pragma once
+
+#include <expected>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "ActionTable.hpp"
+#include "Grammar.hpp"
+#include "ParseForest.hpp"
+#include "ParseStack.hpp"
+#include "Parser.hpp"
+#include "ParserError.hpp"
+#include "tokens/TokenStream.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief A generalized LR parser for grammars with real ambiguities.
+   *
+   *        It runs on the same tables as Parser, but wherever a cell of the
+   *        table allows more than one action it takes all of them. The
+   *        stacks of the parses it follows share their common parts in a
+   *        graph-structured stack, and the trees they build share their
+   *        common parts in a ParseForest. Parses that hit an error die,
+   *        the ones that reach the end of the input meet in the forest as
+   *        alternatives of the nodes where they differ.
+   *
+   *        Until the first conflict cell there is a single parse, which
+   *        runs on a ParseStack and reduces with the handlers right away,
+   *        like Parser does. Unambiguous input thus costs about as much as
+   *        with Parser. Only a conflict turns the stack into the graph,
+   *        every entry into a forest node whose AST is already built.
+   *
+   *        There is no error recovery, the first syntax error is returned.
+   */
+  class GLRParser final {
+  public:
+    using SymbolResult = std::expected<SymbolId, ParserError>;
+    using ForestResult = std::expected<const ParseForest*, ParserError>;
+
+    /**
+     * @brief Picks which alternative of an ambiguous forest node goes into
+     *        the AST, returning its index in `forest.alternatives`.
+     *
+     */
+    using Disambiguator =
+        std::function<uint32_t(const ParseForest& forest, uint32_t node)>;
+
+  public:
+    /**
+     * @brief Constructs a new GLRParser object on the cached table of the
+     *        grammar that keeps its unit rules.
+     *
+     * @param tokens   A stream of tokens to be parsed.
+     * @param grammar  A list of production rules representing the grammar.
+     */
+    explicit GLRParser(TokenStream& tokens, const Grammar& grammar) noexcept;
+
+    /**
+     * @brief Constructs a new GLRParser object that drives a given table.
+     *
+     * @param tokens   A stream of tokens to be parsed.
+     * @param grammar  A list of production rules representing the grammar.
+     * @param table    Parse table built for an equal grammar without
+     *                 skipping unit rules, it must outlive the parser.
+     */
+    explicit GLRParser(TokenStream& tokens, const Grammar& grammar,
+                       const ActionTable& table) noexcept;
+
+    /**
+     * @brief Parses the token stream into a forest of every derivation.
+     *        The forest stays valid until the next parse.
+     *
+     * @return ForestResult
+     */
+    ForestResult parse();
+
+    /**
+     * @brief Runs the reduction handlers over one tree of the last forest
+     *        and returns the program they build. Ambiguous nodes are asked
+     *        to `choose`, without it their first alternative is taken.
+     *        Nodes the parse built before it forked are taken as they are.
+     *        The program is moved out, so it is built once per parse.
+     *
+     * @param choose
+     * @return Parser::ParserResult
+     */
+    Parser::ParserResult buildProgram(const Disambiguator& choose = {});
+
+    /**
+     * @brief Returns how many times the last parse took every action of a
+     *        conflict cell.
+     *
+     * @return size_t
+     */
+    size_t forkCount() const { return forks; }
+
+  private:
+    static constexpr uint32_t NONE = static_cast<uint32_t>(-1);
+
+    // A stack top, shared by every parse in `state` at `position`
+    struct Node {
+      ActionTable::State state;
+      uint32_t position;
+      uint32_t links;  // First edge down the stack
+      bool done;       // Its actions on the lookahead were taken
+    };
+
+    // An edge from a node to the one below it, labelled with the forest
+    // node of the symbol in between
+    struct Link {
+      uint32_t below;
+      uint32_t forest;
+      uint32_t next;
+    };
+
+    // A node whose actions are still to be taken. With a link, only the
+    // reductions through that new edge are left.
+    struct Task {
+      uint32_t node;
+      uint32_t link;
+    };
+
+  private:
+    const Grammar& grammar;
+    TokenStream& tokens;
+    const ActionTable& action_table;
+    ParseForest forest;
+
+    // The single parse before the input forks and the AST it built. The
+    // forest nodes made from its entries come first, node N stands for the
+    // AST node prebuilt[N].
+    ParseStack stack;
+    ASTProgram program;
+    std::vector<Index> prebuilt;
+
+    // Graph-structured stack. `level` holds the nodes at the current
+    // position and `symbols` the forest nodes that end there.
+    std::vector<Node> nodes;
+    std::vector<Link> links;
+    std::vector<uint32_t> level;
+    std::vector<uint32_t> symbols;
+    std::vector<Task> pending;
+    std::vector<std::pair<uint32_t, ActionTable::State>> shifts;
+    std::vector<uint32_t> path;  // RHS nodes of the reduction being walked
+
+    SymbolResult lookahead;
+    Token lookahead_token;
+    uint32_t position;
+    size_t forks;
+
+  private:
+    ForestResult parseForked();
+    void forkStack();
+
+    void takeActions(const Task& task, SymbolId terminal, uint32_t& accepted);
+    void reduceFrom(uint32_t top, uint32_t rule, uint32_t first_link = NONE);
+    void walk(uint32_t node, uint32_t remaining, uint32_t rule);
+    void reduce(uint32_t bottom, uint32_t rule);
+    void shift();
+    ForestResult accept(uint32_t top);
+
+    uint32_t pushNode(ActionTable::State state);
+    uint32_t link(uint32_t node, uint32_t below, uint32_t forest_node);
+    uint32_t nodeAt(ActionTable::State state) const;
+    uint32_t symbolNode(SymbolId symbol, uint32_t start);
+    void addAlternative(uint32_t forest_node, uint32_t rule);
+
+    SymbolResult nextSymbol();
+    ParserError syntaxError() const;
+  };
+}  // namespace compiler
@@ -0,0 +1,30 @@
+#include "Grammar.hpp"
+
+#include <algorithm>
+
+namespace compiler {
+
+  Grammar::Grammar() noexcept : pool(), records() {}
+
+  void Grammar::add(NonTerminal lhs, std::span<const Symbol> rhs,
+                    ReductionHandler handler) {
+    records.push_back({static_cast<uint32_t>(pool.size()),
+                       static_cast<uint16_t>(rhs.size()), lhs, handler});
+    pool.insert(pool.end(), rhs.begin(), rhs.end());
+  }
+
+  void Grammar::reserve(size_t rules, size_t symbols) {
+    records.reserve(rules);
+    pool.reserve(symbols);
+  }
+
+  bool Grammar::operator==(const Grammar& other) const {
+    return pool == other.pool &&
+           std::equal(records.begin(), records.end(), other.records.begin(),
+                      other.records.end(),
+                      [](const Record& a, const Record& b) {
+                        return a.lhs == b.lhs && a.length == b.length &&
+                               !a.handler == !b.handler;
+                      });
+  }
+}  // namespace compiler
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+#include "Hashing.hpp"
+#include "Symbols.hpp"
+#include "ast/StorageAST.hpp"
+
+namespace compiler {
+
+  struct ASTSymbolState;
+
+  /**
+   * @brief Semantic action of a rule.
+   *
+   *        Called on every reduction of the rule with the stack entries of
+   *        its RHS, in grammar order. It appends the nodes it builds to the
+   *        storage and returns the index of the node that stands for the
+   *        reduced LHS.
+   */
+  using ReductionHandler = Index (*)(ASTStorage& storage,
+                                     std::span<const ASTSymbolState> rhs);
+
+  /**
+   * @brief Represents a single production rule in a context-free grammar.
+   *
+   *        Each rule has a left-hand side (a non-terminal) and a right-hand
+   *        side, which is a sequence of symbols (terminals or non-terminals).
+   *        Rules without a handler pass the node of their first RHS symbol
+   *        through unchanged.
+   *
+   *        A Rule is a view into the Grammar that owns it, it stays valid
+   *        until more rules are added to that grammar.
+   */
+  struct Rule {
+    NonTerminal lhs;
+    std::span<const Symbol> rhs;
+    ReductionHandler handler = nullptr;
+  };
+
+  /**
+   * @brief A collection of grammar rules representing a full grammar.
+   *
+   *        Every RHS lives in one contiguous symbol pool and each rule is a
+   *        fixed-size record holding where its RHS starts, its length and
+   *        its LHS. Adding a rule only appends, the index of rules by LHS is
+   *        built by ActionTable in one counting-sort pass over the records.
+   */
+  class Grammar final {
+  public:
+    /**
+     * @brief Where the RHS of a rule lives in the symbol pool, and what it
+     *        reduces to.
+     *
+     */
+    struct Record {
+      uint32_t offset;
+      uint16_t length;
+      NonTerminal lhs;
+      ReductionHandler handler;
+    };
+
+  public:
+    explicit Grammar() noexcept;
+
+    /**
+     * @brief Appends a rule at the end of the grammar. Rule 0 is the
+     *        augmented start rule.
+     *
+     * @param lhs
+     * @param rhs
+     * @param handler semantic action, nullptr to pass the first node through
+     */
+    void add(NonTerminal lhs, std::span<const Symbol> rhs,
+             ReductionHandler handler = nullptr);
+
+    void add(NonTerminal lhs, std::initializer_list<Symbol> rhs,
+             ReductionHandler handler = nullptr) {
+      add(lhs, std::span<const Symbol>(rhs.begin(), rhs.size()), handler);
+    }
+
+    void add(const Rule& rule) { add(rule.lhs, rule.rhs, rule.handler); }
+
+    /**
+     * @brief Reserves room for a number of rules and RHS symbols.
+     *
+     * @param rules
+     * @param symbols
+     */
+    void reserve(size_t rules, size_t symbols);
+
+    /**
+     * @brief Returns a view of a rule.
+     *
+     * @param rule_index
+     * @return Rule
+     */
+    Rule operator[](size_t rule_index) const {
+      const Record& record = records[rule_index];
+      return {record.lhs, rhsOf(rule_index), record.handler};
+    }
+
+    std::span<const Symbol> rhsOf(size_t rule_index) const {
+      const Record& record = records[rule_index];
+      return {pool.data() + record.offset, record.length};
+    }
+
+    const Record& recordOf(size_t rule_index) const {
+      return records[rule_index];
+    }
+
+    /**
+     * @brief Returns the RHS of every rule back to back, rule 0 first.
+     *
+     * @return std::span<const Symbol>
+     */
+    std::span<const Symbol> symbols() const { return pool; }
+
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+
+    /**
+     * @brief Handlers do not change the language, so grammars that only
+     *        differ in them are equal and share one parse table. Whether a
+     *        rule has a handler at all does count, the tables skip unit
+     *        rules that have none.
+     *
+     * @param other
+     * @return true if both describe the same rules in the same order
+     */
+    bool operator==(const Grammar& other) const;
+
+  private:
+    std::vector<Symbol> pool;
+    std::vector<Record> records;
+  };
+
+  /**
+   * @brief Content hash of a whole grammar.
+   *
+   *        Two grammars with the same rules in the same order always hash to
+   *        the same value, regardless of where they live in memory. This is
+   *        what the parse table cache uses as its key.
+   */
+  struct GrammarHash {
+    std::size_t operator()(const Grammar& grammar) const {
+      StreamHasher hasher;
+      for (size_t i = 0; i < grammar.size(); ++i) {
+        const Grammar::Record& record = grammar.recordOf(i);
+        hasher.add((static_cast<uint64_t>(record.lhs) << 32) | record.length);
+      }
+      for (const Symbol& sym : grammar.symbols()) {
+        hasher.add((static_cast<uint64_t>(sym.type) << 8) | sym.comparison);
+      }
+      return static_cast<std::size_t>(hasher.finish());
+    }
+  };
+}  // namespace compiler
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+  #include <intrin.h>
+#endif
+
+namespace compiler {
+
+  /**
+   * @brief Streaming 64-bit hash in the style of wyhash.
+   *
+   *        Every word is folded into the state with a full 64x64->128 bit
+   *        multiply, so the result depends on the order of the words and a
+   *        single flipped bit spreads across the whole value. This is what
+   *        the table builder uses for item sets and grammars, where the old
+   *        XOR combinations made permuted inputs collide.
+   */
+  class StreamHasher final {
+  public:
+    explicit StreamHasher(uint64_t seed = 0) noexcept
+        : state(seed ^ mum(seed ^ SECRET[0], SECRET[1])), count(0) {}
+
+    /**
+     * @brief Folds a new word into the hash.
+     *
+     * @param word
+     */
+    void add(uint64_t word) noexcept {
+      state = mum(word ^ SECRET[1], state ^ SECRET[2]);
+      ++count;
+    }
+
+    /**
+     * @brief Returns the hash of every word added so far.
+     *
+     * @return uint64_t
+     */
+    uint64_t finish() const noexcept {
+      return mum(state ^ SECRET[3], count ^ SECRET[1]);
+    }
+
+  private:
+    static constexpr uint64_t SECRET[4] = {
+        0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+        0x589965cc75374cc3ull};
+
+    static uint64_t mum(uint64_t a, uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+      __uint128_t r = static_cast<__uint128_t>(a) * b;
+      return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+      uint64_t hi;
+      uint64_t lo = _umul128(a, b, &hi);
+      return lo ^ hi;
+#else
+      uint64_t ha = a >> 32, hb = b >> 32;
+      uint64_t la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+      uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+      uint64_t t = rl + (rm0 << 32);
+      uint64_t c = t < rl;
+      uint64_t lo = t + (rm1 << 32);
+      c += lo < t;
+      uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+      return lo ^ hi;
+#endif
+    }
+
+  private:
+    uint64_t state;
+    uint64_t count;
+  };
+}  // namespace compiler
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "SymbolTable.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief
+   *
+   */
+  struct Action {
+    enum Type { SHIFT, REDUCE, ACCEPT, ERROR } type;
+    union {
+      uint32_t rule_index;
+      uint32_t next_state;
+    };
+
+    /**
+     * @brief Prepares a reduce action
+     *
+     * @param rule_index
+     * @return Action
+     */
+    static constexpr Action reduce(uint32_t rule_index) {
+      return Action{.type = REDUCE, .rule_index = rule_index};
+    }
+
+    /**
+     * @brief Prepares a shift action
+     *
+     * @param next_state
+     * @return Action
+     */
+    static constexpr Action shift(uint32_t next_state) {
+      return Action{.type = SHIFT, .next_state = next_state};
+    }
+
+    /**
+     * @brief Prepares an accept action
+     *
+     * @return Action
+     */
+    static constexpr Action accept() { return Action{.type = ACCEPT}; }
+
+    /**
+     * @brief Prepares an error action
+     *
+     * @return Action
+     */
+    static constexpr Action error() { return Action{.type = ERROR}; }
+
+    bool operator==(const Action& other) const {
+      return type == other.type && rule_index == other.rule_index;
+    }
+  };
+
+  // The LR(0) construction shared by ActionTable, which runs it when a
+  // grammar is first used, and StaticTable, which runs it in the compiler.
+  // Everything here is constexpr and only works on symbol ids, how each of
+  // them numbers symbols and finds states is up to them.
+  namespace lr0 {
+    static constexpr uint32_t NO_GOTO = static_cast<uint32_t>(-1);
+
+    /**
+     * @brief An LR(0) item, a rule with a dot somewhere in its RHS.
+     *
+     *        Items are packed into 32 bits so item sets can be kept as
+     *        sorted arrays of plain integers.
+     */
+    struct Item {
+      uint16_t rule_index;
+      uint16_t dot_position;
+
+      constexpr uint32_t packed() const {
+        return (static_cast<uint32_t>(rule_index) << 16) | dot_position;
+      }
+
+      bool operator==(const Item& other) const = default;
+    };
+
+    /**
+     * @brief A set of items, always sorted by Item::packed() and free of
+     *        duplicates.
+     *
+     */
+    using ItemSet = std::vector<Item>;
+
+    /**
+     * @brief The rules of a grammar in symbol ids. The LHS of rule R is
+     *        lhs[R] and its RHS is rhs[offsets[R] .. offsets[R + 1]).
+     *
+     */
+    struct Rules {
+      std::span<const SymbolId> lhs;
+      std::span<const uint32_t> offsets;
+      std::span<const SymbolId> rhs;
+      size_t terminal_count;
+
+      constexpr size_t size() const { return lhs.size(); }
+
+      constexpr bool isTerminal(SymbolId id) const {
+        return id < terminal_count;
+      }
+
+      constexpr SymbolId symbolAfterDot(const Item& item) const {
+        const uint32_t position = offsets[item.rule_index] + item.dot_position;
+        return position < offsets[item.rule_index + 1] ? rhs[position]
+                                                       : SymbolTable::NONE;
+      }
+    };
+
+    /**
+     * @brief Groups the rules by their LHS with a counting sort. The rules
+     *        of non-terminal N are grouped[offsets[N] .. offsets[N + 1]),
+     *        where N is counted from the first non-terminal id, in grammar
+     *        order.
+     *
+     * @param rules
+     * @param nonterminal_count
+     * @param offsets
+     * @param grouped
+     */
+    constexpr void indexByLhs(const Rules& rules, size_t nonterminal_count,
+                              std::vector<uint32_t>& offsets,
+                              std::vector<uint32_t>& grouped) {
+      offsets.assign(nonterminal_count + 1, 0);
+      for (SymbolId lhs : rules.lhs) {
+        ++offsets[lhs - rules.terminal_count + 1];
+      }
+      for (size_t nt = 0; nt < nonterminal_count; ++nt) {
+        offsets[nt + 1] += offsets[nt];
+      }
+
+      grouped.resize(rules.size());
+      std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+      for (size_t rule = 0; rule < rules.size(); ++rule) {
+        grouped[next[rules.lhs[rule] - rules.terminal_count]++] =
+            static_cast<uint32_t>(rule);
+      }
+    }
+
+    /**
+     * @brief Brings a closure into the canonical sorted form. A kernel item
+     *        may also be an initial item that the closure added again.
+     *
+     * @param items
+     */
+    constexpr void canonicalize(ItemSet& items) {
+      std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.packed() < b.packed();
+      });
+      items.erase(std::unique(items.begin(), items.end()), items.end());
+    }
+
+    /**
+     * @brief Advances the dot of every item over the symbol that follows it.
+     *        Items are sorted, so every successor kernel comes out sorted as
+     *        well, and successors keep the order in which their symbols
+     *        first appear. That order is what numbers the states.
+     *
+     * @param rules
+     * @param items
+     * @param successors  appended to, one kernel per symbol
+     */
+    constexpr void successorsOf(
+        const Rules& rules, const ItemSet& items,
+        std::vector<std::pair<SymbolId, ItemSet>>& successors) {
+      for (const Item& item : items) {
+        SymbolId sym = rules.symbolAfterDot(item);
+        if (sym == SymbolTable::NONE) continue;
+
+        auto it = std::find_if(
+            successors.begin(), successors.end(),
+            [sym](const auto& successor) { return successor.first == sym; });
+        if (it == successors.end()) {
+          successors.push_back({sym, {}});
+          it = successors.end() - 1;
+        }
+
+        it->second.push_back(
+            Item{item.rule_index,
+                 static_cast<uint16_t>(item.dot_position + 1)});
+      }
+    }
+
+    /**
+     * @brief Offers an action to a cell. Conflicts are resolved the same way
+     *        yacc does: a shift (or accept) wins over a reduce, and between
+     *        two reduces the rule that appears first in the grammar wins.
+     *
+     * @param current
+     * @param action
+     */
+    constexpr void setAction(Action& current, Action action) {
+      if (current.type == Action::ERROR) {
+        current = action;
+      } else if (current.type == Action::REDUCE &&
+                 action.type != Action::REDUCE) {
+        current = action;
+      } else if (current.type == Action::REDUCE &&
+                 action.type == Action::REDUCE &&
+                 action.rule_index < current.rule_index) {
+        current = action;
+      }
+    }
+
+    /**
+     * @brief Fills the action and goto rows of a state, which start out as
+     *        errors and NO_GOTO.
+     *
+     * @param rules
+     * @param items        closure of the state
+     * @param transitions  (symbol id, target state) pairs of the state
+     * @param actions      one cell per terminal
+     * @param gotos        one cell per non-terminal
+     */
+    template <typename Transitions>
+    constexpr void fillRow(const Rules& rules, const ItemSet& items,
+                           const Transitions& transitions, Action* actions,
+                           uint32_t* gotos) {
+      // Shifts and gotos come straight from the state's transitions.
+      for (const auto& [sym, target] : transitions) {
+        if (rules.isTerminal(sym)) {
+          setAction(actions[sym],
+                    Action::shift(static_cast<uint32_t>(target)));
+        } else {
+          gotos[sym - rules.terminal_count] = static_cast<uint32_t>(target);
+        }
+      }
+
+      // Dot at end → reduce or accept
+      for (const Item& item : items) {
+        if (rules.symbolAfterDot(item) != SymbolTable::NONE) continue;
+
+        if (item.rule_index == 0) {
+          // Accept on end-of-input symbol
+          setAction(actions[SymbolTable::ENDOF], Action::accept());
+        } else {
+          // Reduce by this rule for all terminals
+          for (size_t t = 0; t < rules.terminal_count; ++t) {
+            setAction(actions[t], Action::reduce(item.rule_index));
+          }
+        }
+      }
+    }
+
+    /**
+     * @brief Lists what every state of a finished table expects: the
+     *        terminals with a non-error action, and the rules whose RHS
+     *        starts with one of them, each rule once per state. Those of
+     *        state S live in [offsets[S], offsets[S + 1]) of their arrays.
+     *
+     * @param rules
+     * @param actions             row-major, one row per state
+     * @param error_id            the `error` pseudo-terminal, never expected
+     * @param expected_offsets
+     * @param expected_terminals
+     * @param example_offsets
+     * @param example_rules
+     */
+    constexpr void diagnose(const Rules& rules,
+                            std::span<const Action> actions,
+                            SymbolId error_id,
+                            std::vector<uint32_t>& expected_offsets,
+                            std::vector<SymbolId>& expected_terminals,
+                            std::vector<uint32_t>& example_offsets,
+                            std::vector<uint32_t>& example_rules) {
+      const size_t terminal_count = rules.terminal_count;
+
+      // Rules grouped by the terminal their RHS starts with.
+      std::vector<uint32_t> first_offsets(terminal_count + 1, 0);
+      for (uint32_t rule = 0; rule < rules.size(); ++rule) {
+        const SymbolId first =
+            rules.symbolAfterDot({static_cast<uint16_t>(rule), 0});
+        if (first != SymbolTable::NONE && rules.isTerminal(first)) {
+          first_offsets[first + 1]++;
+        }
+      }
+      for (size_t t = 0; t < terminal_count; ++t) {
+        first_offsets[t + 1] += first_offsets[t];
+      }
+
+      std::vector<uint32_t> first_rules(first_offsets.back());
+      std::vector<uint32_t> cursor(first_offsets.begin(),
+                                   first_offsets.end() - 1);
+      for (uint32_t rule = 0; rule < rules.size(); ++rule) {
+        const SymbolId first =
+            rules.symbolAfterDot({static_cast<uint16_t>(rule), 0});
+        if (first != SymbolTable::NONE && rules.isTerminal(first)) {
+          first_rules[cursor[first]++] = rule;
+        }
+      }
+
+      // Walk every row once, keeping its valid terminals and the rules that
+      // start with them.
+      expected_offsets.assign(1, 0);
+      example_offsets.assign(1, 0);
+      std::vector<uint8_t> seen(rules.size(), false);
+
+      for (size_t row = 0; row < actions.size(); row += terminal_count) {
+        for (SymbolId t = 0; t < terminal_count; ++t) {
+          // The error pseudo-terminal is never something the user can type
+          if (actions[row + t].type == Action::ERROR || t == error_id) {
+            continue;
+          }
+
+          expected_terminals.push_back(t);
+          for (uint32_t i = first_offsets[t]; i < first_offsets[t + 1]; ++i) {
+            if (seen[first_rules[i]]) continue;
+            seen[first_rules[i]] = true;
+            example_rules.push_back(first_rules[i]);
+          }
+        }
+
+        for (uint32_t i = example_offsets.back(); i < example_rules.size();
+             ++i) {
+          seen[example_rules[i]] = false;
+        }
+        expected_offsets.push_back(
+            static_cast<uint32_t>(expected_terminals.size()));
+        example_offsets.push_back(static_cast<uint32_t>(example_rules.size()));
+      }
+    }
+  }  // namespace lr0
+}  // namespace compiler
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "SymbolTable.hpp"
+#include "tokens/Tokens.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief Shared packed parse forest, every derivation a GLR parse found
+   *        with the parts they have in common stored once.
+   *
+   *        A node stands for a symbol spanning the tokens [start, end) of
+   *        the input. Tokens are the leaves. The derivations of a
+   *        non-terminal node are its alternatives, each a rule and the nodes
+   *        of its RHS. A node with more than one alternative is an
+   *        ambiguity, left to a later pass that knows which reading is
+   *        meant, e.g. whether a name is a type.
+   *
+   *        A parse that runs deterministically for a while builds its AST
+   *        right away, what it built before it forked is left as leaves
+   *        spanning whole subtrees.
+   */
+  struct ParseForest {
+    static constexpr uint32_t NONE = static_cast<uint32_t>(-1);
+
+    struct Node {
+      SymbolId symbol;
+      uint32_t start;
+      uint32_t end;
+      uint32_t first;  // First alternative, NONE for leaves
+    };
+
+    struct Alternative {
+      uint32_t rule;
+      uint32_t children;  // Offset of the RHS nodes in `children`
+      uint32_t count;
+      uint32_t next;  // Next alternative of the same node
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Alternative> alternatives;
+    std::vector<uint32_t> children;
+    // The token at every position from `first_token` on. The ones before
+    // only live in the leaves built before the parse forked.
+    std::vector<Token> tokens;
+    uint32_t first_token = 0;
+    uint32_t root = NONE;
+
+    bool isToken(uint32_t node) const { return nodes[node].first == NONE; }
+
+    /**
+     * @brief Returns the token at a position of the input, which must not
+     *        come before `first_token`.
+     *
+     * @param position
+     * @return const Token&
+     */
+    const Token& tokenAt(uint32_t position) const {
+      return tokens[position - first_token];
+    }
+
+    /**
+     * @brief Returns the RHS nodes of an alternative, in grammar order.
+     *
+     * @param alternative
+     * @return std::span<const uint32_t>
+     */
+    std::span<const uint32_t> childrenOf(uint32_t alternative) const {
+      const Alternative& alt = alternatives[alternative];
+      return {children.data() + alt.children, alt.count};
+    }
+
+    /**
+     * @brief Returns how many derivations a node has, 0 for tokens.
+     *
+     * @param node
+     * @return size_t
+     */
+    size_t alternativeCount(uint32_t node) const {
+      size_t count = 0;
+      for (uint32_t alt = nodes[node].first; alt != NONE;
+           alt = alternatives[alt].next) {
+        ++count;
+      }
+      return count;
+    }
+
+    /**
+     * @brief Returns the number of ambiguous nodes.
+     *
+     * @return size_t
+     */
+    size_t ambiguityCount() const {
+      size_t count = 0;
+      for (const Node& node : nodes) {
+        count += node.first != NONE && alternatives[node.first].next != NONE;
+      }
+      return count;
+    }
+
+    /**
+     * @brief Removes every node but keeps the memory for reuse.
+     *
+     */
+    void clear() {
+      nodes.clear();
+      alternatives.clear();
+      children.clear();
+      tokens.clear();
+      first_token = 0;
+      root = NONE;
+    }
+  };
+}  // namespace compiler
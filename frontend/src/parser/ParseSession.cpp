@@ -0,0 +1,14 @@
+#include "ParseSession.hpp"
+
+namespace compiler {
+
+  ParseSession::ParseSession(const Grammar& grammar,
+                             uint8_t buffer_size) noexcept
+      : lexer("", ""), tokens(lexer, buffer_size), parser(tokens, grammar) {}
+
+  Parser::ProgramResult ParseSession::parse(std::string_view filename,
+                                            std::string_view source) {
+    parser.reset(filename, source);
+    return parser.parseInPlace();
+  }
+}  // namespace compiler
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string_view>
+
+#include "Grammar.hpp"
+#include "Parser.hpp"
+#include "lexer/Lexer.hpp"
+#include "tokens/TokenStream.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief Parses many sources, one after the other, with one grammar.
+   *
+   *        The session owns the lexer, the token stream and the parser, and
+   *        keeps them between sources: the token ring, the parse stack, the
+   *        AST storage and the shared parse table are all set up once.
+   *        After the first few sources have grown them to size, parsing the
+   *        next one does not allocate.
+   */
+  class ParseSession final {
+  public:
+    /**
+     * @brief Constructs a new ParseSession object.
+     *
+     * @param grammar     Must outlive the session.
+     * @param buffer_size Tokens read ahead by the token stream.
+     */
+    explicit ParseSession(const Grammar& grammar,
+                          uint8_t buffer_size = 16) noexcept;
+
+    ParseSession(const ParseSession&) = delete;
+    ParseSession& operator=(const ParseSession&) = delete;
+
+    /**
+     * @brief Parses a source. The program returned stays valid until the
+     *        next call, and so must the source it was parsed from.
+     *
+     * @param filename
+     * @param source
+     * @return Parser::ProgramResult
+     */
+    Parser::ProgramResult parse(std::string_view filename,
+                                std::string_view source);
+
+  private:
+    Lexer lexer;
+    TokenStream tokens;
+    Parser parser;
+  };
+}  // namespace compiler
@@ -1,101 +1,126 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 #include "ActionTable.hpp"
 #include "Symbols.hpp"
+#include "ast/StorageAST.hpp"
 
 namespace compiler {
 
+  /**
+   * @brief An entry of the parse stack: the symbol that was shifted or
+   *        reduced, the state it led to, the AST node built for it and the
+   *        index of the first token it covers.
+   *
+   */
   struct ASTSymbolState {
     Symbol symbol;
     ActionTable::State state;
+    Index node = NO_INDEX;
+    uint32_t token = 0;
   };
 
+  /**
+   * @brief Stack of symbol-states used by the LR parser.
+   *
+   *        Entries live in a single contiguous buffer that grows
+   *        geometrically and is never shrunk while the stack is alive. Deep
+   *        or oscillating nesting therefore never hits the allocator once the
+   *        buffer is large enough, and the top entries of a reduction can be
+   *        accessed at random.
+   */
   class ParseStack final {
   public:
-    struct Page;
-
-    struct Iterator {
-      Page* curr_page = nullptr;
-      int32_t top;
-
-      void next();
-      bool hasNext();
-
-      ASTSymbolState& operator*();
-      ASTSymbolState* operator->();
-    };
+    static constexpr uint32_t INITIAL_CAPACITY = 64;
 
   public:
     /**
-     * @brief Construct a new ParseStack object
+     * @brief Construct a new ParseStack object. No memory is reserved until
+     *        the first push.
      *
      */
     explicit ParseStack() noexcept;
     ~ParseStack() noexcept;
 
+    ParseStack(const ParseStack&) = delete;
+    ParseStack& operator=(const ParseStack&) = delete;
+
     /**
-     * @brief
+     * @brief Pushes a new entry on top of the stack.
      *
-     * @param node
+     * @param ast_state_symbol
      */
-    void push(ASTSymbolState&& ast_state_symbol);
+    void push(ASTSymbolState&& ast_state_symbol) {
+      if (stack_size == stack_capacity) {
+        // Grow when overflows
+        grow();
+      }
+      entries[stack_size++] = ast_state_symbol;
+    }
 
     /**
-     * @brief
+     * @brief Pops the top `stack_ptr` entries. Popping more entries than the
+     *        stack holds leaves it empty.
      *
+     * @param stack_ptr
      */
-    void pop(int32_t stack_ptr);
+    void pop(uint32_t stack_ptr) {
+      stack_size = stack_ptr < stack_size ? stack_size - stack_ptr : 0;
+    }
 
     /**
-     * @brief
+     * @brief Returns the entry on top of the stack.
      *
      * @return const ASTSymbolState&
      */
-    const ASTSymbolState& peekTop() const;
+    const ASTSymbolState& peekTop() const { return entries[stack_size - 1]; }
 
     /**
-     * @brief
+     * @brief Returns the top `stack_ptr` entries, the deepest one first. This
+     *        is the RHS of a reduction in grammar order.
      *
-     * @param top
+     * @param stack_ptr
+     * @return std::span<const ASTSymbolState>
      */
-    Iterator peekTop(int32_t stack_ptr);
+    std::span<const ASTSymbolState> peekTop(uint32_t stack_ptr) const {
+      return {entries + (stack_size - stack_ptr), stack_ptr};
+    }
 
     /**
-     * @brief
+     * @brief Returns the number of entries in the stack.
+     *
+     * @return size_t
+     */
+    size_t size() const { return stack_size; }
+
+    /**
+     * @brief Returns how many entries fit before the buffer has to grow.
      *
      * @return size_t
      */
-    size_t size() const;
+    size_t capacity() const { return stack_capacity; }
 
     /**
      * @brief
      *
      * @return true if empty false otherwise
      */
-    bool isEmpty() const;
+    bool isEmpty() const { return stack_size == 0; }
 
-  private:
     /**
-     * @brief
+     * @brief Removes every entry but keeps the buffer for reuse.
      *
      */
-    struct Page {
-      static constexpr uint8_t PAGE_SIZE = 64;
-      ASTSymbolState nodes[PAGE_SIZE]{};
-      Page* prev = nullptr;
-    };
+    void clear() { stack_size = 0; }
 
   private:
-    int32_t top_index;
-    uint32_t page_count;
+    ASTSymbolState* entries;
     uint32_t stack_size;
-    Page* head;
+    uint32_t stack_capacity;
 
   private:
-    void clear();
-    void addPage();
-    void removePage();
+    void grow();
   };
 }  // namespace compiler
@@ -1,22 +1,317 @@
 #include "Parser.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+#include "ast/Reductions.hpp"
 
 namespace compiler {
 
+  namespace {
+    // Tokens that end a construct, panic mode resumes right after them.
+    bool isSyncPoint(const Token& token) {
+      return token.type == TokenType::PUNCTUATOR &&
+             (token.value.punctuator == Punctuator::SEMI_COLON ||
+              token.value.punctuator == Punctuator::RBRACE);
+    }
+
+    bool isStringLiteral(TokenType type) {
+      return type == TokenType::STR8_LITERAL ||
+             type == TokenType::STR16_LITERAL;
+    }
+
+    // Moves a token that kept its text to where it lies after an edit
+    void shiftToken(Token& token, int64_t delta) {
+      if (token.type == TokenType::IDENTIFIER) {
+        token.value.identifier.start += delta;
+        token.value.identifier.end += delta;
+      } else if (isStringLiteral(token.type)) {
+        token.value.literal.string.start += delta;
+        token.value.literal.string.end += delta;
+      }
+    }
+
+    // Adds the time until it goes out of scope to `total`, if there is one
+    class ScopedTimer {
+    public:
+      explicit ScopedTimer(std::chrono::nanoseconds* total)
+          : total(total),
+            start(total ? std::chrono::steady_clock::now()
+                        : std::chrono::steady_clock::time_point()) {}
+
+      ~ScopedTimer() {
+        if (total) *total += std::chrono::steady_clock::now() - start;
+      }
+
+    private:
+      std::chrono::nanoseconds* total;
+      std::chrono::steady_clock::time_point start;
+    };
+
+    // Replaces items[from, to) by `with`
+    template <typename T>
+    void splice(std::vector<T>& items, size_t from, size_t to,
+                const std::vector<T>& with) {
+      items.erase(items.begin() + from, items.begin() + to);
+      items.insert(items.begin() + from, with.begin(), with.end());
+    }
+  }  // namespace
+
   Parser::Parser(TokenStream& tokens, const Grammar& grammar) noexcept
-      : tokens(tokens),
-        action_table(grammar),
-        grammar(grammar),
+      : Parser(tokens, grammar, TableCache::tableFor(grammar)) {
+    // The generated code numbers its states like the cached table does,
+    // any other table has to be driven by the loop.
+#ifdef FRONTEND_DIRECT_PARSER
+    direct_coded = hasDirectCode(grammar);
+#endif
+  }
+
+  Parser::Parser(TokenStream& tokens, const Grammar& grammar,
+                 const ActionTable& table) noexcept
+      : grammar(grammar),
+        tokens(tokens),
+        action_table(table),
         symbols(),
-        lookahead(Symbol::endOF()) {}
+        program(),
+        lookahead(SymbolTable::ENDOF),
+        lookahead_token(Token::endOF()),
+        recovering(0),
+        direct_coded(false),
+        log(),
+        replaying(false),
+        cursor(0),
+        clean_from(0),
+        stats(nullptr),
+        stack_capacity(0) {
+    // Tokens reach the parser already mapped to the terminals of its table
+    tokens.mapTerminals(action_table.symbols.terminalMap());
+  }
 
   Parser::ParserResult Parser::parse() {
-    // Prepare parse stack and first lookahead symbol
+    ParseStatus status = run();
+    if (!status) {
+      return std::unexpected(std::move(status.error()));
+    }
+    return std::move(program);
+  }
+
+  Parser::ProgramResult Parser::parseInPlace() {
+    ParseStatus status = run();
+    if (!status) {
+      return std::unexpected(std::move(status.error()));
+    }
+    return &program;
+  }
+
+  void Parser::reset(std::string_view filename, std::string_view source) {
+    tokens.reset(filename, source);
+  }
+
+  Parser::ProgramResult Parser::parseIncremental() {
+    // Lex the whole source up front, the parse reads the tokens from the log
+    log.tokens.clear();
+    log.spans.clear();
+    log.error.reset();
+    while (true) {
+      Lexer::LexerResult result = tokens.next();
+      if (!result) {
+        log.error = std::move(result.error());
+        break;
+      }
+      log.tokens.push_back(*result);
+      log.spans.push_back(tokens.span());
+      if (result->type == TokenType::ENDOF) break;
+    }
+
+    log.first_at.assign(log.tokens.size(), NO_SUBTREE);
+    log.subtrees.clear();
+    ProgramResult result = replay(/*keep_nodes=*/false);
+
+    // Once replaced subtrees outnumber the live ones a few times over, the
+    // next reparse starts from scratch to drop them and their nodes.
+    log.full_parse_at = 4 * log.subtrees.size() + 256;
+    return result;
+  }
+
+  Parser::ProgramResult Parser::reparse(std::string_view source,
+                                        const TextEdit& edit) {
+    if (log.tokens.empty() || log.error ||
+        log.subtrees.size() > log.full_parse_at) {
+      tokens.reset(tokens.filename(), source);
+      return parseIncremental();
+    }
+
+    std::vector<TokenStream::Span>& spans = log.spans;
+    const int64_t delta =
+        static_cast<int64_t>(edit.new_end) - static_cast<int64_t>(edit.old_end);
+
+    // The first token the edit touches. One that ends right where the edit
+    // starts may grow into it, so it is lexed again too.
+    const uint32_t first = std::min<size_t>(
+        std::lower_bound(spans.begin(), spans.end(), edit.start,
+                         [](const TokenStream::Span& span, uint32_t offset) {
+                           return span.end < offset;
+                         }) -
+            spans.begin(),
+        spans.size() - 1);
+
+    // Lex from the end of the token before until the new tokens line up
+    // with the old ones again. Past the edit the text is the old one
+    // shifted by `delta`, so a token that starts where an old one started
+    // is followed by the same tokens as that one.
+    tokens.reset(tokens.filename(), source,
+                 first > 0 ? spans[first - 1].end : 0);
+    log.relexed.clear();
+    log.relexed_spans.clear();
+
+    uint32_t resync = first;
+    while (true) {
+      Lexer::LexerResult result = tokens.next();
+      if (!result) {
+        // The log ends at the error, the next reparse starts over
+        log.error = std::move(result.error());
+        resync = spans.size();
+        break;
+      }
+
+      const TokenStream::Span span = tokens.span();
+      if (span.start >= edit.new_end) {
+        const int64_t old_start = span.start - delta;
+        while (resync < spans.size() && spans[resync].start < old_start) {
+          ++resync;
+        }
+        if (resync < spans.size() && spans[resync].start == old_start) break;
+      }
+      log.relexed.push_back(*result);
+      log.relexed_spans.push_back(span);
+    }
+
+    // Subtrees looking at a relexed token, even as their lookahead only,
+    // were built on text that is gone.
+    for (uint32_t i = 0; i < first; ++i) {
+      uint32_t* link = &log.first_at[i];
+      while (*link != NO_SUBTREE) {
+        Subtree& subtree = log.subtrees[*link];
+        if (i + subtree.length >= first) {
+          *link = subtree.next;
+        } else {
+          link = &subtree.next;
+        }
+      }
+    }
+
+    // The tokens after the resync point keep their subtrees and only move
+    for (size_t i = resync; i < log.tokens.size(); ++i) {
+      shiftToken(log.tokens[i], delta);
+      spans[i].start += delta;
+      spans[i].end += delta;
+    }
+    splice(log.tokens, first, resync, log.relexed);
+    splice(spans, first, resync, log.relexed_spans);
+    log.first_at.erase(log.first_at.begin() + first,
+                       log.first_at.begin() + resync);
+    log.first_at.insert(log.first_at.begin() + first, log.relexed.size(),
+                        NO_SUBTREE);
+
+    rebaseNodes(edit);
+    return replay(/*keep_nodes=*/true);
+  }
+
+  Parser::ProgramResult Parser::replay(bool keep_nodes) {
+    replaying = true;
+    ParseStatus status = run(keep_nodes);
+    replaying = false;
+
+    if (!status) {
+      return std::unexpected(std::move(status.error()));
+    }
+    return &program;
+  }
+
+  void Parser::rebaseNodes(const TextEdit& edit) {
+    // Nodes point into the source, the ones past the edit have to follow
+    // their text. Nodes inside of it are no longer reachable.
+    const int64_t delta =
+        static_cast<int64_t>(edit.new_end) - static_cast<int64_t>(edit.old_end);
+
+    for (IDAST& id : program.storage.ids) {
+      if (id.id.start < edit.old_end) continue;
+      id.id.start += delta;
+      id.id.end += delta;
+    }
+    for (LiteralAST& literal : program.storage.literals) {
+      if (!isStringLiteral(literal.type) ||
+          literal.literal.string.start < edit.old_end) {
+        continue;
+      }
+      literal.literal.string.start += delta;
+      literal.literal.string.end += delta;
+    }
+  }
+
+  bool Parser::reuseSubtree() {
+    const uint32_t at = cursor - 1;
+    const ActionTable::State state = symbols.peekTop().state;
+
+    // The first subtree in the list that fits is the largest one, every
+    // later reduction from the same state covers the earlier ones.
+    for (uint32_t i = log.first_at[at]; i != NO_SUBTREE;
+         i = log.subtrees[i].next) {
+      const Subtree& subtree = log.subtrees[i];
+      if (subtree.state != state) continue;
+
+      symbols.push({action_table.symbols.symbolOf(subtree.lhs),
+                    action_table.gotoFrom(state, subtree.lhs), subtree.node,
+                    at});
+      cursor = at + subtree.length;
+      lookahead = nextSymbol();
+      return true;
+    }
+    return false;
+  }
+
+  void Parser::recordSubtree(SymbolId lhs, ActionTable::State state,
+                             uint32_t begin, Index node) {
+    const uint32_t length = (cursor - 1) - begin;
+    if (length == 0 || begin < clean_from) return;
+
+    log.subtrees.push_back({lhs, state, length, node, log.first_at[begin]});
+    log.first_at[begin] = static_cast<uint32_t>(log.subtrees.size() - 1);
+  }
+
+  Parser::ParseStatus Parser::run(bool keep_nodes) {
+    ScopedTimer timer(stats ? &stats->total_time : nullptr);
+    if (stats) {
+      stats->prepare(grammar.size(), action_table.stateCount() *
+                                         action_table.symbols.terminalCount());
+      ++stats->parses;
+    }
+
+    // Prepare parse stack and first lookahead symbol. The nodes of the
+    // previous program go, the memory that held them stays.
+    cursor = 0;
+    clean_from = 0;
     this->lookahead = nextSymbol();
+    if (!keep_nodes) {
+      program.storage.clear();
+      program.storage.reserve(replaying ? log.tokens.size()
+                                        : tokens.source().size() /
+                                              BYTES_PER_TOKEN);
+    }
+    program.errors.clear();
+    program.root = NO_INDEX;
+    recovering = 0;
 
     // Set an initial symbol to start parsing
+    symbols.clear();
+    stack_capacity = symbols.capacity();
     symbols.push({Symbol::start(), 0});
+    if (stats) countStack();
+
+#ifdef FRONTEND_DIRECT_PARSER
+    if (direct_coded && !replaying && !stats) return parseDirect();
+#endif
 
     while (true) {
       // Validate that the symbol is not garbage.
@@ -24,109 +319,187 @@ namespace compiler {
         return std::unexpected(lookahead.error());
       }
 
+      // Shift what an earlier parse already built from here on
+      if (replaying && recovering == 0 && reuseSubtree()) continue;
+
       // Obtain action from the current state and symbol
       const auto& sym_st = symbols.peekTop();
-      Action action = action_table.actionFrom({sym_st.state, *lookahead});
+      Action action = action_table.actionFrom(sym_st.state, *lookahead);
+      if (stats) countAction(sym_st.state, *lookahead, action);
 
       switch (action.type) {
         case Action::SHIFT: {
-          // Shift the current symbol and push to the next state.
-          // Advance to the next symbol.
-          symbols.push({*lookahead, action.next_state});
+          // Shift the current symbol and push to the next state together
+          // with the leaf node of its token. Advance to the next symbol.
+          symbols.push({action_table.symbols.symbolOf(*lookahead),
+                        action.next_state, shiftNode(), cursor - 1});
           lookahead = nextSymbol();
+          if (recovering > 0 && --recovering == 0) clean_from = cursor - 1;
           break;
         }
 
         case Action::REDUCE: {
-          // Capture the rhs of the grammar rule to reduce
-          const Rule& r = grammar[action.rule_index];
+          // Capture the rhs of the grammar rule to reduce. The cached table
+          // may belong to an equal grammar with other handlers, so handlers
+          // always come from this parser's own grammar.
+          const Grammar::Record& r = grammar.recordOf(action.rule_index);
+          const SymbolId lhs = action_table.lhsOf(action.rule_index);
+          std::span<const ASTSymbolState> rhs = symbols.peekTop(r.length);
+          const uint32_t begin = rhs.empty() ? cursor - 1 : rhs.front().token;
 
-          // Build the AST and pick its index position from Program's AST.
+          // Build the AST of the rule from the nodes of its rhs and pick its
+          // index position from Program's AST.
+          Index node = r.handler ? r.handler(program.storage, rhs)
+                       : rhs.empty() ? NO_INDEX
+                                     : rhs.front().node;
 
           // Pop from stack the rhs symbols that cause a reduction
-          symbols.pop(r.rhs.size());
+          symbols.pop(r.length);
 
           // Peek the latest symbol-state and push the goto state from reduced
           // symbol expression.
           const auto& sym_st = symbols.peekTop();
-          Symbol sym{.type = Symbol::Type::NON_TERMINAL, .nonterminal = r.lhs};
-          symbols.push({sym, action_table.gotoFrom({sym_st.state, sym})});
+          if (replaying) recordSubtree(lhs, sym_st.state, begin, node);
+          symbols.push({action_table.symbols.symbolOf(lhs),
+                        action_table.gotoFrom(sym_st.state, lhs), node,
+                        begin});
           break;
         }
 
         case Action::ACCEPT: {
-          // If the stack has more than 2 elements (start and the final symbol)
-          // it means that the parsing process was not completed correctly, and
-          // it is a false accept that it was passed.
-          if (symbols.size() > 2) {
-            return ParserError::makeInternalError();
+          return accept();
+        }
+
+        case Action::ERROR: {
+          // Errors right after a recovery are usually caused by it, so they
+          // are only reported once enough tokens were shifted again.
+          if (recovering == 0) {
+            program.errors.push_back(actionError());
           }
+          clean_from = NO_TOKEN;
 
-          // Return a new result containing the ProgramAST
-          std::cout << "Parsing successful.\n";
-          return ASTProgram{};
+          if (!recover()) {
+            return std::unexpected(std::move(program.errors.front()));
+          }
+          break;
         }
-
-        case Action::ERROR:
-          return actionError();
       }
+
+      if (stats) countStack();
     }
   }
 
+  void Parser::countAction(ActionTable::State state, SymbolId terminal,
+                           const Action& action) {
+    ++stats->action_lookups;
+    if (terminal < action_table.symbols.terminalCount()) {
+      stats->touched_cells.set(state * action_table.symbols.terminalCount() +
+                               terminal);
+    }
+
+    if (action.type == Action::SHIFT) {
+      ++stats->shifts;
+    } else if (action.type == Action::REDUCE) {
+      ++stats->reductions;
+      ++stats->rule_hits[action.rule_index];
+      ++stats->goto_lookups;
+    }
+  }
+
+  void Parser::countStack() {
+    stats->max_depth = std::max<uint32_t>(stats->max_depth, symbols.size());
+    if (symbols.capacity() != stack_capacity) {
+      ++stats->stack_allocations;
+      stack_capacity = symbols.capacity();
+    }
+  }
+
+  Parser::ParseStatus Parser::accept() {
+    // If the stack has more than 2 elements (start and the final symbol)
+    // it means that the parsing process was not completed correctly, and
+    // it is a false accept that it was passed.
+    if (symbols.size() > 2) {
+      return ParserError::makeInternalError();
+    }
+
+    // The program is complete, its root is the node of the symbol that was
+    // accepted.
+    program.root = symbols.peekTop().node;
+    return {};
+  }
+
+  Index Parser::shiftNode() {
+    return reductions::tokenLeaf(program.storage, lookahead_token,
+                                 tokens.source());
+  }
+
+  Lexer::LexerResult Parser::nextToken() {
+    if (!replaying) {
+      ++cursor;
+      return tokens.next();
+    }
+
+    // The log ends at the end of file or where the lexer failed
+    if (cursor < log.tokens.size()) return log.tokens[cursor++];
+    if (log.error) return std::unexpected(*log.error);
+    return log.tokens.back();
+  }
+
   Parser::SymbolResult Parser::nextSymbol() {
     // Consume token and move to next
-    auto result = tokens.next();
+    ScopedTimer timer(stats ? &stats->lexing_time : nullptr);
+    auto result = nextToken();
 
     // Check if token has any defect
     if (!result) {
       return ParserError::makeLexerError(result.error());
     }
 
-    // Map the token to the specified symbol
-    Symbol sym = {};
-    switch (result->type) {
-      case TokenType::CHAR_LITERAL:
-      case TokenType::BOOL_LITERAL:
-      case TokenType::STR8_LITERAL:
-      case TokenType::STR16_LITERAL:
-      case TokenType::INT8_LITERAL:
-      case TokenType::INT16_LITERAL:
-      case TokenType::INT32_LITERAL:
-      case TokenType::INT64_LITERAL:
-      case TokenType::UINT8_LITERAL:
-      case TokenType::UINT16_LITERAL:
-      case TokenType::UINT32_LITERAL:
-      case TokenType::UINT64_LITERAL:
-      case TokenType::FLOAT32_LITERAL:
-      case TokenType::FLOAT64_LITERAL:
-        return Symbol::literal();
-      case TokenType::IDENTIFIER:
-        return Symbol::identifier();
-      case TokenType::ENDOF:
-        return Symbol::endOF();
-      case TokenType::KEYWORD:
-        sym.type = Symbol::Type::KW_TERMINAL;
-        sym.terminal.keyword = result->value.keyword;
-        return sym;
-      case TokenType::PUNCTUATOR:
-        sym.type = Symbol::Type::PUN_TERMINAL;
-        sym.terminal.punctuator = result->value.punctuator;
-        return sym;
-      default:
-        // This should never happen
-        return ParserError::makeUnknownSymbolError();
-    }
-  }
-
-  Parser::ParserResult Parser::actionError() {
+    // The lexer already stamped the terminal id on the token. Tokens the
+    // grammar has no terminal for are reported once the action table
+    // rejects them.
+    lookahead_token = *result;
+    SymbolId terminal = lookahead_token.terminal;
+
+    if (terminal == SymbolTable::NONE &&
+        Symbol::fromToken(lookahead_token).type == Symbol::Type::UNKNOWN) {
+      // This should never happen
+      return ParserError::makeUnknownSymbolError();
+    }
+    return terminal;
+  }
+
+  LexerState Parser::lookaheadState() const {
+    if (!replaying) return tokens.state();
+
+    // The lexer ran ahead over the whole source, the lookahead is located
+    // from its span instead.
+    const std::string_view source = tokens.source();
+    const uint32_t start = log.spans[cursor - 1].start;
+    const size_t line =
+        std::count(source.begin(), source.begin() + start, '\n');
+    const size_t line_start =
+        start > 0 ? source.rfind('\n', start - 1) + 1 : 0;
+
+    size_t line_end = source.find('\n', start);
+    if (line_end == std::string_view::npos) line_end = source.size();
+
+    return LexerState{line, start - line_start + 1, tokens.filename(),
+                      source.substr(line_start, line_end - line_start),
+                      cursor > 1 ? log.tokens[cursor - 2] : Token::endOF()};
+  }
+
+  ParserError Parser::actionError() {
     if (symbols.isEmpty()) {
-      return ParserError::makeUnknownError();  // Defensive fallback
+      // Defensive fallback
+      return ParserError::makeUnknownError().error();
     }
 
     // Get the invalid symbol (lookahead) that caused the error
     SymbolResult bad_symbol = lookahead;
     if (!bad_symbol) {
-      return ParserError::makeUnknownSymbolError();  // Defensive fallback
+      // Defensive fallback
+      return ParserError::makeUnknownSymbolError().error();
     }
 
     // Obtain the last symbol state from the stack
@@ -138,19 +511,85 @@ namespace compiler {
         action_table.validSymbols(current_state);
 
     // Get all RHSs that start with those expected symbols (for helpful
-    // suggestions)
+    // suggestions). The table already knows which rules those are.
+    std::span<const uint32_t> examples =
+        action_table.exampleRules(current_state);
+
     std::vector<std::vector<Symbol>> expected_rhs;
-    for (const auto& sym : expected_symbols) {
-      for (const Rule& rule : grammar) {
-        if (*rule.rhs.begin() == sym) {
-          expected_rhs.push_back(rule.rhs);
-        }
+    expected_rhs.reserve(examples.size());
+    for (uint32_t rule_index : examples) {
+      std::span<const Symbol> rhs = grammar.rhsOf(rule_index);
+      expected_rhs.emplace_back(rhs.begin(), rhs.end());
+    }
+
+    return ParserError::makeUnexSymbolError(
+               Symbol::fromToken(lookahead_token), lookaheadState(),
+               std::move(expected_symbols), std::move(expected_rhs))
+        .error();
+  }
+
+  bool Parser::recover() {
+    const SymbolId error = action_table.symbols.errorId();
+
+    // Grammars without error productions fall back to panic mode.
+    if (error == SymbolTable::NONE) {
+      return skipToSyncPoint();
+    }
+
+    // An `error` was just shifted and the lookahead still does not fit, so
+    // it belongs to the broken construct as well.
+    if (recovering == RECOVERY_SHIFTS) {
+      return discardLookahead();
+    }
+    recovering = RECOVERY_SHIFTS;
+
+    // Unwind to the closest state that can shift `error`, dropping the
+    // partial constructs above it.
+    while (true) {
+      Action action =
+          action_table.actionFrom(symbols.peekTop().state, error);
+
+      if (action.type == Action::SHIFT) {
+        // The error node stands for everything that was dropped
+        Handle<ErrorAST> node = program.storage.push(
+            ErrorAST{static_cast<uint32_t>(program.errors.size() - 1)});
+        symbols.push({Symbol::error(), action.next_state, node.index,
+                      cursor - 1});
+        return true;
       }
+
+      if (symbols.size() == 1) return false;
+      symbols.pop(1);
     }
+  }
+
+  bool Parser::discardLookahead() {
+    if (*lookahead == SymbolTable::ENDOF) return false;
+
+    lookahead = nextSymbol();
+    return true;
+  }
 
-    return ParserError::makeUnexSymbolError(*lookahead, tokens.state(),
-                                            std::move(expected_symbols),
-                                            std::move(expected_rhs));
+  bool Parser::skipToSyncPoint() {
+    recovering = RECOVERY_SHIFTS;
+
+    // Drop tokens up to and including the end of the broken construct.
+    while (!isSyncPoint(lookahead_token)) {
+      // Lexer errors are reported by the parse loop
+      if (!lookahead) return true;
+      if (*lookahead == SymbolTable::ENDOF) return false;
+      lookahead = nextSymbol();
+    }
+    lookahead = nextSymbol();
+    if (!lookahead) return true;
+
+    // Then unwind to a state that knows what to do with the next token.
+    while (action_table.actionFrom(symbols.peekTop().state, *lookahead).type ==
+           Action::ERROR) {
+      if (symbols.size() == 1) return false;
+      symbols.pop(1);
+    }
+    return true;
   }
 
 }  // namespace compiler
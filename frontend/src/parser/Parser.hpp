@@ -1,19 +1,48 @@
 #pragma once
 
+#include <concepts>
 #include <expected>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "ActionTable.hpp"
+#include "Grammar.hpp"
 #include "ParseStack.hpp"
 #include "ParserError.hpp"
+#include "ParserStats.hpp"
+#include "StaticGrammar.hpp"
 #include "Symbols.hpp"
+#include "TableCache.hpp"
+#include "ast/StorageAST.hpp"
 #include "tokens/TokenStream.hpp"
 
 namespace compiler {
 
-  // TEMP
-  class ASTProgram {};
+  /**
+   * @brief Receives the steps of Parser::parseEvents(): every token shifted
+   *        and every rule reduced, with the bytes of the source it covers.
+   *
+   */
+  template <typename T>
+  concept ParseEvents = requires(T& events, const Token& token,
+                                 uint32_t rule, TokenStream::Span span) {
+    events.onShift(token);
+    events.onReduce(rule, span);
+  };
+
+  /**
+   * @brief A parsed program: every node it owns, the index of the root node
+   *        and the syntax errors the parser recovered from on the way. The
+   *        nodes of a construct that could not be parsed are replaced by
+   *        error nodes pointing back into `errors`.
+   *
+   */
+  struct ASTProgram {
+    ASTStorage storage;
+    Index root = NO_INDEX;
+    std::vector<ParserError> errors;
+  };
 
   /**
    * @brief A recursive descent parser for a C/C++-like language.
@@ -27,20 +56,77 @@ namespace compiler {
     /**
      * @brief The result of a parsing operation.
      *
-     *        Contains either a successfully parsed Symbol or a ParserError
-     *        describing the failure.
+     *        Contains either the terminal id of the next token or a
+     *        ParserError describing the failure.
      */
-    using SymbolResult = std::expected<Symbol, ParserError>;
+    using SymbolResult = std::expected<SymbolId, ParserError>;
     using ParserResult = std::expected<ASTProgram, ParserError>;
+    using ProgramResult = std::expected<const ASTProgram*, ParserError>;
+    using EventResult = std::expected<void, ParserError>;
+
+    // Source bytes per token assumed when the AST storage is reserved
+    // before the tokens are counted. C sources average about 4.
+    static constexpr size_t BYTES_PER_TOKEN = 4;
+
+    /**
+     * @brief A change of the source: the bytes in [start, old_end) of the
+     *        previous source were replaced by the bytes in [start, new_end)
+     *        of the new one.
+     *
+     */
+    struct TextEdit {
+      uint32_t start;
+      uint32_t old_end;
+      uint32_t new_end;
+    };
 
   public:
     /**
      * @brief Constructs a new Parser object.
      *
+     *        The parse table is not built here, it is obtained from the
+     *        process-wide TableCache and shared with every other Parser that
+     *        uses the same grammar.
+     *
+     *        In builds with FRONTEND_DIRECT_PARSER, a grammar equal to the
+     *        one the direct-coded parser was generated from is parsed by
+     *        that generated code instead of the table-driven loop.
+     *
      * @param tokens   A stream of tokens to be parsed.
      * @param grammar  A list of production rules representing the grammar.
      */
     explicit Parser(TokenStream& tokens, const Grammar& grammar) noexcept;
+
+    /**
+     * @brief Constructs a new Parser object that drives a given parse table.
+     *
+     * @param tokens   A stream of tokens to be parsed.
+     * @param grammar  A list of production rules representing the grammar.
+     * @param table    Parse table built for an equal grammar, it must
+     *                 outlive the parser.
+     */
+    explicit Parser(TokenStream& tokens, const Grammar& grammar,
+                    const ActionTable& table) noexcept;
+
+    /**
+     * @brief Constructs a new Parser object for a constexpr grammar, whose
+     *        automaton the compiler already built. The runtime table is a
+     *        view over its arrays, made once and shared through the
+     *        TableCache, the LR(0) construction never runs.
+     *
+     *        static constexpr auto GRAMMAR = makeGrammar(...);
+     *        Parser parser(tokens, grammar, StaticTable<GRAMMAR>);
+     *
+     * @param tokens   A stream of tokens to be parsed.
+     * @param grammar  GRAMMAR.toGrammar(), or an equal grammar.
+     * @param table    StaticTable<GRAMMAR>.
+     */
+    template <size_t... SIZES>
+    explicit Parser(TokenStream& tokens, const Grammar& grammar,
+                    const StaticActionTable<SIZES...>& table) noexcept
+        : Parser(tokens, grammar,
+                 TableCache::tableFor(grammar, table.prebuilt())) {}
+
     ~Parser() noexcept = default;
 
     /**
@@ -48,23 +134,262 @@ namespace compiler {
      *
      *        This function drives the parsing process. It iteratively applies
      *        grammar rules and builds up a higher-level representation of the
-     *        input structure.
+     *        input structure. Every reduction runs the handler of its rule,
+     *        which appends the new nodes straight into the program's
+     *        ASTStorage.
+     *
+     *        Syntax errors do not stop the parse. If the grammar has `error`
+     *        productions the parser unwinds to a state that can shift
+     *        `error` and discards tokens until it can go on, otherwise it
+     *        skips past the next `;` or `}`. Every error is collected in the
+     *        returned program; the parse only fails when it cannot recover,
+     *        and then reports the first error found.
      *
      * @return ParserResult
      */
     ParserResult parse();
 
+    /**
+     * @brief Parses the token stream like parse(), but keeps the program in
+     *        the parser. The program stays valid until the next parse, which
+     *        builds its nodes into the same storage without reallocating it
+     *        once it has grown large enough.
+     *
+     * @return ProgramResult
+     */
+    ProgramResult parseInPlace();
+
+    /**
+     * @brief Points the parser at a new source. The token stream and its
+     *        lexer start over, everything else is kept: the parse table,
+     *        the stack and the AST storage. Does not allocate.
+     *
+     * @param filename
+     * @param source
+     */
+    void reset(std::string_view filename, std::string_view source);
+
+    /**
+     * @brief Parses the token stream like parseInPlace(), and keeps what a
+     *        later reparse() needs: every token with its span in the source
+     *        and every subtree reduced on the way. The whole source is
+     *        lexed before parsing starts, and the table-driven loop is used
+     *        even in direct-coded builds.
+     *
+     * @return ProgramResult
+     */
+    ProgramResult parseIncremental();
+
+    /**
+     * @brief Parses an edited version of the source parsed last, reusing
+     *        as much of the previous parse as the edit left untouched.
+     *
+     *        Only the tokens around the edit are lexed again. The parser
+     *        then runs over the spliced token log and, whenever its state
+     *        and position match a subtree of an earlier parse that covers
+     *        no changed token, shifts that subtree as a single non-terminal
+     *        instead of parsing it again. The result equals the one of a
+     *        parseIncremental() of the new source.
+     *
+     *        Nodes of replaced subtrees stay in the storage until the next
+     *        full parse, which happens on its own once too many of them
+     *        have piled up. Falls back to a full parse when the last one
+     *        did not lex the whole source.
+     *
+     * @param source  The edited source, it must outlive the program.
+     * @param edit    What changed since the previous parse.
+     * @return ProgramResult
+     */
+    ProgramResult reparse(std::string_view source, const TextEdit& edit);
+
+    /**
+     * @brief Parses the token stream without building anything, reporting
+     *        each shift and reduction to `events` as it happens instead.
+     *        The handlers are inlined into the parse loop, which keeps no
+     *        more than the parse stack.
+     *
+     *        Rules are reported by their index in the grammar, with the
+     *        span from the first byte of their first token to the last byte
+     *        of their last one. Empty rules get an empty span at the
+     *        lookahead. Unit rules a table skips over are not reported,
+     *        tools that need them drive a table that keeps them.
+     *
+     *        Runs the table-driven loop in every build and stops at the
+     *        first syntax error.
+     *
+     * @param events
+     * @return EventResult
+     */
+    template <ParseEvents Events>
+    EventResult parseEvents(Events& events);
+
+    /**
+     * @brief Makes the following parses count what they do into `stats`,
+     *        nullptr stops counting. Counting parses run the table-driven
+     *        loop even in direct-coded builds.
+     *
+     * @param stats  Must outlive the parses it counts.
+     */
+    void collectStats(ParserStats* stats) { this->stats = stats; }
+
+    /**
+     * @brief Returns whether parse() runs the generated direct-coded parser.
+     *
+     * @return true if built with FRONTEND_DIRECT_PARSER for this grammar
+     */
+    bool isDirectCoded() const { return direct_coded; }
+
+  private:
+    // Tokens to shift after a recovery before errors are reported again.
+    static constexpr uint8_t RECOVERY_SHIFTS = 3;
+
+    // Outcome of a parse, the program itself is left in `program`.
+    using ParseStatus = std::expected<void, ParserError>;
+
+    static constexpr uint32_t NO_SUBTREE = UINT32_MAX;
+    static constexpr uint32_t NO_TOKEN = UINT32_MAX;
+
+    /**
+     * @brief A non-terminal reduced by an earlier parse, which can be
+     *        shifted as a whole when the parser is back in `state` at its
+     *        first token and none of the tokens it covers changed.
+     *
+     */
+    struct Subtree {
+      SymbolId lhs;
+      ActionTable::State state;  // State uncovered by the reduction
+      uint32_t length;           // Tokens it covers, the lookahead aside
+      Index node;
+      uint32_t next;  // Next subtree that starts at the same token
+    };
+
+    /**
+     * @brief The tokens of the last incremental parse and the subtrees it
+     *        can give to the next one. `first_at` heads, for every token, a
+     *        list of the subtrees starting at it, the latest reduced first.
+     *
+     */
+    struct ParseLog {
+      std::vector<Token> tokens;
+      std::vector<TokenStream::Span> spans;
+      std::vector<uint32_t> first_at;
+      std::vector<Subtree> subtrees;
+      std::optional<LexerError> error;  // What the lexer hit after the tokens
+      size_t full_parse_at = 0;  // Subtree count that triggers a full parse
+
+      // Tokens lexed again by reparse(), kept to reuse their memory
+      std::vector<Token> relexed;
+      std::vector<TokenStream::Span> relexed_spans;
+    };
+
   private:
     const Grammar& grammar;
     TokenStream& tokens;
-    ActionTable action_table;
+    const ActionTable& action_table;
     ParseStack symbols;
+    ASTProgram program;
     SymbolResult lookahead;
+    Token lookahead_token;
+    uint8_t recovering;
+    bool direct_coded;
+
+    // Incremental parsing state. `cursor` counts the tokens read so far,
+    // the lookahead is the token before it. Subtrees are only recorded
+    // from `clean_from` on, the first token after the last recovery.
+    ParseLog log;
+    bool replaying;
+    uint32_t cursor;
+    uint32_t clean_from;
+
+    // Statistics, only kept while `stats` is set
+    ParserStats* stats;
+    size_t stack_capacity;
 
   private:
-    bool reduce();
+    // Defined by the code parser_codegen generates, which is only part of
+    // builds with FRONTEND_DIRECT_PARSER.
+    static bool hasDirectCode(const Grammar& grammar);
+    ParseStatus parseDirect();
+
+    ParseStatus run(bool keep_nodes = false);
+    ParseStatus accept();
+    void countAction(ActionTable::State state, SymbolId terminal,
+                     const Action& action);
+    void countStack();
+    Index shiftNode();
 
+    ProgramResult replay(bool keep_nodes);
+    bool reuseSubtree();
+    void recordSubtree(SymbolId lhs, ActionTable::State state, uint32_t begin,
+                       Index node);
+    void rebaseNodes(const TextEdit& edit);
+
+    Lexer::LexerResult nextToken();
     SymbolResult nextSymbol();
-    ParserResult actionError();
+    LexerState lookaheadState() const;
+    ParserError actionError();
+
+    bool recover();
+    bool discardLookahead();
+    bool skipToSyncPoint();
   };
+
+  template <ParseEvents Events>
+  Parser::EventResult Parser::parseEvents(Events& events) {
+    // The loop of run() without nodes. Stack entries keep the first byte
+    // of their symbol in place of its first token.
+    replaying = false;
+    cursor = 0;
+    lookahead = nextSymbol();
+    TokenStream::Span span = tokens.span();
+    uint32_t end = span.start;  // Last byte of the last token shifted
+
+    symbols.clear();
+    symbols.push({Symbol::start(), 0});
+
+    while (true) {
+      if (!lookahead) {
+        return std::unexpected(lookahead.error());
+      }
+
+      const Action action =
+          action_table.actionFrom(symbols.peekTop().state, *lookahead);
+
+      switch (action.type) {
+        case Action::SHIFT: {
+          events.onShift(lookahead_token);
+          symbols.push({action_table.symbols.symbolOf(*lookahead),
+                        action.next_state, NO_INDEX, span.start});
+          end = span.end;
+          lookahead = nextSymbol();
+          span = tokens.span();
+          break;
+        }
+
+        case Action::REDUCE: {
+          const uint16_t length = grammar.recordOf(action.rule_index).length;
+          const SymbolId lhs = action_table.lhsOf(action.rule_index);
+          const uint32_t start =
+              length > 0 ? symbols.peekTop(length).front().token : span.start;
+          events.onReduce(action.rule_index,
+                          TokenStream::Span{start, length > 0 ? end : start});
+
+          symbols.pop(length);
+          symbols.push({action_table.symbols.symbolOf(lhs),
+                        action_table.gotoFrom(symbols.peekTop().state, lhs),
+                        NO_INDEX, start});
+          break;
+        }
+
+        case Action::ACCEPT: {
+          if (symbols.size() > 2) return ParserError::makeInternalError();
+          return {};
+        }
+
+        case Action::ERROR: {
+          return std::unexpected(actionError());
+        }
+      }
+    }
+  }
 }  // namespace compiler
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "ParserStats.hpp"
+
+#include <sstream>
+
+namespace compiler {
+
+  namespace {
+    // Symbols print as plain text, but punctuators may hold quotes
+    void writeEscaped(std::ostringstream& out, const std::string& text) {
+      for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+      }
+    }
+  }  // namespace
+
+  void ParserStats::prepare(size_t rules, size_t cells) {
+    if (rule_hits.size() < rules) rule_hits.resize(rules, 0);
+    if (table_cells != cells) {
+      touched_cells = BitSet(cells);
+      table_cells = cells;
+    }
+  }
+
+  void ParserStats::clear() {
+    *this = ParserStats();
+  }
+
+  std::string ParserStats::toJSON(const Grammar& grammar) const {
+    const std::chrono::nanoseconds parsing_time = total_time - lexing_time;
+
+    std::ostringstream out;
+    out << "{\n"
+        << "  \"parses\": " << parses << ",\n"
+        << "  \"shifts\": " << shifts << ",\n"
+        << "  \"reductions\": " << reductions << ",\n"
+        << "  \"action_lookups\": " << action_lookups << ",\n"
+        << "  \"goto_lookups\": " << goto_lookups << ",\n"
+        << "  \"action_cells\": {\"touched\": " << touched_cells.count()
+        << ", \"total\": " << table_cells << "},\n"
+        << "  \"stack\": {\"allocations\": " << stack_allocations
+        << ", \"max_depth\": " << max_depth << "},\n"
+        << "  \"time_ns\": {\"total\": " << total_time.count()
+        << ", \"lexing\": " << lexing_time.count()
+        << ", \"parsing\": " << parsing_time.count() << "},\n"
+        << "  \"rules\": [";
+
+    for (size_t i = 0; i < grammar.size(); ++i) {
+      const Rule rule = grammar[i];
+      out << (i == 0 ? "\n" : ",\n") << "    {\"index\": " << i
+          << ", \"rule\": \"";
+      writeEscaped(out, Symbol{.type = Symbol::Type::NON_TERMINAL,
+                               .nonterminal = rule.lhs}
+                            .toString());
+      out << " ->";
+      for (const Symbol& symbol : rule.rhs) {
+        out << ' ';
+        writeEscaped(out, symbol.toString());
+      }
+      out << "\", \"hits\": " << (i < rule_hits.size() ? rule_hits[i] : 0)
+          << "}";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+  }
+}  // namespace compiler
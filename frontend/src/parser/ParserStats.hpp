@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BitSet.hpp"
+#include "Grammar.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief What the parse loop did, summed over every parse it was handed
+   *        to. Used to find the rules worth refactoring and to tell how
+   *        much of the table a real input touches.
+   *
+   *        The table is a dense array, so lookups never miss. The cells
+   *        they touch are recorded instead, a table compression only pays
+   *        off when few of them are.
+   */
+  struct ParserStats {
+    uint64_t parses = 0;
+    uint64_t shifts = 0;
+    uint64_t reductions = 0;
+    std::vector<uint64_t> rule_hits;  // Reductions by rule index
+    uint64_t action_lookups = 0;
+    uint64_t goto_lookups = 0;
+
+    // Action cells looked up at least once, indexed like the table
+    BitSet touched_cells;
+    size_t table_cells = 0;
+
+    uint64_t stack_allocations = 0;  // Times the parse stack grew
+    uint32_t max_depth = 0;
+
+    // Time spent in the lexer is part of the total
+    std::chrono::nanoseconds lexing_time{0};
+    std::chrono::nanoseconds total_time{0};
+
+    /**
+     * @brief Sizes the counters for a grammar and its table, keeping them
+     *        when they already fit.
+     *
+     * @param rules  Number of rules of the grammar.
+     * @param cells  Number of action cells of the table.
+     */
+    void prepare(size_t rules, size_t cells);
+
+    /**
+     * @brief Resets every counter.
+     *
+     */
+    void clear();
+
+    /**
+     * @brief Writes the counters as a JSON object, rules spelled out from
+     *        the grammar they were counted with.
+     *
+     * @param grammar
+     * @return std::string
+     */
+    std::string toJSON(const Grammar& grammar) const;
+  };
+}  // namespace compiler
@@ -0,0 +1,49 @@
+#include "StateRegistry.hpp"
+
+#include <algorithm>
+
+namespace compiler {
+
+  std::pair<StateRegistry::Entry*, bool> StateRegistry::intern(
+      ItemSet&& kernel, uint64_t hash) {
+    // The top bits pick the shard, the low bits pick the slot inside it.
+    Shard& shard = shards[hash >> (64 - SHARD_BITS)];
+    std::lock_guard lock(shard.mutex);
+
+    if (!shard.slots.empty()) {
+      const size_t mask = shard.slots.size() - 1;
+      for (size_t i = hash & mask; shard.slots[i].entry; i = (i + 1) & mask) {
+        const Slot& slot = shard.slots[i];
+        if (slot.hash == hash && slot.entry->kernel == kernel) {
+          return {slot.entry, false};
+        }
+      }
+    }
+
+    // Keep the load factor under 1/2 so probe chains stay short.
+    if ((shard.entries.size() + 1) * 2 > shard.slots.size()) {
+      grow(shard);
+    }
+
+    Entry& entry = shard.entries.emplace_back();
+    entry.kernel = std::move(kernel);
+    entry.hash = hash;
+    place(shard.slots, Slot{hash, &entry});
+    return {&entry, true};
+  }
+
+  void StateRegistry::place(std::vector<Slot>& slots, Slot slot) {
+    const size_t mask = slots.size() - 1;
+    size_t i = slot.hash & mask;
+    while (slots[i].entry) i = (i + 1) & mask;
+    slots[i] = slot;
+  }
+
+  void StateRegistry::grow(Shard& shard) {
+    std::vector<Slot> old(std::max<size_t>(16, shard.slots.size() * 2));
+    old.swap(shard.slots);
+    for (const Slot& slot : old) {
+      if (slot.entry) place(shard.slots, slot);
+    }
+  }
+}  // namespace compiler
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "ActionTable.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief Concurrent map from LR(0) kernels to the states that own them.
+   *
+   *        The table builder expands a whole level of the automaton in
+   *        parallel and every worker interns the successor kernels it finds
+   *        here. The map is split in shards, each with its own lock and open
+   *        addressing index, so workers only contend when two kernels land in
+   *        the same shard at the same time.
+   *
+   *        Interning does not number states. Numbers are handed out later by
+   *        a single thread in a fixed order, which keeps the automaton
+   *        identical to the one a sequential build would produce.
+   */
+  class StateRegistry final {
+  public:
+    using State = ActionTable::State;
+    using ItemSet = ActionTable::ItemSet;
+
+    static constexpr State NONE = static_cast<State>(-1);
+
+    /**
+     * @brief A registered kernel. Entries never move once created.
+     *
+     */
+    struct Entry {
+      ItemSet kernel;
+      ItemSet items;        // Closure, filled in by whoever interned it
+      uint64_t hash = 0;
+      State state = NONE;   // Assigned when the state gets numbered
+    };
+
+  public:
+    explicit StateRegistry() noexcept = default;
+
+    /**
+     * @brief Finds the entry of a kernel or registers a new one. Safe to
+     *        call from several threads at once.
+     *
+     * @param kernel sorted kernel items
+     * @param hash   ActionTable::KernelHasher of the kernel
+     * @return the entry and whether this call created it
+     */
+    std::pair<Entry*, bool> intern(ItemSet&& kernel, uint64_t hash);
+
+  private:
+    struct Slot {
+      uint64_t hash = 0;
+      Entry* entry = nullptr;
+    };
+
+    struct Shard {
+      std::mutex mutex;
+      std::deque<Entry> entries;
+      std::vector<Slot> slots;
+    };
+
+    static constexpr size_t SHARD_BITS = 6;
+
+  private:
+    std::array<Shard, size_t{1} << SHARD_BITS> shards;
+
+  private:
+    static void place(std::vector<Slot>& slots, Slot slot);
+    static void grow(Shard& shard);
+  };
+}  // namespace compiler
@@ -0,0 +1,480 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ActionTable.hpp"
+#include "Grammar.hpp"
+#include "LR0.hpp"
+#include "SymbolTable.hpp"
+#include "Symbols.hpp"
+
+namespace compiler {
+
+  // Grammar DSL. Symbols and rules are literal types, so a whole grammar can
+  // be declared as a constexpr variable:
+  //
+  //   static constexpr auto GRAMMAR = makeGrammar(
+  //       rule(NonTerminal::START, nt(NonTerminal::EXPR)),
+  //       rule(NonTerminal::EXPR, nt(NonTerminal::EXPR), pun(Punctuator::PLUS),
+  //            nt(NonTerminal::TERM))
+  //           .reduceWith(reductions::binaryExpr),
+  //       ...);
+  //
+  // and its parse tables are then built by the compiler, see StaticTable.
+
+  constexpr Symbol nt(NonTerminal nonterminal) {
+    return Symbol{.type = Symbol::Type::NON_TERMINAL,
+                  .nonterminal = nonterminal};
+  }
+
+  constexpr Symbol pun(Punctuator punctuator) {
+    return Symbol{.type = Symbol::Type::PUN_TERMINAL,
+                  .terminal = {.punctuator = punctuator}};
+  }
+
+  constexpr Symbol kw(Keyword keyword) {
+    return Symbol{.type = Symbol::Type::KW_TERMINAL,
+                  .terminal = {.keyword = keyword}};
+  }
+
+  constexpr Symbol lit() { return Symbol::literal(); }
+  constexpr Symbol id() { return Symbol::identifier(); }
+  constexpr Symbol err() { return Symbol::error(); }
+
+  /**
+   * @brief A rule with a RHS of N symbols, as written in the DSL.
+   *
+   */
+  template <size_t N>
+  struct StaticRule {
+    NonTerminal lhs;
+    std::array<Symbol, N> rhs;
+    ReductionHandler handler = nullptr;
+
+    /**
+     * @brief Returns the same rule with a semantic action attached.
+     *
+     * @param reduction
+     * @return StaticRule
+     */
+    constexpr StaticRule reduceWith(ReductionHandler reduction) const {
+      return StaticRule{lhs, rhs, reduction};
+    }
+  };
+
+  template <typename... Symbols>
+  constexpr StaticRule<sizeof...(Symbols)> rule(NonTerminal lhs,
+                                                Symbols... rhs) {
+    return {lhs, {rhs...}, nullptr};
+  }
+
+  /**
+   * @brief A grammar stored flat: every RHS lives in one symbol pool and
+   *        each rule records where its own RHS starts and how long it is.
+   *
+   */
+  template <size_t RULES, size_t SYMBOLS>
+  struct StaticGrammar {
+    struct Record {
+      NonTerminal lhs;
+      uint16_t offset;
+      uint16_t length;
+      ReductionHandler handler;
+    };
+
+    std::array<Record, RULES> rules;
+    std::array<Symbol, SYMBOLS> pool;
+
+    constexpr std::span<const Symbol> rhsOf(size_t rule_index) const {
+      return {pool.data() + rules[rule_index].offset,
+              rules[rule_index].length};
+    }
+
+    /**
+     * @brief Copies the grammar into the runtime representation, handlers
+     *        included.
+     *
+     * @return Grammar
+     */
+    Grammar toGrammar() const {
+      Grammar grammar;
+      grammar.reserve(RULES, SYMBOLS);
+      for (size_t i = 0; i < RULES; ++i) {
+        grammar.add(rules[i].lhs, rhsOf(i), rules[i].handler);
+      }
+      return grammar;
+    }
+  };
+
+  namespace detail {
+    // Symbol::operator== reads an inactive union member, which is not
+    // allowed in constant expressions. Compare through the active one.
+    constexpr uint8_t keyOf(const Symbol& symbol) {
+      switch (symbol.type) {
+        case Symbol::Type::NON_TERMINAL:
+          return static_cast<uint8_t>(symbol.nonterminal);
+        case Symbol::Type::KW_TERMINAL:
+          return static_cast<uint8_t>(symbol.terminal.keyword);
+        case Symbol::Type::PUN_TERMINAL:
+          return static_cast<uint8_t>(symbol.terminal.punctuator);
+        default:
+          return symbol.terminal.eof;
+      }
+    }
+
+    constexpr bool sameSymbol(const Symbol& a, const Symbol& b) {
+      return a.type == b.type && keyOf(a) == keyOf(b);
+    }
+
+    constexpr bool isNonTerminal(const Symbol& symbol) {
+      return symbol.type == Symbol::Type::NON_TERMINAL;
+    }
+
+    /**
+     * @brief LR(0) construction that runs inside the compiler.
+     *
+     *        It produces exactly the automaton ActionTable builds at
+     *        runtime: the same symbol ids, the same breadth-first state
+     *        numbering, the same rows and diagnostics, both compute them
+     *        with the helpers of LR0.hpp. Only the search for states
+     *        differs, here it is a plain constexpr vector and linear
+     *        searches, which is fine for the size of grammar one writes by
+     *        hand.
+     */
+    class StaticLR0 final {
+    public:
+      using Item = lr0::Item;
+      using ItemSet = lr0::ItemSet;
+
+      struct Shape {
+        size_t states;
+        size_t terminals;
+        size_t nonterminals;
+        size_t expected;  // Expected terminals of all states together
+        size_t examples;  // Example rules of all states together
+      };
+
+    public:
+      template <size_t RULES, size_t SYMBOLS>
+      constexpr explicit StaticLR0(
+          const StaticGrammar<RULES, SYMBOLS>& grammar) {
+        numberSymbols(grammar);
+        lr0::indexByLhs(rules(), symbols.size() - terminal_count,
+                        lhs_offsets, lhs_rules);
+        buildStates();
+        buildRows();
+        lr0::diagnose(rules(), actions, idOf(err()), expected_offsets,
+                      expected_terminals, example_offsets, example_rules);
+      }
+
+      constexpr Shape shape() const {
+        return {states.size(), terminal_count, symbols.size() - terminal_count,
+                expected_terminals.size(), example_rules.size()};
+      }
+
+      template <typename Table>
+      constexpr void fill(Table& table) const {
+        std::ranges::copy(symbols, table.symbols.begin());
+        std::ranges::copy(actions, table.actions.begin());
+        std::ranges::copy(gotos, table.gotos.begin());
+        std::ranges::copy(rule_lhs, table.rule_lhs.begin());
+        for (size_t i = 0; i < rule_lhs.size(); ++i) {
+          table.rule_length[i] =
+              static_cast<uint16_t>(rhs_offsets[i + 1] - rhs_offsets[i]);
+        }
+        std::ranges::copy(rhs_offsets, table.rhs_offsets.begin());
+        std::ranges::copy(rhs_ids, table.rhs_ids.begin());
+        std::ranges::copy(lhs_offsets, table.lhs_offsets.begin());
+        std::ranges::copy(lhs_rules, table.lhs_rules.begin());
+        std::ranges::copy(expected_offsets, table.expected_offsets.begin());
+        std::ranges::copy(expected_terminals,
+                          table.expected_terminals.begin());
+        std::ranges::copy(example_offsets, table.example_offsets.begin());
+        std::ranges::copy(example_rules, table.example_rules.begin());
+      }
+
+    private:
+      std::vector<Symbol> symbols;
+      size_t terminal_count = 0;
+      std::vector<SymbolId> rule_lhs;
+      std::vector<uint32_t> rhs_offsets;
+      std::vector<SymbolId> rhs_ids;
+      std::vector<uint32_t> lhs_offsets;
+      std::vector<uint32_t> lhs_rules;
+
+      std::vector<ItemSet> states;
+      std::vector<std::vector<std::pair<SymbolId, size_t>>> transitions;
+
+      std::vector<Action> actions;
+      std::vector<uint32_t> gotos;
+      std::vector<uint32_t> expected_offsets;
+      std::vector<SymbolId> expected_terminals;
+      std::vector<uint32_t> example_offsets;
+      std::vector<uint32_t> example_rules;
+
+    private:
+      constexpr lr0::Rules rules() const {
+        return {rule_lhs, rhs_offsets, rhs_ids, terminal_count};
+      }
+
+      constexpr SymbolId idOf(const Symbol& symbol) const {
+        for (size_t i = 0; i < symbols.size(); ++i) {
+          if (sameSymbol(symbols[i], symbol)) return static_cast<SymbolId>(i);
+        }
+        return SymbolTable::NONE;
+      }
+
+      constexpr void add(const Symbol& symbol) {
+        if (idOf(symbol) == SymbolTable::NONE) symbols.push_back(symbol);
+      }
+
+      // Same order as SymbolTable: end of file, terminals, non-terminals.
+      template <size_t RULES, size_t SYMBOLS>
+      constexpr void numberSymbols(
+          const StaticGrammar<RULES, SYMBOLS>& grammar) {
+        symbols.push_back(Symbol::endOF());
+        for (const Symbol& sym : grammar.pool) {
+          if (!isNonTerminal(sym)) add(sym);
+        }
+        terminal_count = symbols.size();
+
+        for (size_t i = 0; i < RULES; ++i) {
+          add(nt(grammar.rules[i].lhs));
+          for (const Symbol& sym : grammar.rhsOf(i)) {
+            if (isNonTerminal(sym)) add(sym);
+          }
+        }
+
+        // The pool already keeps every RHS back to back, so the ids mirror
+        // it and share its offsets
+        for (size_t i = 0; i < RULES; ++i) {
+          rule_lhs.push_back(idOf(nt(grammar.rules[i].lhs)));
+          rhs_offsets.push_back(grammar.rules[i].offset);
+        }
+        rhs_offsets.push_back(static_cast<uint32_t>(SYMBOLS));
+        for (const Symbol& sym : grammar.pool) rhs_ids.push_back(idOf(sym));
+      }
+
+      constexpr ItemSet closure(const ItemSet& kernel) const {
+        ItemSet result = kernel;
+        std::vector<uint8_t> expanded(symbols.size(), false);
+
+        for (size_t i = 0; i < result.size(); ++i) {
+          SymbolId sym = rules().symbolAfterDot(result[i]);
+          if (sym == SymbolTable::NONE || rules().isTerminal(sym) ||
+              expanded[sym]) {
+            continue;
+          }
+          expanded[sym] = true;
+          const size_t nt = sym - terminal_count;
+          for (uint32_t r = lhs_offsets[nt]; r < lhs_offsets[nt + 1]; ++r) {
+            result.push_back({static_cast<uint16_t>(lhs_rules[r]), 0});
+          }
+        }
+
+        lr0::canonicalize(result);
+        return result;
+      }
+
+      constexpr void buildStates() {
+        std::vector<ItemSet> kernels = {{Item{0, 0}}};
+        states.push_back(closure(kernels[0]));
+        transitions.emplace_back();
+
+        // States are appended in the order they are found, which is the
+        // breadth-first order ActionTable numbers them in.
+        for (size_t state = 0; state < states.size(); ++state) {
+          std::vector<std::pair<SymbolId, ItemSet>> successors;
+          lr0::successorsOf(rules(), states[state], successors);
+
+          for (auto& [sym, kernel] : successors) {
+            auto found = std::find(kernels.begin(), kernels.end(), kernel);
+            size_t target = found - kernels.begin();
+            if (found == kernels.end()) {
+              states.push_back(closure(kernel));
+              kernels.push_back(std::move(kernel));
+              transitions.emplace_back();
+            }
+            transitions[state].push_back({sym, target});
+          }
+        }
+      }
+
+      constexpr void buildRows() {
+        const size_t nonterminal_count = symbols.size() - terminal_count;
+        actions.assign(states.size() * terminal_count, Action::error());
+        gotos.assign(states.size() * nonterminal_count, lr0::NO_GOTO);
+        for (size_t state = 0; state < states.size(); ++state) {
+          lr0::fillRow(rules(), states[state], transitions[state],
+                       &actions[state * terminal_count],
+                       &gotos[state * nonterminal_count]);
+        }
+      }
+    };
+
+    // Grammar mistakes are reported while the grammar constant is being
+    // evaluated, so they surface as compile errors pointing at the throw.
+    template <size_t RULES, size_t SYMBOLS>
+    consteval void validate(const StaticGrammar<RULES, SYMBOLS>& grammar) {
+      if (RULES == 0) {
+        throw "grammar: a grammar needs at least the start rule";
+      }
+      if (grammar.rules[0].lhs != NonTerminal::START ||
+          grammar.rules[0].length != 1) {
+        throw "grammar: rule 0 must be the augmented rule START -> S";
+      }
+
+      for (size_t i = 0; i < RULES; ++i) {
+        if (i > 0 && grammar.rules[i].lhs == NonTerminal::START) {
+          throw "grammar: START may only be the LHS of rule 0";
+        }
+
+        for (const Symbol& sym : grammar.rhsOf(i)) {
+          if (sym.type == Symbol::Type::UNKNOWN ||
+              sym.type == Symbol::Type::EOF_TERMINAL) {
+            throw "grammar: a RHS may only hold terminals and non-terminals";
+          }
+          if (!isNonTerminal(sym)) continue;
+          if (sym.nonterminal == NonTerminal::START) {
+            throw "grammar: START may not appear in a RHS";
+          }
+
+          bool defined = false;
+          for (const auto& other : grammar.rules) {
+            defined |= other.lhs == sym.nonterminal;
+          }
+          if (!defined) {
+            throw "grammar: a non-terminal is used but has no rules";
+          }
+        }
+      }
+    }
+  }  // namespace detail
+
+  /**
+   * @brief Builds a flat grammar out of DSL rules. Evaluated at compile
+   *        time, an invalid grammar does not compile.
+   *
+   * @param rules the augmented start rule first
+   * @return StaticGrammar
+   */
+  template <size_t... N>
+  consteval auto makeGrammar(const StaticRule<N>&... rules) {
+    using Result = StaticGrammar<sizeof...(N), (N + ... + 0)>;
+    Result grammar{};
+
+    size_t rule_index = 0;
+    size_t offset = 0;
+    auto append = [&](const auto& rule) {
+      grammar.rules[rule_index++] = {rule.lhs, static_cast<uint16_t>(offset),
+                                     static_cast<uint16_t>(rule.rhs.size()),
+                                     rule.handler};
+      for (const Symbol& sym : rule.rhs) grammar.pool[offset++] = sym;
+    };
+    (append(rules), ...);
+
+    detail::validate(grammar);
+    return grammar;
+  }
+
+  /**
+   * @brief Parse tables computed entirely at compile time.
+   *
+   *        Same layout and lookups as ActionTable: row-major actions and
+   *        gotos indexed by dense symbol ids, next to the rule index and
+   *        the diagnostics of every state. Being a constexpr object, the
+   *        whole table is emitted into read-only data, and the runtime
+   *        table made from it reads it there.
+   */
+  template <size_t STATES, size_t TERMINALS, size_t NONTERMINALS,
+            size_t RULES, size_t SYMBOLS, size_t EXPECTED, size_t EXAMPLES>
+  struct StaticActionTable {
+    using State = ActionTable::State;
+
+    static constexpr uint32_t NO_GOTO = lr0::NO_GOTO;
+
+    std::array<Symbol, TERMINALS + NONTERMINALS> symbols;
+    std::array<Action, STATES * TERMINALS> actions;
+    std::array<uint32_t, STATES * NONTERMINALS> gotos;
+    std::array<SymbolId, RULES> rule_lhs;
+    std::array<uint16_t, RULES> rule_length;
+    std::array<uint32_t, RULES + 1> rhs_offsets;
+    std::array<SymbolId, SYMBOLS> rhs_ids;
+    std::array<uint32_t, NONTERMINALS + 1> lhs_offsets;
+    std::array<uint32_t, RULES> lhs_rules;
+    std::array<uint32_t, STATES + 1> expected_offsets;
+    std::array<SymbolId, EXPECTED> expected_terminals;
+    std::array<uint32_t, STATES + 1> example_offsets;
+    std::array<uint32_t, EXAMPLES> example_rules;
+
+    constexpr Action actionFrom(State state, SymbolId terminal) const {
+      return terminal < TERMINALS ? actions[state * TERMINALS + terminal]
+                                  : Action::error();
+    }
+
+    constexpr State gotoFrom(State state, SymbolId nonterminal) const {
+      uint32_t target =
+          gotos[state * NONTERMINALS + (nonterminal - TERMINALS)];
+      return target != NO_GOTO ? target : ActionTable::NO_STATE;
+    }
+
+    constexpr SymbolId lhsOf(size_t rule_index) const {
+      return rule_lhs[rule_index];
+    }
+
+    /**
+     * @brief Returns the arrays an ActionTable views instead of building
+     *        them, see TableCache::tableFor().
+     *
+     * @return ActionTable::Prebuilt
+     */
+    ActionTable::Prebuilt prebuilt() const {
+      return {actions,
+              gotos,
+              rule_lhs,
+              rhs_offsets,
+              rhs_ids,
+              lhs_offsets,
+              lhs_rules,
+              expected_offsets,
+              expected_terminals,
+              example_offsets,
+              example_rules};
+    }
+
+    static constexpr size_t stateCount() { return STATES; }
+    static constexpr size_t terminalCount() { return TERMINALS; }
+    static constexpr size_t nonTerminalCount() { return NONTERMINALS; }
+  };
+
+  namespace detail {
+    template <const auto& grammar>
+    consteval auto buildStaticTable() {
+      // First pass sizes the arrays, second one fills them. Constexpr
+      // allocations cannot outlive the evaluation that made them, so the
+      // automaton is simply built twice.
+      constexpr StaticLR0::Shape shape = StaticLR0(grammar).shape();
+
+      StaticActionTable<shape.states, shape.terminals, shape.nonterminals,
+                        grammar.rules.size(), grammar.pool.size(),
+                        shape.expected, shape.examples>
+          table{};
+      StaticLR0(grammar).fill(table);
+      return table;
+    }
+  }  // namespace detail
+
+  /**
+   * @brief The compile-time parse table of a constexpr grammar. A Parser
+   *        given it never builds the automaton at runtime.
+   *
+   *        static constexpr auto GRAMMAR = makeGrammar(...);
+   *        constexpr const auto& table = StaticTable<GRAMMAR>;
+   */
+  template <const auto& grammar>
+  inline constexpr auto StaticTable = detail::buildStaticTable<grammar>();
+}  // namespace compiler
@@ -0,0 +1,105 @@
+#include "SymbolTable.hpp"
+
+namespace compiler {
+
+  SymbolTable::SymbolTable(const Grammar& grammar) noexcept
+      : terminal_count(0),
+        literal_id(NONE),
+        identifier_id(NONE),
+        error_id(NONE) {
+    terminal_map.by_type.fill(NONE);
+    terminal_map.keywords.fill(NONE);
+    terminal_map.punctuators.fill(NONE);
+    nonterminal_ids.fill(NONE);
+
+    // Terminals first, the end of file marker always takes id 0.
+    add(Symbol::endOF());
+    for (const Symbol& sym : grammar.symbols()) {
+      if (sym.type != Symbol::Type::NON_TERMINAL) add(sym);
+    }
+    terminal_count = symbols.size();
+
+    // Then every non-terminal, whether it appears as a LHS or in a RHS.
+    for (size_t i = 0; i < grammar.size(); ++i) {
+      Rule rule = grammar[i];
+      Symbol lhs{.type = Symbol::Type::NON_TERMINAL, .nonterminal = rule.lhs};
+      add(lhs);
+      for (const Symbol& sym : rule.rhs) {
+        if (sym.type == Symbol::Type::NON_TERMINAL) add(sym);
+      }
+    }
+
+    // Every literal kind is the one literal terminal
+    for (TokenType type :
+         {TokenType::CHAR_LITERAL, TokenType::BOOL_LITERAL,
+          TokenType::STR8_LITERAL, TokenType::STR16_LITERAL,
+          TokenType::INT8_LITERAL, TokenType::INT16_LITERAL,
+          TokenType::INT32_LITERAL, TokenType::INT64_LITERAL,
+          TokenType::UINT8_LITERAL, TokenType::UINT16_LITERAL,
+          TokenType::UINT32_LITERAL, TokenType::UINT64_LITERAL,
+          TokenType::FLOAT32_LITERAL, TokenType::FLOAT64_LITERAL}) {
+      terminal_map.by_type[static_cast<uint8_t>(type)] = literal_id;
+    }
+    terminal_map.by_type[static_cast<uint8_t>(TokenType::IDENTIFIER)] =
+        identifier_id;
+    terminal_map.by_type[static_cast<uint8_t>(TokenType::ENDOF)] = ENDOF;
+  }
+
+  SymbolId SymbolTable::idOf(const Symbol& symbol) const {
+    switch (symbol.type) {
+      case Symbol::Type::KW_TERMINAL:
+        return terminal_map.keywords[static_cast<uint8_t>(
+            symbol.terminal.keyword)];
+      case Symbol::Type::PUN_TERMINAL:
+        return terminal_map.punctuators[static_cast<uint8_t>(
+            symbol.terminal.punctuator)];
+      case Symbol::Type::NON_TERMINAL:
+        return nonterminal_ids[static_cast<uint8_t>(symbol.nonterminal)];
+      case Symbol::Type::LIT_TERMINAL:
+        return literal_id;
+      case Symbol::Type::ID_TERMINAL:
+        return identifier_id;
+      case Symbol::Type::ERR_TERMINAL:
+        return error_id;
+      case Symbol::Type::EOF_TERMINAL:
+        return ENDOF;
+      default:
+        return NONE;
+    }
+  }
+
+  SymbolId* SymbolTable::slotOf(const Symbol& symbol) {
+    switch (symbol.type) {
+      case Symbol::Type::KW_TERMINAL:
+        return &terminal_map.keywords[static_cast<uint8_t>(
+            symbol.terminal.keyword)];
+      case Symbol::Type::PUN_TERMINAL:
+        return &terminal_map.punctuators[static_cast<uint8_t>(
+            symbol.terminal.punctuator)];
+      case Symbol::Type::NON_TERMINAL:
+        return &nonterminal_ids[static_cast<uint8_t>(symbol.nonterminal)];
+      case Symbol::Type::LIT_TERMINAL:
+        return &literal_id;
+      case Symbol::Type::ID_TERMINAL:
+        return &identifier_id;
+      case Symbol::Type::ERR_TERMINAL:
+        return &error_id;
+      default:
+        return nullptr;
+    }
+  }
+
+  void SymbolTable::add(const Symbol& symbol) {
+    // The end of file marker has a fixed id and no slot of its own
+    if (symbol.type == Symbol::Type::EOF_TERMINAL) {
+      if (symbols.empty()) symbols.push_back(symbol);
+      return;
+    }
+
+    SymbolId* slot = slotOf(symbol);
+    if (!slot || *slot != NONE) return;
+
+    *slot = static_cast<SymbolId>(symbols.size());
+    symbols.push_back(symbol);
+  }
+}  // namespace compiler
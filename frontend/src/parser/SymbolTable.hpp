@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Grammar.hpp"
+#include "Symbols.hpp"
+#include "tokens/TerminalMap.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief Dense number of a grammar symbol.
+   *
+   *        Terminals are numbered first, starting at 0 with the end-of-file
+   *        marker, followed by every non-terminal. Tables can then be plain
+   *        arrays indexed by id instead of hash maps keyed by Symbol.
+   */
+  using SymbolId = uint16_t;
+
+  /**
+   * @brief Numbers every terminal and non-terminal of a grammar.
+   *
+   *        Ids follow the order in which symbols first appear in the
+   *        grammar, so equal grammars always get equal numberings.
+   */
+  class SymbolTable final {
+  public:
+    static constexpr SymbolId NONE = static_cast<SymbolId>(-1);
+    static constexpr SymbolId ENDOF = 0;
+
+    static_assert(NONE == NO_TERMINAL, "unmapped tokens must read as NONE");
+
+  public:
+    /**
+     * @brief Construct a new Symbol Table object
+     *
+     * @param grammar
+     */
+    explicit SymbolTable(const Grammar& grammar) noexcept;
+
+    /**
+     * @brief Returns the id of a symbol, or NONE if the grammar never uses
+     *        it.
+     *
+     * @param symbol
+     * @return SymbolId
+     */
+    SymbolId idOf(const Symbol& symbol) const;
+
+    /**
+     * @brief Returns the id of a non-terminal, or NONE if the grammar never
+     *        uses it.
+     *
+     * @param nonterminal
+     * @return SymbolId
+     */
+    SymbolId idOf(NonTerminal nonterminal) const {
+      return nonterminal_ids[static_cast<uint8_t>(nonterminal)];
+    }
+
+    /**
+     * @brief Maps a token straight to the id of the terminal it represents.
+     *        Returns NONE if the grammar has no such terminal.
+     *
+     * @param token
+     * @return SymbolId
+     */
+    SymbolId terminalOf(const Token& token) const {
+      return terminal_map.terminalOf(token);
+    }
+
+    /**
+     * @brief Returns the token to terminal id mapping of the grammar, to be
+     *        handed to the lexer.
+     *
+     * @return const TerminalMap&
+     */
+    const TerminalMap& terminalMap() const { return terminal_map; }
+
+    /**
+     * @brief Returns the id of the `error` pseudo-terminal, or NONE if the
+     *        grammar has no error productions.
+     *
+     * @return SymbolId
+     */
+    SymbolId errorId() const { return error_id; }
+
+    /**
+     * @brief Returns the symbol that owns an id.
+     *
+     * @param id
+     * @return const Symbol&
+     */
+    const Symbol& symbolOf(SymbolId id) const { return symbols[id]; }
+
+    bool isTerminal(SymbolId id) const { return id < terminal_count; }
+
+    size_t size() const { return symbols.size(); }
+    size_t terminalCount() const { return terminal_count; }
+    size_t nonTerminalCount() const { return symbols.size() - terminal_count; }
+
+  private:
+    std::vector<Symbol> symbols;
+    size_t terminal_count;
+
+    // Direct lookup arrays, every kind of symbol fits in a byte. The
+    // keyword and punctuator rows live in the terminal map.
+    TerminalMap terminal_map;
+    std::array<SymbolId, 256> nonterminal_ids;
+    SymbolId literal_id;
+    SymbolId identifier_id;
+    SymbolId error_id;
+
+  private:
+    SymbolId* slotOf(const Symbol& symbol);
+    void add(const Symbol& symbol);
+  };
+}  // namespace compiler
@@ -31,79 +31,87 @@ namespace compiler {
     // FACT → ( EXPR )
     //      | number
 
+    // STMT_LIST → STMT STMT_LIST
+    //           | STMT
+
+    // STMT → EXPR ;
+    //      | error ;
+
     START,
     EXPR,
     TERM,
     FACT,
+    STMT_LIST,
+    STMT,
 
     // https://www.lysator.liu.se/c/ANSI-C-grammar-y.html#direct-declarator
-    // EXPR,
-    // PRIMARY_EXPR,
-    // POSTFIX_EXPR,
-    // ARG_EXPR_LIST,
-    // ASSIGNMENT_EXPR,
-    // UNARY_EXPR,
+    // Expressions, see ast/CExprGrammar.hpp
+    PRIMARY_EXPR,
+    POSTFIX_EXPR,
+    ASSIGNMENT_EXPR,
+    UNARY_EXPR,
+    CAST_EXPR,
+    MULTIPLICATIVE_EXPR,
+    ADDITIVE_EXPR,
+    SHIFT_EXPR,
+    RELATIONAL_EXPR,
+    EQUALITY_EXPR,
+    AND_EXPR,
+    EXCLUSIVE_OR_EXPR,
+    INCLUSIVE_OR_EXPR,
+    LOGICAL_AND_EXPR,
+    LOGICAL_OR_EXPR,
+    CONDITIONAL_EXPR,
+
+    // C² declarations read like expressions, `a * b;` declares a pointer
+    // to `a` named `b` or multiplies two variables.
+    TYPE_NAME,
+    DECLARATION,
+    DECLARATOR,
+
+    // The rest of the ANSI C grammar, see ast/CGrammar.hpp
+    ARG_EXPR_LIST,
+    CONSTANT_EXPR,
+    DECLARATION_SPECIFIERS,
+    INIT_DECLARATOR_LIST,
+    INIT_DECLARATOR,
+    STORAGE_CLASS_SPECIFIER,
+    TYPE_SPECIFIER,
+    TYPE_QUALIFIER,
+    INITIALIZER,
+    INITIALIZER_LIST,
+    STRUCT_OR_UNION_SPECIFIER,
+    STRUCT_OR_UNION,
+    STRUCT_DECLARATION_LIST,
+    STRUCT_DECLARATION,
+    SPECIFIER_QUALIFIER_LIST,
+    STRUCT_DECLARATOR_LIST,
+    STRUCT_DECLARATOR,
+    ENUM_SPECIFIER,
+    ENUMERATOR_LIST,
+    ENUMERATOR,
+    TYPE_QUALIFIER_LIST,
+    POINTER,
+    DIRECT_DECLARATOR,
+    PARAMETER_TYPE_LIST,
+    PARAMETER_LIST,
+    PARAMETER_DECLARATION,
+    ABSTRACT_DECLARATOR,
+    DIRECT_ABSTRACT_DECLARATOR,
+    LABELED_STMT,
+    COMPOUND_STMT,
+    EXPRESSION_STMT,
+    SELECTION_STMT,
+    ITERATION_STMT,
+    JUMP_STMT,
+    DECLARATION_LIST,
+    EXTERNAL_DECLARATION,
+    TRANSLATION_UNIT,
+    FUNCTION_DEFINITION,
+
     // UNARY_OP,
-    // CAST_EXPR,
-    // TYPE_NAME,
-    // MULTIPLICATIVE_EXPR,
-    // ADDITIVE_EXPR,
-    // SHIFT_EXPR,
-    // RELATIONAL_EXPR,
-    // EQUALITY_EXPR,
-    // AND_EXPR,
-    // EXCLUSIVE_OR_EXPR,
-    // INCLUSIVE_OR_EXPR,
-    // LOGICAL_AND_EXPR,
-    // LOGICAL_OR_EXPR,
-    // CONDITIONAL_EXPR,
     // ASSIGNMENT_OP,
-    // CONSTANT_EXPR,
-    // DECLARATION_SPECIFIERS,
-    // INIT_DECLARATOR_LIST,
-    // DECLARATION,
-    // STORAGE_CLASS_SPECIFIER,
-    // TYPE_SPECIFIER,
-    // TYPE_QUALIFIER,
-    // DECL_SPECIFIERS,
-    // INIT_DECL,
-    // INIT_DECL_LIST,
-    // DECLARATOR,
-    // INITIALIZER,
-    // STRUCT_OR_UNION_SPECIFIER,
-    // ENUM_SPECIFIER,
-    // STRUCT_OR_UNION,
-    // STRUCT_DECLARATION_LIST,
-    // STRUCT_DECLARATION,
-    // SPECIFIER_QUALIFIER_LIST,
-    // STRUCT_DECLARATOR_LIST,
-    // STRUCT_DECLARATOR,
-    // CONSTANT_EXPRESSION,
-    // ENUMERATOR_LIST,
-    // ENUMERATOR,
-    // TYPE_QUALIFIER_LIST,
-    // POINTER,
-    // DIRECT_DECLARATOR,
-    // PARAMETER_TYPE_LIST,
     // IDENTIFIER_LIST,
-    // PARAMETER_LIST,
-    // PARAMETER_DECLARATION,
-    // ABSTRACT_DECLARATOR,
-    // DIRECT_ABSTRACT_DECLARATOR,
-    // ASSIGNMENT_EXPRESSION,
-    // INITIALIZER_LIST,
-    // LABELED_STATEMENT,
-    // STATEMENT,
-    // COMPOUND_STATEMENT,
-    // EXPRESSION_STATEMENT,
-    // SELECTION_STATEMENT,
-    // ITERATION_STATEMENT,
-    // JUMP_STATEMENT,
-    // STATEMENT_LIST,
-    // DECLARATION_LIST,
-    // EXTERNAL_DECLARATION,
-    // TRANSLATION_UNIT,
-    // FUNCTION_DEFINITION,
   };
 
   /**
@@ -138,6 +146,7 @@ namespace compiler {
       PUN_TERMINAL,
       EOF_TERMINAL,
       NON_TERMINAL,
+      ERR_TERMINAL,
       COUNT
     } type;
     union {
@@ -161,34 +170,91 @@ namespace compiler {
      *
      * @return Symbol
      */
-    static Symbol endOF() {
+    static constexpr Symbol endOF() {
       Symbol sym;
       sym.type = Type::EOF_TERMINAL;
       sym.terminal.eof = 2;
       return sym;
     }
 
-    static Symbol start() {
+    static constexpr Symbol start() {
       Symbol sym;
       sym.type = Type::NON_TERMINAL;
       sym.nonterminal = NonTerminal::START;
       return sym;
     }
 
-    static Symbol literal() {
+    static constexpr Symbol literal() {
       Symbol sym;
       sym.type = Type::LIT_TERMINAL;
       sym.terminal.eof = 1;
       return sym;
     }
 
-    static Symbol identifier() {
+    static constexpr Symbol identifier() {
       Symbol sym;
       sym.type = Type::ID_TERMINAL;
       sym.terminal.eof = 0;
       return sym;
     }
 
+    /**
+     * @brief The `error` pseudo-terminal. No token ever maps to it, the
+     *        parser shifts it itself while recovering from a syntax error,
+     *        so rules like `STMT → error ;` say where parsing may resume.
+     *
+     * @return Symbol
+     */
+    static constexpr Symbol error() {
+      Symbol sym;
+      sym.type = Type::ERR_TERMINAL;
+      sym.terminal.eof = 3;
+      return sym;
+    }
+
+    /**
+     * @brief Builds the terminal symbol that represents a token. Every
+     *        literal kind collapses into the same literal terminal.
+     *
+     * @param token
+     * @return Symbol with an UNKNOWN type if the token has no terminal
+     */
+    static Symbol fromToken(const Token& token) {
+      Symbol sym = {};
+      switch (token.type) {
+        case TokenType::CHAR_LITERAL:
+        case TokenType::BOOL_LITERAL:
+        case TokenType::STR8_LITERAL:
+        case TokenType::STR16_LITERAL:
+        case TokenType::INT8_LITERAL:
+        case TokenType::INT16_LITERAL:
+        case TokenType::INT32_LITERAL:
+        case TokenType::INT64_LITERAL:
+        case TokenType::UINT8_LITERAL:
+        case TokenType::UINT16_LITERAL:
+        case TokenType::UINT32_LITERAL:
+        case TokenType::UINT64_LITERAL:
+        case TokenType::FLOAT32_LITERAL:
+        case TokenType::FLOAT64_LITERAL:
+          return Symbol::literal();
+        case TokenType::IDENTIFIER:
+          return Symbol::identifier();
+        case TokenType::ENDOF:
+          return Symbol::endOF();
+        case TokenType::KEYWORD:
+          sym.type = Symbol::Type::KW_TERMINAL;
+          sym.terminal.keyword = token.value.keyword;
+          return sym;
+        case TokenType::PUNCTUATOR:
+          sym.type = Symbol::Type::PUN_TERMINAL;
+          sym.terminal.punctuator = token.value.punctuator;
+          return sym;
+        default:
+          sym.type = Symbol::Type::UNKNOWN;
+          return sym;
+      }
+    }
+
     std::string toString() const {
       std::ostringstream oss;
 
@@ -208,6 +274,9 @@ namespace compiler {
         case Symbol::Type::ID_TERMINAL:
           oss << "<ID>";
           break;
+        case Symbol::Type::ERR_TERMINAL:
+          oss << "<ERROR>";
+          break;
         default:
           oss << "<ENDOF>";
       }
@@ -216,23 +285,6 @@ namespace compiler {
     }
   };
 
-  /**
-   * @brief Represents a single production rule in a context-free grammar.
-   *
-   *        Each rule has a left-hand side (a non-terminal) and a right-hand
-   *        side, which is a sequence of symbols (terminals or non-terminals).
-   */
-  struct Rule {
-    NonTerminal lhs;
-    std::initializer_list<Symbol> rhs;
-  };
-
-  /**
-   * @brief A collection of grammar rules representing a full grammar.
-   *
-   */
-  using Grammar = std::vector<Rule>;
-
   /**
    * @brief Hash function for Symbol, allowing use in hash-based containers.
    *
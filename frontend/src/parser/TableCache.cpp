@@ -0,0 +1,90 @@
+#include "TableCache.hpp"
+
+namespace compiler {
+
+  TableCache& TableCache::instance() {
+    static TableCache cache;
+    return cache;
+  }
+
+  const ActionTable& TableCache::tableFor(const Grammar& grammar,
+                                         bool skip_unit_rules) {
+    return lookup(grammar, skip_unit_rules, {});
+  }
+
+  const ActionTable& TableCache::tableFor(
+      const Grammar& grammar, const ActionTable::Prebuilt& prebuilt) {
+    return lookup(grammar, false, prebuilt);
+  }
+
+  const ActionTable& TableCache::lookup(
+      const Grammar& grammar, bool skip_unit_rules,
+      const ActionTable::Prebuilt& prebuilt) {
+    TableCache& cache = instance();
+    const size_t hash = GrammarHash{}(grammar);
+
+    // Fast path, the grammar was already requested before. Only a shared
+    // lock is taken so parsers on different threads never serialize here.
+    Entry* entry = nullptr;
+    {
+      std::shared_lock lock(cache.mutex);
+      entry = cache.find(grammar, hash, skip_unit_rules,
+                         prebuilt.actions.data());
+    }
+
+    // Slow path, register a new entry. Another thread may have registered
+    // the same grammar between both locks, so look it up again.
+    if (!entry) {
+      std::unique_lock lock(cache.mutex);
+      entry = cache.find(grammar, hash, skip_unit_rules,
+                         prebuilt.actions.data());
+      if (!entry) {
+        Bucket& bucket = cache.entries[hash];
+        bucket.push_back(
+            std::make_unique<Entry>(grammar, skip_unit_rules, prebuilt));
+        entry = bucket.back().get();
+      }
+    }
+
+    // Build the table outside of the cache lock. Threads asking for the
+    // same grammar wait on the entry, other grammars are not blocked.
+    std::call_once(entry->built, [entry] {
+      if (entry->prebuilt.actions.empty()) {
+        entry->table.emplace(entry->grammar, 0, entry->skip_unit_rules);
+      } else {
+        entry->table.emplace(entry->grammar, entry->prebuilt);
+      }
+    });
+    return *entry->table;
+  }
+
+  size_t TableCache::size() {
+    TableCache& cache = instance();
+    std::shared_lock lock(cache.mutex);
+
+    size_t count = 0;
+    for (const auto& [hash, bucket] : cache.entries) {
+      count += bucket.size();
+    }
+    return count;
+  }
+
+  TableCache::Entry* TableCache::find(const Grammar& grammar, size_t hash,
+                                      bool skip_unit_rules,
+                                      const Action* actions) const {
+    auto it = entries.find(hash);
+    if (it == entries.end()) {
+      return nullptr;
+    }
+
+    // Different grammars may share a hash, compare the rules to be sure.
+    for (const auto& entry : it->second) {
+      if (entry->skip_unit_rules == skip_unit_rules &&
+          entry->prebuilt.actions.data() == actions &&
+          entry->grammar == grammar) {
+        return entry.get();
+      }
+    }
+    return nullptr;
+  }
+}  // namespace compiler
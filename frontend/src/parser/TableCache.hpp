@@ -0,0 +1,106 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "ActionTable.hpp"
+#include "Grammar.hpp"
+#include "Symbols.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief Process-wide cache of immutable parse tables.
+   *
+   *        Building the LR automaton is by far the most expensive part of
+   *        setting up a Parser, and its result only depends on the grammar.
+   *        The cache keys every table by the content hash of its grammar, so
+   *        every Parser (on any thread) that uses an equal grammar shares the
+   *        same table by reference. Each table is built lazily, exactly once,
+   *        by whichever thread asks for it first.
+   *
+   *        Tables live until the end of the process and are never mutated
+   *        after being built, which is what makes sharing them safe.
+   */
+  class TableCache final {
+  public:
+    /**
+     * @brief Returns the shared table for the given grammar, building it if
+     *        this is the first time the grammar is requested.
+     *
+     *        Once a grammar has been built, this call does not allocate.
+     *
+     *        Tables keep their unit rules unless asked to skip them, which
+     *        trades larger tables for fewer reductions.
+     *
+     * @param grammar
+     * @param skip_unit_rules
+     * @return const ActionTable&
+     */
+    static const ActionTable& tableFor(const Grammar& grammar,
+                                       bool skip_unit_rules = false);
+
+    /**
+     * @brief Returns the shared table for a grammar whose automaton was
+     *        built at compile time, see StaticTable. The first call makes
+     *        the table a view over the given arrays instead of building it.
+     *        Such tables have no conflicts recorded, so they are kept apart
+     *        from the ones tableFor(grammar) builds.
+     *
+     * @param grammar
+     * @param prebuilt  Arrays of the static table, they must live as long
+     *                  as the process.
+     * @return const ActionTable&
+     */
+    static const ActionTable& tableFor(const Grammar& grammar,
+                                       const ActionTable::Prebuilt& prebuilt);
+
+    /**
+     * @brief Returns the number of distinct tables held by the cache.
+     *
+     * @return size_t
+     */
+    static size_t size();
+
+  private:
+    /**
+     * @brief One cached table. The entry owns a copy of the grammar so the
+     *        table never references memory owned by a caller.
+     *
+     */
+    struct Entry {
+      Grammar grammar;
+      bool skip_unit_rules;
+      ActionTable::Prebuilt prebuilt;  // Arrays to view, empty to build
+      std::once_flag built;
+      std::optional<ActionTable> table;
+
+      explicit Entry(const Grammar& grammar, bool skip_unit_rules,
+                     const ActionTable::Prebuilt& prebuilt)
+          : grammar(grammar),
+            skip_unit_rules(skip_unit_rules),
+            prebuilt(prebuilt) {}
+    };
+
+    using Bucket = std::vector<std::unique_ptr<Entry>>;
+
+  private:
+    static TableCache& instance();
+
+    static const ActionTable& lookup(const Grammar& grammar,
+                                     bool skip_unit_rules,
+                                     const ActionTable::Prebuilt& prebuilt);
+
+    Entry* find(const Grammar& grammar, size_t hash, bool skip_unit_rules,
+                const Action* actions) const;
+
+  private:
+    mutable std::shared_mutex mutex;
+    std::unordered_map<size_t, Bucket> entries;
+  };
+}  // namespace compiler
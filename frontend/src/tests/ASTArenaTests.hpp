@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+
+#include "ast/ASTArena.hpp"
+#include "ast/StorageAST.hpp"
+
+using namespace compiler;
+
+void testASTArena() {
+  ASTArena arena(256);
+  assert(arena.blockCount() == 0 && arena.reserved() == 0);
+
+  // Bump allocations honour their alignment and pack one after the other
+  char* c = static_cast<char*>(arena.bump(1, 1));
+  uint64_t* wide = static_cast<uint64_t*>(arena.bump(8, 8));
+  assert(reinterpret_cast<uintptr_t>(wide) % alignof(uint64_t) == 0);
+  assert(reinterpret_cast<char*>(wide) - c < 16);
+  void* aligned = arena.bump(32, 64);
+  assert(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+  assert(arena.used() == 1 + 8 + 32 && arena.blockCount() == 1);
+
+  const IDAST* id = arena.make<IDAST>(42u, Identifier{1, 3});
+  assert(id->uid == 42 && id->id.end == 3);
+
+  // Blocks double in size as the region grows, a large allocation gets a
+  // block of its own
+  for (size_t i = 0; i < 100; ++i) arena.make<ExprAST>();
+  assert(arena.blockCount() > 1);
+  const size_t before = arena.reserved();
+  arena.bump(100000, 8);
+  assert(arena.reserved() - before >= 100000);
+
+  // A reset keeps the largest block and starts over at its beginning,
+  // even when smaller blocks came after it
+  arena.bump(16, 16);
+  const size_t blocks = arena.blockCount();
+  arena.reset();
+  assert(arena.blockCount() == 1 && blocks > 1 && arena.used() == 0);
+  assert(arena.reserved() >= 100000);
+  arena.bump(100000, 8);
+  assert(arena.blockCount() == 1);
+  arena.reset();
+  void* first = arena.bump(16, 16);
+  arena.reset();
+  assert(arena.bump(16, 16) == first);
+
+  arena.release();
+  assert(arena.blockCount() == 0 && arena.reserved() == 0);
+
+  // As a memory resource it backs the AST storage of a unit
+  {
+    ASTStorage storage(&arena);
+    storage.reserve(64);
+    const size_t reserved = arena.used();
+    assert(reserved >= 64 * sizeof(ExprAST));
+
+    // Reserved kinds take nothing more from the region as they fill up
+    Handle<ExprAST> leaf = storage.push(ExprAST{ExprAST::Type::ID, 0});
+    storage.push(UnaryExprAST{leaf, Punctuator::PLUS_PLUS});
+    assert(arena.used() == reserved);
+
+    std::pmr::vector<Index> order(&arena);
+    order.push_back(leaf.index);
+    assert(order.get_allocator().resource() == &arena);
+  }
+  arena.reset();
+  assert(arena.used() == 0);
+
+  std::cout << "AST arena test passed!\n";
+}
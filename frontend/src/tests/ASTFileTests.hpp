@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <span>
+#include <string>
+
+#include "ast/ASTFile.hpp"
+#include "ast/CExprGrammar.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+using namespace compiler;
+
+// Reads a whole file
+inline std::string readBytes(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), {}};
+}
+
+// Fills every byte of the nodes with garbage, padding included, and then
+// sets their members back
+template <typename Node, typename Assign>
+void scribblePadding(std::pmr::vector<Node>& nodes, Assign assign) {
+  for (Node& node : nodes) {
+    const Node members = node;
+    std::memset(static_cast<void*>(&node), 0xAB, sizeof(Node));
+    assign(node, members);
+  }
+}
+
+void testASTFile() {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "frontend_test.ast").string();
+  const std::string source = "count * \"ab\" + (count - 12) * \"cde\" + size";
+
+  const Grammar grammar = C_EXPR_GRAMMAR.toGrammar();
+  Lexer lexer("file.c", source);
+  TokenStream stream = TokenStream(lexer, 16);
+  Parser parser = Parser(stream, grammar);
+  auto result = parser.parse();
+  assert(result && result->errors.empty());
+  const ASTStorage& storage = result->storage;
+
+  assert(ASTFile::write(path, storage, result->root, source));
+
+  // The nodes are those of the storage, in place in the mapping
+  {
+    ASTFile::OpenResult file = ASTFile::open(path);
+    assert(file);
+    assert(file->root() == result->root);
+    assert(file->nodes<ExprAST>().size() == storage.exprs.size());
+    for (size_t i = 0; i < storage.exprs.size(); ++i) {
+      assert(file->nodes<ExprAST>()[i].type == storage.exprs[i].type);
+      assert(file->nodes<ExprAST>()[i].index == storage.exprs[i].index);
+    }
+    assert(file->nodes<BinaryExprAST>().size() ==
+           storage.binary_exprs.size());
+    for (size_t i = 0; i < storage.binary_exprs.size(); ++i) {
+      const BinaryExprAST& node = file->nodes<BinaryExprAST>()[i];
+      assert(node.left.index == storage.binary_exprs[i].left.index);
+      assert(node.right.index == storage.binary_exprs[i].right.index);
+      assert(node.op == storage.binary_exprs[i].op);
+    }
+    assert(file->nodes<StmtAST>().empty());
+    assert(reinterpret_cast<uintptr_t>(file->nodes<ExprAST>().data()) %
+               ASTFile::SECTION_ALIGNMENT ==
+           0);
+
+    const Handle<ExprAST> root{file->root()};
+    assert((*file)[root].type == ExprAST::Type::BINARY_EXPR);
+
+    // Identifiers and strings resolve without the source. Names are
+    // interned, both uses of "count" share one
+    const std::span<const IDAST> ids = file->nodes<IDAST>();
+    assert(ids.size() == 3);
+    assert(file->nameOf(ids[0]) == "count");
+    assert(file->nameOf(ids[1]) == "count");
+    assert(file->nameOf(ids[2]) == "size");
+    assert(ids[0].uid == ids[1].uid && ids[0].uid != ids[2].uid);
+    assert(file->nameOf(IDAST{.uid = 3, .id = {}}).empty());
+
+    std::string strings;
+    for (const LiteralAST& literal : file->nodes<LiteralAST>()) {
+      if (literal.type == TokenType::STR8_LITERAL) {
+        strings += file->stringOf(literal.literal.string);
+      }
+    }
+    assert(strings.find("ab") != std::string::npos);
+    assert(strings.find("cde") != std::string::npos);
+    assert(strings.size() < source.size());
+
+    assert(file->matches(source));
+    assert(!file->matches(source + " "));
+    assert(!file->matches("count * \"ab\" + (count - 13) * \"cde\" + size"));
+
+    // Moving the file moves its mapping
+    ASTFile moved = std::move(*file);
+    assert(moved.nameOf(moved.nodes<IDAST>()[1]) == "count");
+  }
+
+  // Equal trees give equal files, whatever their padding bytes hold
+  {
+    const std::string first = readBytes(path);
+    assert(ASTFile::write(path, storage, result->root, source));
+    assert(readBytes(path) == first);
+
+    ASTStorage scribbled = storage;
+    scribblePadding(scribbled.ids, [](IDAST& node, const IDAST& members) {
+      node.uid = members.uid;
+      node.id = members.id;
+    });
+    scribblePadding(scribbled.literals,
+                    [](LiteralAST& node, const LiteralAST& members) {
+                      node.literal = members.literal;
+                      node.type = members.type;
+                    });
+    scribblePadding(scribbled.exprs,
+                    [](ExprAST& node, const ExprAST& members) {
+                      node.type = members.type;
+                      node.index = members.index;
+                    });
+    scribblePadding(scribbled.binary_exprs,
+                    [](BinaryExprAST& node, const BinaryExprAST& members) {
+                      node.left = members.left;
+                      node.right = members.right;
+                      node.op = members.op;
+                    });
+    assert(ASTFile::write(path, scribbled, result->root, source));
+    assert(readBytes(path) == first);
+  }
+
+  // Identifiers whose uids collide keep their own names
+  {
+    const std::string names = "alpha beta";
+    ASTStorage colliding;
+    colliding.ids.push_back({.uid = 7, .id = {0, 5}});
+    colliding.ids.push_back({.uid = 7, .id = {6, 10}});
+    assert(ASTFile::write(path, colliding, 0, names));
+
+    ASTFile::OpenResult file = ASTFile::open(path);
+    assert(file);
+    assert(file->nameOf(file->nodes<IDAST>()[0]) == "alpha");
+    assert(file->nameOf(file->nodes<IDAST>()[1]) == "beta");
+  }
+
+  // Files that cannot be used as they are are rejected
+  auto rewrite = [&](size_t offset, uint32_t value) {
+    std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+    out.seekp(static_cast<std::streamoff>(offset));
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+
+  rewrite(8, ASTFile::VERSION + 1);
+  assert(ASTFile::open(path).error().type ==
+         ASTFileErrorType::VERSION_MISMATCH);
+
+  assert(ASTFile::write(path, storage, result->root, source));
+  rewrite(0, 0);
+  assert(ASTFile::open(path).error().type ==
+         ASTFileErrorType::NOT_AN_AST_FILE);
+
+  assert(ASTFile::write(path, storage, result->root, source));
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+  assert(ASTFile::open(path).error().type == ASTFileErrorType::CORRUPT);
+
+  std::filesystem::remove(path);
+  assert(ASTFile::open(path).error().type == ASTFileErrorType::IO_ERROR);
+
+  std::cout << "AST file test passed!\n";
+}
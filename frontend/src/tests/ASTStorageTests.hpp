@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "ast/CExprGrammar.hpp"
+#include "ast/StorageAST.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+using namespace compiler;
+
+// Handles of one kind never stand in for another, nor for a plain index
+static_assert(!std::is_convertible_v<Handle<ExprAST>, Handle<StmtAST>>);
+static_assert(!std::is_convertible_v<Handle<ExprAST>, size_t>);
+
+void testASTStorage() {
+  ASTStorage storage;
+
+  // Each kind is numbered on its own
+  Handle<ExprAST> left = storage.push(ExprAST{ExprAST::Type::LITERAL, 0});
+  Handle<ExprAST> right = storage.push(ExprAST{ExprAST::Type::LITERAL, 1});
+  Handle<BinaryExprAST> sum =
+      storage.push(BinaryExprAST{left, right, Punctuator::PLUS});
+  assert(left.index == 0 && right.index == 1 && sum.index == 0);
+  assert(storage[sum].right == right);
+  assert(storage[storage[sum].left].index == 0);
+  assert(!Handle<StmtAST>{}.valid());
+  assert(storage.nodeCount() == 3);
+
+  // Storage is reserved for the share of each kind C code has, denser
+  // programs grow the vectors they need more of
+  std::string source = "1";
+  for (size_t i = 0; i < 200; ++i) {
+    source = "(" + source + " ? x : y) * -" + std::to_string(i);
+  }
+  const Grammar grammar = C_EXPR_GRAMMAR.toGrammar();
+  Lexer lexer("storage.c", source);
+  TokenStream stream = TokenStream(lexer, 16);
+  Parser parser = Parser(stream, grammar);
+  Parser::ProgramResult result = parser.parseIncremental();
+  assert(result && (*result)->errors.empty());
+
+  const ASTStorage& parsed = (*result)->storage;
+  const size_t tokens = 1 + 200 * 9 + 1;
+  assert(parsed.ids.capacity() == tokens / 3);
+  assert(parsed.ids.size() == 400);
+  assert(parsed.binary_exprs.capacity() == tokens / 6);
+  assert(parsed.conditional_exprs.size() == 200);
+  assert(parsed.conditional_exprs.capacity() >= 200);
+
+  // Clearing keeps every vector's memory
+  const ExprAST* exprs = parsed.exprs.data();
+  storage.clear();
+  assert(storage.nodeCount() == 0 && storage.exprs.capacity() >= 2);
+  parser.reset("storage.c", source);
+  result = parser.parseIncremental();
+  assert(result && (*result)->storage.exprs.data() == exprs);
+
+  std::cout << "AST storage test passed!\n";
+}
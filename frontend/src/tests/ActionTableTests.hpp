@@ -2,9 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
-#include <iomanip>
 #include <iostream>
-#include <sstream>
 #include <stack>
 #include <string>
 #include <string_view>
@@ -71,150 +69,6 @@ static const Symbol ENDOF = [] {
   return end_sym;
 }();
 
-std::string print_symbol(const Symbol& s) {
-  std::ostringstream oss;
-
-  switch (s.type) {
-    case Symbol::Type::NON_TERMINAL:
-      oss << "NT(" << static_cast<int>(s.nonterminal) << ")";
-      break;
-    case Symbol::Type::PUN_TERMINAL:
-      oss << "P('" << PunctuatorHandler::toString(s.terminal.punctuator)
-          << "')";
-      break;
-    case Symbol::Type::KW_TERMINAL:
-      oss << "K('" << KeywordHandler::toString(s.terminal.keyword) << "')";
-      break;
-    case Symbol::Type::LIT_TERMINAL:
-      oss << "L(" << static_cast<int>(s.terminal.literal) << ")";
-      break;
-    case Symbol::Type::ID_TERMINAL:
-      oss << "I(" << static_cast<int>(s.terminal.identifier) << ")";
-      break;
-    default:
-      oss << "ENDOF";
-  }
-
-  return oss.str();
-}
-
-void print_item(const Rule& rule, const ActionTable::Item& item) {
-  std::cout << static_cast<int>(rule.lhs) << " -> ";
-  size_t i = 0;
-  for (auto it = rule.rhs.begin(); it != rule.rhs.end(); ++it, ++i) {
-    if (i == item.dot_position) std::cout << ". ";
-    std::cout << print_symbol(*it);
-    std::cout << " ";
-  }
-  if (item.dot_position == rule.rhs.size()) std::cout << "·";
-  std::cout << "\n";
-}
-
-void printItemSets(const std::vector<ActionTable::ItemSet>& states,
-                   const std::vector<Rule>& grammar) {
-  for (size_t i = 0; i < states.size(); ++i) {
-    std::cout << "State " << i << ":\n";
-    for (const auto& item : states[i]) {
-      const Rule& rule = grammar[item.rule_index];
-      std::cout << "  " << static_cast<uint32_t>(rule.lhs) << " ->";
-
-      size_t pos = 0;
-      for (const auto& sym : rule.rhs) {
-        if (pos == item.dot_position) std::cout << " .";
-        std::cout << " " << print_symbol(sym);
-        ++pos;
-      }
-
-      if (item.dot_position == rule.rhs.size()) std::cout << " .";
-
-      std::cout << "\n";
-    }
-    std::cout << "\n";
-  }
-}
-
-void printPrettyActionAndGotoTables(
-    const ActionTable& builder,
-    const std::vector<ActionTable::ItemSet>& states) {
-  std::vector<Symbol> terminalSymbols;
-  std::vector<Symbol> nonTerminalSymbols;
-
-  // Collect terminal and non-terminal symbols
-  for (const auto& [key, action] : builder.action_table) {
-    const Symbol& symbol = key.second;
-    if (std::find(terminalSymbols.begin(), terminalSymbols.end(), symbol) ==
-        terminalSymbols.end())
-      terminalSymbols.push_back(symbol);
-  }
-
-  for (const auto& [key, state] : builder.goto_table) {
-    const Symbol& symbol = key.second;
-    if (symbol.type == Symbol::Type::NON_TERMINAL) {
-      if (std::find(nonTerminalSymbols.begin(), nonTerminalSymbols.end(),
-                    symbol) == nonTerminalSymbols.end())
-        nonTerminalSymbols.push_back(symbol);
-    }
-  }
-
-  std::sort(terminalSymbols.begin(), terminalSymbols.end(),
-            [](const Symbol& a, const Symbol& b) {
-              return (int)a.type < (int)b.type;
-            });
-  std::sort(nonTerminalSymbols.begin(), nonTerminalSymbols.end(),
-            [](const Symbol& a, const Symbol& b) {
-              return (int)a.nonterminal < (int)b.nonterminal;
-            });
-
-  // === ACTION TABLE HEADER ===
-  std::cout << "\n=== ACTION TABLE ===\n";
-  printf("%-10s|", "");
-  for (const auto& sym : terminalSymbols) {
-    printf(" %-6s |", print_symbol(sym).c_str());
-  }
-  std::cout << "\n";
-
-  for (size_t i = 0; i < states.size(); ++i) {
-    printf("State %-3d |", i);
-    for (const auto& sym : terminalSymbols) {
-      auto it = builder.action_table.find({i, sym});
-      if (it != builder.action_table.end()) {
-        const auto& action = it->second;
-        if (action.type == Action::Type::SHIFT) {
-          printf(" s%-5d |", action.next_state);
-        } else if (action.type == Action::Type::REDUCE) {
-          printf(" r%-5d |", action.rule_index);
-        } else if (action.type == Action::Type::ACCEPT) {
-          printf(" acc%-3s |", "");
-        }
-      } else {
-        printf("  %5s |", "");
-      }
-    }
-    std::cout << "\n";
-  }
-
-  // === GOTO TABLE HEADER ===
-  std::cout << "\n=== GOTO TABLE ===\n";
-  printf("%-10s|", "");
-  for (const auto& sym : nonTerminalSymbols) {
-    printf(" %-6s |", print_symbol(sym).c_str());
-  }
-  std::cout << "\n";
-
-  for (size_t i = 0; i < states.size(); ++i) {
-    printf("State %-3zu |", i);
-    for (const auto& sym : nonTerminalSymbols) {
-      auto it = builder.goto_table.find({i, sym});
-      if (it != builder.goto_table.end()) {
-        printf(" %-6d |", it->second);
-      } else {
-        printf(" %-6s |", "");
-      }
-    }
-    std::cout << "\n";
-  }
-}
-
 bool runTest(ActionTable& table, Grammar& grammar,
              const std::vector<Symbol>& input, bool shouldAccept) {
   std::stack<ActionTable::State> states;
@@ -229,25 +83,18 @@ bool runTest(ActionTable& table, Grammar& grammar,
     ActionTable::State s = states.top();
     Symbol a = (pos < input.size() ? input[pos] : end_sym);
 
-    auto it = table.action_table.find({s, a});
-    if (it == table.action_table.end()) {
-      std::cout << "Error at state " << s << ", symbol " << print_symbol(a)
-                << "\n";
+    Action act = table.actionFrom(s, table.symbols.idOf(a));
+    if (act.type == Action::ERROR) {
       return shouldAccept == false;
     }
-    Action act = it->second;
     if (act.type == Action::SHIFT) {
       states.push(act.next_state);
       pos++;
     } else if (act.type == Action::REDUCE) {
-      const Rule& r = grammar[act.rule_index];
+      Rule r = grammar[act.rule_index];
       for (size_t i = 0; i < r.rhs.size(); ++i) states.pop();
       ActionTable::State t = states.top();
-
-      Symbol sym;
-      sym.type = Symbol::Type::NON_TERMINAL;
-      sym.nonterminal = r.lhs;
-      states.push(table.goto_table[{t, sym}]);
+      states.push(table.gotoFrom(t, table.lhsOf(act.rule_index)));
     } else if (act.type == Action::ACCEPT) {
       return (pos == input.size()) == shouldAccept;
     }
@@ -256,18 +103,6 @@ bool runTest(ActionTable& table, Grammar& grammar,
 
 void testActionTable() {
   // Define Symbols
-  Symbol START;
-  START.type = Symbol::Type::NON_TERMINAL;
-  START.nonterminal = NonTerminal::START;
-
-  Symbol ENDOF;
-  ENDOF.type = Symbol::Type::EOF_TERMINAL;
-  ENDOF.terminal.eof = 2;
-
-  Symbol ID;
-  ID.type = Symbol::Type::ID_TERMINAL;
-  ID.terminal.literal = 0;
-
   Symbol CONSTANT;
   CONSTANT.type = Symbol::Type::LIT_TERMINAL;
   CONSTANT.terminal.literal = 1;
@@ -302,95 +137,62 @@ void testActionTable() {
 
   // Define Grammar
   Grammar grammar;
-  grammar.push_back({NonTerminal::START, {EXPR}});
-  grammar.push_back({NonTerminal::EXPR, {EXPR, PLUS, TERM}});
-  grammar.push_back({NonTerminal::EXPR, {TERM}});
-  grammar.push_back({NonTerminal::TERM, {TERM, STAR, FACT}});
-  grammar.push_back({NonTerminal::TERM, {FACT}});
-  grammar.push_back({NonTerminal::FACT, {LPAREN, EXPR, RPAREN}});
-  grammar.push_back({NonTerminal::FACT, {CONSTANT}});
+  grammar.add(NonTerminal::START, {EXPR});
+  grammar.add(NonTerminal::EXPR, {EXPR, PLUS, TERM});
+  grammar.add(NonTerminal::EXPR, {TERM});
+  grammar.add(NonTerminal::TERM, {TERM, STAR, FACT});
+  grammar.add(NonTerminal::TERM, {FACT});
+  grammar.add(NonTerminal::FACT, {LPAREN, EXPR, RPAREN});
+  grammar.add(NonTerminal::FACT, {CONSTANT});
+
+  // Every RHS sits back to back in the pool
+  assert(grammar.symbols().size() == 13);
+  assert(grammar.rhsOf(3).data() == grammar.symbols().data() + 5);
+  assert(grammar[3].rhs[2] == FACT);
 
   // Build action table
   ActionTable builder(grammar);
 
-  /**
-   *
-   *
-   *
-   *
-   */
-
-  // Pretty print action table
-  std::cout << std::left << std::setw(8) << "State" << std::setw(20) << "Symbol"
-            << std::setw(10) << "Action" << std::setw(10) << "Value" << "\n";
-  std::cout
-      << "-------------------------------------------------------------\n";
-
-  for (const auto& [key, action] : builder.action_table) {
-    const auto& [state, symbol] = key;
-
-    std::string symbol_str;
-    switch (symbol.type) {
-      case Symbol::Type::NON_TERMINAL:
-        symbol_str =
-            "NT(" + std::to_string(static_cast<int>(symbol.nonterminal)) + ")";
-        break;
-      case Symbol::Type::PUN_TERMINAL:
-        symbol_str = "PUNC(" +
-                     std::string(PunctuatorHandler::toString(
-                         symbol.terminal.punctuator)) +
-                     ")";
-        break;
-      case Symbol::Type::KW_TERMINAL:
-        symbol_str =
-            "KEYW(" +
-            std::string(KeywordHandler::toString(symbol.terminal.keyword)) +
-            ")";
-        break;
-      case Symbol::Type::LIT_TERMINAL:
-        symbol_str = "LITERAL(" + std::to_string(symbol.terminal.literal) + ")";
-        break;
-      case Symbol::Type::EOF_TERMINAL:
-        symbol_str = "ENDOF(" + std::to_string(symbol.terminal.eof) + ")";
-        break;
-      default:
-        symbol_str = "UNKNOWN";
-    }
+  // Rules are grouped by LHS, in grammar order within a group
+  std::span<const uint32_t> term_rules = builder.rulesOf(NonTerminal::TERM);
+  assert(term_rules.size() == 2 && term_rules[0] == 3 && term_rules[1] == 4);
+  assert(builder.rulesOf(NonTerminal::EXPR).size() == 2);
+  assert(builder.rulesOf(NonTerminal::STMT).empty());
+  {
+    Grammar mixed;
+    mixed.add(NonTerminal::START, {EXPR});
+    mixed.add(NonTerminal::EXPR, {TERM});
+    mixed.add(NonTerminal::TERM, {CONSTANT});
+    mixed.add(NonTerminal::EXPR, {EXPR, PLUS, TERM});
+    mixed.add(NonTerminal::TERM, {LPAREN, EXPR, RPAREN});
+    const ActionTable table(mixed, 1);
+    std::span<const uint32_t> exprs = table.rulesOf(NonTerminal::EXPR);
+    std::span<const uint32_t> terms = table.rulesOf(NonTerminal::TERM);
+    assert(exprs.size() == 2 && exprs[0] == 1 && exprs[1] == 3);
+    assert(terms.size() == 2 && terms[0] == 2 && terms[1] == 4);
+  }
 
-    std::string action_str;
-    std::string value_str;
-    switch (action.type) {
-      case Action::SHIFT:
-        action_str = "SHIFT";
-        value_str = std::to_string(action.next_state);
-        break;
-      case Action::REDUCE:
-        action_str = "REDUCE";
-        value_str = std::to_string(action.rule_index);
-        break;
-      case Action::ACCEPT:
-        action_str = "ACCEPT";
-        break;
-      case Action::ERROR:
-        action_str = "ERROR";
-        break;
+  // The automaton must not depend on how many threads built it
+  ActionTable sequential(grammar, 1);
+  ActionTable parallel(grammar, 4);
+  assert(sequential.kernels == parallel.kernels);
+  assert(sequential.transitions == parallel.transitions);
+  assert(std::ranges::equal(sequential.actions, parallel.actions));
+  assert(std::ranges::equal(sequential.gotos, parallel.gotos));
+
+  // Precomputed diagnostics agree with the table rows
+  for (size_t state = 0; state < builder.stateCount(); ++state) {
+    std::vector<SymbolId> expected;
+    for (SymbolId t = 0; t < builder.symbols.terminalCount(); ++t) {
+      if (builder.actionFrom(state, t).type != Action::ERROR) {
+        expected.push_back(t);
+      }
     }
-
-    std::cout << std::left << std::setw(8) << state << std::setw(20)
-              << symbol_str << std::setw(10) << action_str << std::setw(10)
-              << value_str << "\n";
+    auto precomputed = builder.expectedTerminals(state);
+    assert(std::equal(expected.begin(), expected.end(), precomputed.begin(),
+                      precomputed.end()));
   }
 
-  /**
-   *
-   *
-   *
-   *
-   */
-
-  printItemSets(builder.states, grammar);
-  printPrettyActionAndGotoTables(builder, builder.states);
-
   // 1+2*3
   assert(runTest(builder, grammar,
                  {
@@ -426,4 +228,6 @@ void testActionTable() {
                      CONSTANT,
                  },
                  false));
+
+  std::cout << "Action table test passed!\n";
 }
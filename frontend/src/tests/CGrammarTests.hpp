@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+
+#include "ParseEventTests.hpp"
+#include "ast/CGrammar.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/ActionTable.hpp"
+#include "parser/Parser.hpp"
+
+using namespace compiler;
+
+void testCGrammar() {
+  const Grammar grammar = C_GRAMMAR.toGrammar();
+
+  // Every conflict of the full grammar is one the yacc resolution gets
+  // right: the assignment operators, labels and the dangling else
+  const ActionTable table(grammar, 1);
+  for (size_t state = 0; state < table.states.size(); ++state) {
+    for (SymbolId t = 0; t < table.symbols.terminalCount(); ++t) {
+      std::span<const Action> actions = table.conflictsAt(state, t);
+      assert(actions.empty() ||
+             actions.front() == table.actionFrom(state, t));
+    }
+  }
+
+  // Skipping unit rules adds at most one merged state per LR(0) state, and
+  // merged cells keep the conflicts of the cell their action comes from
+  const ActionTable skipping(grammar, 1, /*skip_unit_rules=*/true);
+  assert(skipping.stateCount() > table.stateCount());
+  assert(skipping.stateCount() <= 2 * table.stateCount());
+  assert(skipping.conflictCount() >= table.conflictCount());
+  for (size_t state = 0; state < skipping.stateCount(); ++state) {
+    for (SymbolId t = 0; t < skipping.symbols.terminalCount(); ++t) {
+      std::span<const Action> actions = skipping.conflictsAt(state, t);
+      assert(actions.empty() ||
+             actions.front() == skipping.actionFrom(state, t));
+    }
+  }
+
+  constexpr const char* SOURCE = R"(
+    struct point { int x, y; struct point *next; };
+    enum color { RED, GREEN = 2, BLUE };
+    static const char *names[4];
+    int sum(int count, ...);
+
+    int walk(struct point *p, unsigned long n) {
+      int total = 0;
+      while (p && n--) {
+        if (p->x > 0)
+          total += p->x * (int)sizeof(struct point);
+        else if (p->y)
+          total -= names[p->y % 4][0];
+        else
+          goto done;
+        p = p->next;
+      }
+    done:
+      for (n = 0; n < 4; n++) {
+        switch (n) {
+          case RED: continue;
+          default: break;
+        }
+      }
+      do total = total ? sum(2, total, -1) : ~total; while (0);
+      return total;
+    }
+  )";
+
+  Lexer lexer("c_grammar.c", SOURCE);
+  TokenStream stream = TokenStream(lexer, 16);
+  Parser parser = Parser(stream, grammar);
+  Parser::ProgramResult result = parser.parseInPlace();
+  assert(result && (*result)->errors.empty());
+
+  // The event parse walks the same reductions without building nodes
+  EventCounter counter;
+  parser.reset("c_grammar.c", SOURCE);
+  assert(parser.parseEvents(counter));
+  assert(counter.shifts > 0 && counter.reductions > 0);
+
+  // The skipping table takes the same shifts in fewer reductions
+  {
+    Lexer skip_lexer("c_grammar.c", SOURCE);
+    TokenStream skip_stream = TokenStream(skip_lexer, 16);
+    Parser skip_parser = Parser(skip_stream, grammar, skipping);
+    EventCounter skip_counter;
+    assert(skip_parser.parseEvents(skip_counter));
+    assert(skip_counter.shifts == counter.shifts);
+    assert(skip_counter.reductions < counter.reductions);
+  }
+
+  parser.reset("c_grammar.c", "int f() { return 1 }");
+  result = parser.parseInPlace();
+  assert(!result || !(*result)->errors.empty());
+
+  std::cout << "C grammar test passed!\n";
+}
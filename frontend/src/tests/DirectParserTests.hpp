@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "ParserTests.hpp"
+#include "UnitRuleTests.hpp"
+#include "ast/CExprGrammar.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "parser/TableCache.hpp"
+
+using namespace compiler;
+
+void testDirectParser() {
+  const Grammar grammar = C_EXPR_GRAMMAR.toGrammar();
+  const ActionTable& table = TableCache::tableFor(grammar);
+
+  auto parseDefault = [&](const std::string& input, bool& direct) {
+    Lexer lexer("no_source.c", input);
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    direct = parser.isDirectCoded();
+    return dumpCParse(parser.parse());
+  };
+
+  // Whatever engine the build picked must agree with the table-driven loop
+  // on the same table, on valid input as well as on every error.
+  std::mt19937 rng(7);
+  for (size_t i = 0; i < 300; ++i) {
+    std::ostringstream out;
+    generateCExpr(rng, 1 + i % 6, out);
+    std::string input = out.str();
+    if (i % 3 == 0) input.insert(rng() % input.size(), " ) ");
+
+    bool direct = false;
+    assert(parseDefault(input, direct) == parseCExpr(grammar, table, input));
+#ifdef FRONTEND_DIRECT_PARSER
+    assert(direct);
+#else
+    assert(!direct);
+#endif
+  }
+
+  // Other grammars always go through the table
+  Grammar expr = makeExprGrammar();
+  Lexer lexer("no_source.c", "1 + 2");
+  TokenStream stream = TokenStream(lexer, 10);
+  assert(!Parser(stream, expr).isDirectCoded());
+
+  std::cout << "Direct parser test passed!\n";
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "UnitRuleTests.hpp"
+#include "ast/CExprGrammar.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/GLRParser.hpp"
+#include "parser/StaticGrammar.hpp"
+
+using namespace compiler;
+
+// Statements C² cannot tell apart without knowing which names are types
+//
+// start       → stmt_list
+// stmt_list   → stmt stmt_list | stmt
+// stmt        → declaration | expr ;
+// declaration → type_name declarator ;
+// type_name   → IDENTIFIER
+// declarator  → * declarator | IDENTIFIER
+// expr        → expr * primary | primary
+// primary     → IDENTIFIER | LITERAL
+static constexpr auto DECLARATION_GRAMMAR = makeGrammar(
+    rule(NonTerminal::START, nt(NonTerminal::STMT_LIST)),
+    rule(NonTerminal::STMT_LIST, nt(NonTerminal::STMT),
+         nt(NonTerminal::STMT_LIST))
+        .reduceWith(reductions::stmtList),
+    rule(NonTerminal::STMT_LIST, nt(NonTerminal::STMT))
+        .reduceWith(reductions::singleStmtList),
+    rule(NonTerminal::STMT, nt(NonTerminal::DECLARATION)),
+    rule(NonTerminal::STMT, nt(NonTerminal::EXPR), pun(Punctuator::SEMI_COLON))
+        .reduceWith(reductions::exprStmt),
+    rule(NonTerminal::DECLARATION, nt(NonTerminal::TYPE_NAME),
+         nt(NonTerminal::DECLARATOR), pun(Punctuator::SEMI_COLON)),
+    rule(NonTerminal::TYPE_NAME, id()),
+    rule(NonTerminal::DECLARATOR, pun(Punctuator::STAR),
+         nt(NonTerminal::DECLARATOR)),
+    rule(NonTerminal::DECLARATOR, id()),
+    rule(NonTerminal::EXPR, nt(NonTerminal::EXPR), pun(Punctuator::STAR),
+         nt(NonTerminal::PRIMARY_EXPR))
+        .reduceWith(reductions::binaryExpr),
+    rule(NonTerminal::EXPR, nt(NonTerminal::PRIMARY_EXPR)),
+    rule(NonTerminal::PRIMARY_EXPR, id())
+        .reduceWith(reductions::identifierExpr),
+    rule(NonTerminal::PRIMARY_EXPR, lit())
+        .reduceWith(reductions::literalExpr));
+
+// The number of derivations of the statements of a forest, in order
+inline std::vector<size_t> statementReadings(const ParseForest& forest,
+                                             const SymbolTable& symbols) {
+  const SymbolId stmt = symbols.idOf(NonTerminal::STMT);
+  std::vector<size_t> readings;
+  for (uint32_t node = 0; node < forest.nodes.size(); ++node) {
+    if (forest.nodes[node].symbol == stmt) {
+      readings.push_back(forest.alternativeCount(node));
+    }
+  }
+  std::sort(readings.begin(), readings.end());
+  return readings;
+}
+
+inline std::string parseCExprGLR(const Grammar& grammar,
+                                 const std::string& input) {
+  Lexer lexer("no_source.c", input);
+  TokenStream stream = TokenStream(lexer, 10);
+  GLRParser parser = GLRParser(stream, grammar);
+  GLRParser::ForestResult forest = parser.parse();
+  if (!forest) return dumpCParse(std::unexpected(forest.error()));
+  assert((*forest)->ambiguityCount() == 0);
+  return dumpCParse(parser.buildProgram());
+}
+
+void testGLRParser() {
+  const Grammar grammar = DECLARATION_GRAMMAR.toGrammar();
+  const ActionTable& table = TableCache::tableFor(grammar, false);
+  const SymbolTable& symbols = table.symbols;
+
+  // `IDENTIFIER` before `*` can start a declaration or an expression
+  assert(table.conflictCount() > 0);
+
+  // Both readings of `a * b;` end up under one statement node
+  {
+    Lexer lexer("no_source.c", "a * b;");
+    TokenStream stream = TokenStream(lexer, 10);
+    GLRParser parser = GLRParser(stream, grammar);
+    GLRParser::ForestResult forest = parser.parse();
+    assert(forest);
+    assert((*forest)->ambiguityCount() == 1);
+    assert(statementReadings(**forest, symbols) == std::vector<size_t>{2});
+    assert(parser.forkCount() > 0);
+
+    // A later pass that knows `a` is a variable keeps the expression
+    auto expression = [&](const ParseForest& forest, uint32_t node) {
+      uint32_t alt = forest.nodes[node].first;
+      while (grammar.rhsOf(forest.alternatives[alt].rule).size() != 2) {
+        alt = forest.alternatives[alt].next;
+      }
+      return alt;
+    };
+    Parser::ParserResult result = parser.buildProgram(expression);
+    assert(result);
+    const ASTStorage& ast = result->storage;
+    const StmtAST& stmt = ast[ast.stmt_lists[result->root].stmt];
+    assert(stmt.type == StmtAST::Type::EXPR);
+    std::ostringstream out;
+    dumpCExpr(ast, {stmt.index}, out, "a * b;");
+    assert(out.str() == "(* a b)");
+  }
+
+  // Parses that hit an error die, the survivor is the only reading. The
+  // statements that need no guess never fork.
+  {
+    Lexer lexer("no_source.c", "a * * b; x; 1 * y; t z;");
+    TokenStream stream = TokenStream(lexer, 10);
+    GLRParser parser = GLRParser(stream, grammar);
+    GLRParser::ForestResult forest = parser.parse();
+    assert(forest);
+    assert((*forest)->ambiguityCount() == 0);
+    assert((statementReadings(**forest, symbols) ==
+            std::vector<size_t>{1, 1, 1, 1}));
+    assert(parser.forkCount() == 1);
+  }
+
+  // Input that never forks is parsed like Parser does, the forest only
+  // holds what was left on the stack
+  {
+    Lexer lexer("no_source.c", "1 * y; x;");
+    TokenStream stream = TokenStream(lexer, 10);
+    GLRParser parser = GLRParser(stream, grammar);
+    GLRParser::ForestResult forest = parser.parse();
+    assert(forest);
+    assert(parser.forkCount() == 0);
+    assert((*forest)->nodes.size() == 1);
+    Parser::ParserResult result = parser.buildProgram();
+    assert(result && result->root != NO_INDEX);
+    assert(result->storage.binary_exprs.size() == 1);
+    assert(result->storage.stmts.size() == 2);
+  }
+
+  // A syntax error is reported where every parse died
+  {
+    Lexer lexer("no_source.c", "a * b c;");
+    TokenStream stream = TokenStream(lexer, 10);
+    GLRParser parser = GLRParser(stream, grammar);
+    GLRParser::ForestResult forest = parser.parse();
+    assert(!forest);
+    assert(forest.error().type == ParserErrorType::UNEXPECTED_SYMBOL);
+  }
+
+  // The C expressions are unambiguous, GLR has to build the same ASTs as
+  // Parser does, errors included. FOLLOW sets still leave the assignments
+  // a conflict, `unary` before `=` may end a cast, whose fork dies on the
+  // next token.
+  const Grammar c_grammar = C_EXPR_GRAMMAR.toGrammar();
+  const ActionTable& c_table = TableCache::tableFor(c_grammar, false);
+
+  std::mt19937 rng(4242);
+  for (size_t i = 0; i < 200; ++i) {
+    std::ostringstream out;
+    generateCExpr(rng, 1 + i % 6, out);
+    std::string input = out.str();
+    assert(parseCExprGLR(c_grammar, input) ==
+           parseCExpr(c_grammar, c_table, input));
+
+    input.insert(rng() % input.size(), i % 2 ? " ) " : " + ");
+    assert(parseCExprGLR(c_grammar, input) ==
+           parseCExpr(c_grammar, c_table, input));
+  }
+
+  std::cout << "GLR parser test passed!\n";
+}
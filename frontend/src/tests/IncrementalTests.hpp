@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "UnitRuleTests.hpp"
+#include "ast/CExprGrammar.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+using namespace compiler;
+
+// Like dumpCParse, for programs kept in the parser. Names are spelled out so
+// that nodes left pointing at moved text show up.
+inline std::string dumpCProgram(const Parser::ProgramResult& result,
+                                std::string_view source) {
+  std::ostringstream out;
+  if (!result) {
+    out << "fail " << static_cast<int>(result.error().type);
+    if (result.error().unex_symbol_error) {
+      const UnexpectedSymbolError& error = *result.error().unex_symbol_error;
+      out << " " << error.found.toString() << " at "
+          << error.lexer_state.line << ":" << error.lexer_state.column;
+    }
+    return out.str();
+  }
+  out << (*result)->errors.size() << " ";
+  dumpCExpr((*result)->storage, {(*result)->root}, out, source);
+  return out.str();
+}
+
+inline std::string parseCExprFromScratch(const Grammar& grammar,
+                                         const std::string& input) {
+  Lexer lexer("edited.c", input);
+  TokenStream stream = TokenStream(lexer, 10);
+  Parser parser = Parser(stream, grammar);
+  return dumpCProgram(parser.parseIncremental(), input);
+}
+
+// Balanced expression with 2^depth leaves, an edit of one leaf only changes
+// the nodes on its way up to the root.
+inline void generateBalanced(size_t depth, size_t& leaf,
+                             std::ostringstream& out) {
+  if (depth == 0) {
+    out << "v" << leaf++;
+    return;
+  }
+  out << "( ";
+  generateBalanced(depth - 1, leaf, out);
+  out << (depth % 2 ? " + " : " * ");
+  generateBalanced(depth - 1, leaf, out);
+  out << " )";
+}
+
+void testIncrementalParsing() {
+  const Grammar grammar = C_EXPR_GRAMMAR.toGrammar();
+  static constexpr const char* SNIPPETS[] = {
+      "",   "a", "bb", "7",  " ",  "\n", " + ", "*",  "-",
+      "++", "(", ")",  "?",  ":",  "=",  "<<",  ", ", "1 ? c : d"};
+
+  // Random edits over a generated corpus, every reparse must give what a
+  // parse of the edited text from scratch gives, errors included. The text
+  // of the previous parse has to outlive it, so two buffers take turns.
+  std::mt19937 rng(31337);
+  for (size_t round = 0; round < 20; ++round) {
+    std::ostringstream out;
+    generateCExpr(rng, 6, out);
+
+    std::string texts[2] = {out.str(), ""};
+    size_t current = 0;
+
+    Lexer lexer("edited.c", texts[current]);
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    assert(dumpCProgram(parser.parseIncremental(), texts[current]) ==
+           parseCExprFromScratch(grammar, texts[current]));
+
+    for (size_t i = 0; i < 40; ++i) {
+      const std::string& text = texts[current];
+      const uint32_t start = rng() % (text.size() + 1);
+      const uint32_t old_end =
+          std::min<uint32_t>(start + rng() % 4, text.size());
+      const std::string snippet = SNIPPETS[rng() % std::size(SNIPPETS)];
+
+      std::string& edited = texts[1 - current];
+      edited = text.substr(0, start) + snippet + text.substr(old_end);
+      current = 1 - current;
+
+      const Parser::TextEdit edit{
+          start, old_end, static_cast<uint32_t>(start + snippet.size())};
+      assert(dumpCProgram(parser.reparse(edited, edit), edited) ==
+             parseCExprFromScratch(grammar, edited));
+    }
+  }
+
+  // A one-leaf edit of a large expression reuses everything around it
+  size_t leaves = 0;
+  std::ostringstream out;
+  generateBalanced(10, leaves, out);
+  std::string text = out.str();
+
+  Lexer lexer("balanced.c", text);
+  TokenStream stream = TokenStream(lexer, 10);
+  Parser parser = Parser(stream, grammar);
+  Parser::ProgramResult result = parser.parseIncremental();
+  assert(result && (*result)->errors.empty());
+  const size_t full_size = (*result)->storage.exprs.size();
+
+  const uint32_t at = text.find("v500 ");
+  std::string edited = text;
+  edited.replace(at, 4, "answer");
+  result = parser.reparse(edited, {at, at + 4, at + 6});
+  assert(dumpCProgram(result, edited) ==
+         parseCExprFromScratch(grammar, edited));
+  assert((*result)->storage.exprs.size() - full_size < 64);
+
+  std::cout << "Incremental parsing test passed!\n";
+}
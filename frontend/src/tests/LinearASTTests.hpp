@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ParserTests.hpp"
+#include "ast/LinearAST.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+using namespace compiler;
+
+// Evaluates integer arithmetic in one forward scan, the way a pass runs
+// over the linear layout: every child is done before its parent.
+inline uint64_t evaluateLinear(const LinearAST& linear) {
+  std::vector<uint64_t> values(linear.nodes().size());
+  for (uint32_t i = 0; i < values.size(); ++i) {
+    const LinearAST::Node& node = linear[i];
+    switch (node.kind) {
+      case LinearAST::Kind::LITERAL:
+        values[i] = node.literal.integer;
+        break;
+      case LinearAST::Kind::PAREN_EXPR:
+        values[i] = values[i - 1];
+        break;
+      case LinearAST::Kind::BINARY_EXPR: {
+        const uint64_t left = values[linear.childAt(i, 0)];
+        const uint64_t right = values[i - 1];
+        values[i] = node.op == Punctuator::PLUS ? left + right : left * right;
+        break;
+      }
+      default:
+        values[i] = 0;
+        break;
+    }
+  }
+  return values.back();
+}
+
+void testLinearAST() {
+  using Kind = LinearAST::Kind;
+
+  // 1 + 2 * (3 + 4) in post-order, literals folded into their expression
+  {
+    const Grammar grammar = makeExprGrammar();
+    Lexer lexer("no_source.c", "1 + 2 * (3 + 4)");
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    auto result = parser.parse();
+    assert(result);
+
+    LinearAST linear;
+    const uint32_t root =
+        linear.append(result->storage, Handle<ExprAST>{result->root});
+    assert(root == 7 && linear.nodes().size() == 8);
+
+    std::vector<Kind> kinds;
+    for (const LinearAST::Node& node : linear.nodes()) {
+      kinds.push_back(node.kind);
+    }
+    assert((kinds == std::vector{Kind::LITERAL, Kind::LITERAL, Kind::LITERAL,
+                                 Kind::LITERAL, Kind::BINARY_EXPR,
+                                 Kind::PAREN_EXPR, Kind::BINARY_EXPR,
+                                 Kind::BINARY_EXPR}));
+    assert(linear[root].size == 8 && linear[root].arity == 2);
+    assert(linear.childAt(root, 0) == 0 && linear.childAt(root, 1) == 6);
+    assert(linear.firstOf(5) == 2);
+    assert(linear[linear.childAt(6, 0)].literal.integer == 2);
+    assert(evaluateLinear(linear) == 15);
+  }
+
+  // A statement list is one node over all of its statements, errors
+  // included
+  {
+    const Grammar grammar = makeStmtGrammar();
+    Lexer lexer("no_source.c", "1 + 2; 3 + + 4; (5 * 6);");
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    auto result = parser.parse();
+    assert(result && result->errors.size() == 1);
+
+    LinearAST linear;
+    const uint32_t root =
+        linear.append(result->storage, Handle<StmtListAST>{result->root});
+    const LinearAST::Node& list = linear[root];
+    assert(list.kind == Kind::STMT_LIST && list.arity == 3);
+    assert(list.size == linear.nodes().size());
+    assert(linear[linear.childAt(root, 0)].kind == Kind::EXPR_STMT);
+    assert(linear[linear.childAt(root, 1)].kind == Kind::ERROR_STMT);
+    assert(linear[linear.childAt(root, 1)].diagnostic == 0);
+
+    const uint32_t last = linear.childAt(root, 2);
+    assert(linear[last].kind == Kind::EXPR_STMT && linear[last].size == 5);
+    assert(linear[last - 1].kind == Kind::PAREN_EXPR);
+    assert(linear[linear.firstOf(last)].literal.integer == 5);
+  }
+
+  // Deep trees are laid out without recursion, and roots follow each other
+  {
+    const Grammar grammar = makeExprGrammar();
+    std::string chain = "1";
+    for (size_t i = 0; i < 20000; ++i) chain += " + 1";
+    Lexer lexer("no_source.c", chain);
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    auto result = parser.parse();
+    assert(result);
+
+    LinearAST linear;
+    linear.append(result->storage, Handle<ExprAST>{result->root});
+    const uint32_t second =
+        linear.append(result->storage, Handle<ExprAST>{result->root});
+    assert(linear.roots().size() == 2 && linear.firstOf(second) == 40001);
+    assert(evaluateLinear(linear) == 20001);
+
+    linear.clear();
+    assert(linear.nodes().empty() && linear.roots().empty());
+  }
+
+  std::cout << "Linear AST test passed!\n";
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ParserTests.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "parser/TableCache.hpp"
+
+using namespace compiler;
+
+// Writes down every event with the text it covers
+struct EventRecorder {
+  std::string_view source;
+  std::vector<std::string> events;
+  size_t shifts = 0;
+
+  void onShift(const Token& token) {
+    events.push_back("shift " + token.toString(source));
+    ++shifts;
+  }
+
+  void onReduce(uint32_t rule, TokenStream::Span span) {
+    events.push_back("reduce " + std::to_string(rule) + " '" +
+                     std::string(source.substr(span.start,
+                                               span.end - span.start)) +
+                     "'");
+  }
+};
+
+// Counts without keeping anything, the kind of handler tools write
+struct EventCounter {
+  size_t shifts = 0;
+  size_t reductions = 0;
+
+  void onShift(const Token&) { ++shifts; }
+  void onReduce(uint32_t, TokenStream::Span) { ++reductions; }
+};
+
+void testParseEvents() {
+  const Grammar grammar = makeExprGrammar();
+
+  // The table that keeps unit rules reports every reduction
+  {
+    const std::string_view source = "1 + (2 * 3)";
+    Lexer lexer("no_source.c", source);
+    TokenStream stream = TokenStream(lexer, 10);
+    const ActionTable table(grammar, 1);
+    Parser parser = Parser(stream, grammar, table);
+
+    EventRecorder recorder{source, {}};
+    assert(parser.parseEvents(recorder));
+    assert((recorder.events == std::vector<std::string>{
+                                   "shift 1",
+                                   "reduce 6 '1'",
+                                   "reduce 4 '1'",
+                                   "reduce 2 '1'",
+                                   "shift +",
+                                   "shift (",
+                                   "shift 2",
+                                   "reduce 6 '2'",
+                                   "reduce 4 '2'",
+                                   "shift *",
+                                   "shift 3",
+                                   "reduce 6 '3'",
+                                   "reduce 3 '2 * 3'",
+                                   "reduce 2 '2 * 3'",
+                                   "shift )",
+                                   "reduce 5 '(2 * 3)'",
+                                   "reduce 4 '(2 * 3)'",
+                                   "reduce 1 '1 + (2 * 3)'",
+                               }));
+  }
+
+  // A table that skips the handler-less unit rules reports fewer
+  // reductions, and no node is built either way
+  {
+    Lexer lexer("no_source.c", "1 + (2 * 3)");
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar,
+                           TableCache::tableFor(grammar,
+                                                /*skip_unit_rules=*/true));
+
+    EventCounter counter;
+    assert(parser.parseEvents(counter));
+    assert(counter.shifts == 7);
+    assert(counter.reductions == 6);
+  }
+
+  // The first syntax error ends the parse
+  {
+    Lexer lexer("no_source.c", "1 + * 2");
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+
+    EventCounter counter;
+    Parser::EventResult result = parser.parseEvents(counter);
+    assert(!result);
+    assert(result.error().type == ParserErrorType::UNEXPECTED_SYMBOL);
+    assert(counter.shifts == 2);
+  }
+
+  std::cout << "Parse events test passed!\n";
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "ParserTests.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "parser/ParserStats.hpp"
+#include "parser/TableCache.hpp"
+
+using namespace compiler;
+
+void testParserStats() {
+  const Grammar grammar = makeExprGrammar();
+  ParserStats stats;
+
+  // Handler-less unit rules are skipped by a table asked to, they never
+  // show up among the reductions
+  Lexer lexer("no_source.c", "1 + (2 * 3)");
+  TokenStream stream = TokenStream(lexer, 10);
+  Parser parser = Parser(stream, grammar,
+                         TableCache::tableFor(grammar,
+                                              /*skip_unit_rules=*/true));
+  parser.collectStats(&stats);
+  assert(parser.parseInPlace());
+
+  assert(stats.parses == 1);
+  assert(stats.shifts == 7);
+  assert(stats.reductions == 6);
+  assert(stats.rule_hits.size() == grammar.size());
+  assert(stats.rule_hits[6] == 3 && stats.rule_hits[1] == 1);
+  assert(stats.rule_hits[2] == 0 && stats.rule_hits[4] == 0);
+  assert(stats.goto_lookups == stats.reductions);
+  assert(stats.action_lookups == stats.shifts + stats.reductions + 1);
+  assert(stats.touched_cells.count() > 0);
+  assert(stats.touched_cells.count() <= stats.action_lookups);
+  assert(stats.touched_cells.count() < stats.table_cells);
+  assert(stats.stack_allocations == 1);
+  assert(stats.max_depth >= 4);
+  assert(stats.lexing_time <= stats.total_time);
+
+  // Counters add up over parses, a deeper input grows the stack again
+  std::string nested = "1";
+  for (size_t i = 0; i < 100; ++i) nested = "(" + nested + ")";
+  parser.reset("nested.c", nested);
+  assert(parser.parseInPlace());
+  assert(stats.parses == 2);
+  assert(stats.shifts == 7 + 201);
+  assert(stats.max_depth > ParseStack::INITIAL_CAPACITY);
+  assert(stats.stack_allocations == 2);
+
+  const std::string json = stats.toJSON(grammar);
+  assert(json.starts_with("{\n") && json.ends_with("}\n"));
+  assert(json.find("\"shifts\": 208,") != std::string::npos);
+  assert(json.find("{\"index\": 5, \"rule\": \"<NT:4> -> ( <NT:2> )\", "
+                   "\"hits\": 101}") != std::string::npos);
+
+  // Without stats nothing is counted
+  parser.collectStats(nullptr);
+  parser.reset("no_source.c", "1");
+  assert(parser.parseInPlace());
+  assert(stats.parses == 2);
+
+  stats.clear();
+  assert(stats.parses == 0 && stats.rule_hits.empty());
+
+  std::cout << "Parser stats test passed!\n";
+}
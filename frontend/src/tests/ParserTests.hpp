@@ -8,59 +8,73 @@
 #include <stack>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
+#include "ast/Reductions.hpp"
 #include "lexer/Lexer.hpp"
 #include "parser/ActionTable.hpp"
+#include "parser/ParseSession.hpp"
 #include "parser/Parser.hpp"
+#include "parser/StaticGrammar.hpp"
+#include "parser/TableCache.hpp"
 
 using namespace compiler;
 
+// START → EXPR
+// EXPR  → EXPR + TERM | TERM
+// TERM  → TERM * FACT | FACT
+// FACT  → ( EXPR ) | CONSTANT
+static constexpr auto EXPR_GRAMMAR = makeGrammar(
+    rule(NonTerminal::START, nt(NonTerminal::EXPR)),
+    rule(NonTerminal::EXPR, nt(NonTerminal::EXPR), pun(Punctuator::PLUS),
+         nt(NonTerminal::TERM))
+        .reduceWith(reductions::binaryExpr),
+    rule(NonTerminal::EXPR, nt(NonTerminal::TERM)),
+    rule(NonTerminal::TERM, nt(NonTerminal::TERM), pun(Punctuator::STAR),
+         nt(NonTerminal::FACT))
+        .reduceWith(reductions::binaryExpr),
+    rule(NonTerminal::TERM, nt(NonTerminal::FACT)),
+    rule(NonTerminal::FACT, pun(Punctuator::LPAREN), nt(NonTerminal::EXPR),
+         pun(Punctuator::RPAREN))
+        .reduceWith(reductions::parenExpr),
+    rule(NonTerminal::FACT, lit()).reduceWith(reductions::literalExpr));
+
+Grammar makeExprGrammar() { return EXPR_GRAMMAR.toGrammar(); }
+
+// Statements of expressions, with a way back in after a broken one
+//
+// START     → STMT_LIST
+// STMT_LIST → STMT STMT_LIST | STMT
+// STMT      → EXPR ; | error ;
+static constexpr auto STMT_GRAMMAR = makeGrammar(
+    rule(NonTerminal::START, nt(NonTerminal::STMT_LIST)),
+    rule(NonTerminal::EXPR, nt(NonTerminal::EXPR), pun(Punctuator::PLUS),
+         nt(NonTerminal::TERM))
+        .reduceWith(reductions::binaryExpr),
+    rule(NonTerminal::EXPR, nt(NonTerminal::TERM)),
+    rule(NonTerminal::TERM, nt(NonTerminal::TERM), pun(Punctuator::STAR),
+         nt(NonTerminal::FACT))
+        .reduceWith(reductions::binaryExpr),
+    rule(NonTerminal::TERM, nt(NonTerminal::FACT)),
+    rule(NonTerminal::FACT, pun(Punctuator::LPAREN), nt(NonTerminal::EXPR),
+         pun(Punctuator::RPAREN))
+        .reduceWith(reductions::parenExpr),
+    rule(NonTerminal::FACT, lit()).reduceWith(reductions::literalExpr),
+    rule(NonTerminal::STMT_LIST, nt(NonTerminal::STMT),
+         nt(NonTerminal::STMT_LIST))
+        .reduceWith(reductions::stmtList),
+    rule(NonTerminal::STMT_LIST, nt(NonTerminal::STMT))
+        .reduceWith(reductions::singleStmtList),
+    rule(NonTerminal::STMT, nt(NonTerminal::EXPR), pun(Punctuator::SEMI_COLON))
+        .reduceWith(reductions::exprStmt),
+    rule(NonTerminal::STMT, err(), pun(Punctuator::SEMI_COLON))
+        .reduceWith(reductions::errorStmt));
+
+Grammar makeStmtGrammar() { return STMT_GRAMMAR.toGrammar(); }
+
 void testParser(const std::string& input, const std::string& testName) {
-  // Define Symbols
-  Symbol START;
-  START.type = Symbol::Type::NON_TERMINAL;
-  START.nonterminal = NonTerminal::START;
-
-  Symbol ID = Symbol::identifier();
-  Symbol CONSTANT = Symbol::literal();
-
-  Symbol PLUS;
-  PLUS.type = Symbol::Type::PUN_TERMINAL;
-  PLUS.terminal.punctuator = Punctuator::PLUS;
-
-  Symbol STAR;
-  STAR.type = Symbol::Type::PUN_TERMINAL;
-  STAR.terminal.punctuator = Punctuator::STAR;
-
-  Symbol LPAREN;
-  LPAREN.type = Symbol::Type::PUN_TERMINAL;
-  LPAREN.terminal.punctuator = Punctuator::LPAREN;
-
-  Symbol RPAREN;
-  RPAREN.type = Symbol::Type::PUN_TERMINAL;
-  RPAREN.terminal.punctuator = Punctuator::RPAREN;
-
-  Symbol EXPR;
-  EXPR.type = Symbol::Type::NON_TERMINAL;
-  EXPR.nonterminal = NonTerminal::EXPR;
-
-  Symbol TERM;
-  TERM.type = Symbol::Type::NON_TERMINAL;
-  TERM.nonterminal = NonTerminal::TERM;
-
-  Symbol FACT;
-  FACT.type = Symbol::Type::NON_TERMINAL;
-  FACT.nonterminal = NonTerminal::FACT;
-
-  // Define Grammar
-  Grammar grammar;
-  grammar.push_back({NonTerminal::START, {EXPR}});
-  grammar.push_back({NonTerminal::EXPR, {EXPR, PLUS, TERM}});
-  grammar.push_back({NonTerminal::EXPR, {TERM}});
-  grammar.push_back({NonTerminal::TERM, {TERM, STAR, FACT}});
-  grammar.push_back({NonTerminal::TERM, {FACT}});
-  grammar.push_back({NonTerminal::FACT, {LPAREN, EXPR, RPAREN}});
-  grammar.push_back({NonTerminal::FACT, {CONSTANT}});
+  Grammar grammar = makeExprGrammar();
 
   std::cout << "Testing input: \"" << input << "\" (" << testName << ")\n";
   Lexer lexer("no_source.c", input);
@@ -73,4 +87,196 @@ void testParser(const std::string& input, const std::string& testName) {
   } else {
     std::cerr << "Parse error: " << result.error().toString() << "\n";
   }
-}
\ No newline at end of file
+}
+
+void testParserAST() {
+  Grammar grammar = makeExprGrammar();
+  Lexer lexer("no_source.c", "1 + 2 * (3 + 4)");
+  TokenStream stream = TokenStream(lexer, 10);
+  Parser parser = Parser(stream, grammar);
+  auto result = parser.parse();
+  assert(result);
+
+  const ASTStorage& ast = result->storage;
+  auto literalOf = [&](Handle<ExprAST> expr) {
+    assert(ast[expr].type == ExprAST::Type::LITERAL);
+    return ast.literals[ast[expr].index].literal.integer;
+  };
+
+  // Every node lives in the storage vectors, one entry per node
+  assert(ast.literals.size() == 4);
+  assert(ast.binary_exprs.size() == 3);
+  assert(ast.exprs.size() == 4 + 3 + 1);
+
+  // 1 + (2 * (3 + 4))
+  const ExprAST& root = ast.exprs[result->root];
+  assert(root.type == ExprAST::Type::BINARY_EXPR);
+  const BinaryExprAST& sum = ast.binary_exprs[root.index];
+  assert(sum.op == Punctuator::PLUS);
+  assert(literalOf(sum.left) == 1);
+
+  assert(ast[sum.right].type == ExprAST::Type::BINARY_EXPR);
+  const BinaryExprAST& product = ast.binary_exprs[ast[sum.right].index];
+  assert(product.op == Punctuator::STAR);
+  assert(literalOf(product.left) == 2);
+
+  const ExprAST& paren = ast[product.right];
+  assert(paren.type == ExprAST::Type::PAREN_EXPR);
+  const BinaryExprAST& inner = ast.binary_exprs[ast.exprs[paren.index].index];
+  assert(inner.op == Punctuator::PLUS);
+  assert(literalOf(inner.left) == 3);
+  assert(literalOf(inner.right) == 4);
+
+  std::cout << "Parser AST test passed!\n";
+}
+
+void testTerminalMapping() {
+  Grammar grammar = makeExprGrammar();
+  const SymbolTable& symbols = TableCache::tableFor(grammar).symbols;
+  const SymbolId plus = symbols.idOf(Symbol{
+      .type = Symbol::Type::PUN_TERMINAL,
+      .terminal = {.punctuator = Punctuator::PLUS}});
+
+  // Tokens buffered before the map is set and tokens lexed after it both
+  // carry their terminal id. Every literal kind is the one literal.
+  Lexer lexer("no_source.c", "1 + 'c' + 2.5 - true + 7");
+  TokenStream stream = TokenStream(lexer, 5);
+  assert(stream.peek().terminal == NO_TERMINAL);
+  stream.mapTerminals(symbols.terminalMap());
+
+  std::vector<SymbolId> ids;
+  for (auto token = stream.next(); token; token = stream.next()) {
+    ids.push_back(token->terminal);
+    if (token->type == TokenType::ENDOF) break;
+  }
+  const SymbolId lit = symbols.idOf(Symbol::literal());
+  assert((ids == std::vector<SymbolId>{lit, plus, lit, plus, lit,
+                                       SymbolTable::NONE, lit, plus, lit,
+                                       SymbolTable::ENDOF}));
+
+  std::cout << "Terminal mapping test passed!\n";
+}
+
+void testParserRecovery() {
+  // Error productions: both broken statements become error nodes and the
+  // statements around them are still parsed.
+  {
+    Grammar grammar = makeStmtGrammar();
+    Lexer lexer("no_source.c", "1 + 2; 3 + + 4; (5 * ; 6;");
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    auto result = parser.parse();
+    assert(result);
+
+    const ASTStorage& ast = result->storage;
+    assert(result->errors.size() == 2);
+    assert(ast.errors.size() == 2);
+    assert(ast.errors[0].diagnostic == 0 && ast.errors[1].diagnostic == 1);
+
+    std::vector<StmtAST::Type> stmts;
+    for (Handle<StmtListAST> list{result->root}; list.valid();
+         list = ast[list].next) {
+      stmts.push_back(ast[ast[list].stmt].type);
+    }
+    assert((stmts == std::vector{StmtAST::Type::EXPR, StmtAST::Type::ERROR,
+                                 StmtAST::Type::ERROR, StmtAST::Type::EXPR}));
+  }
+
+  // Panic mode: without error productions the parser skips past `;`
+  {
+    Grammar grammar = makeExprGrammar();
+    Lexer lexer("no_source.c", "1 + ; 2");
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    auto result = parser.parse();
+    assert(result && result->errors.size() == 1);
+  }
+
+  // Nothing to resume from: the first error is returned
+  {
+    Grammar grammar = makeExprGrammar();
+    Lexer lexer("no_source.c", "1 + ) 2");
+    TokenStream stream = TokenStream(lexer, 10);
+    Parser parser = Parser(stream, grammar);
+    auto result = parser.parse();
+    assert(!result);
+    assert(result.error().type == ParserErrorType::UNEXPECTED_SYMBOL);
+  }
+
+  std::cout << "Parser recovery test passed!\n";
+}
+
+void testParseSession() {
+  Grammar grammar = makeExprGrammar();
+  ParseSession session(grammar);
+
+  const std::string sources[] = {
+      "(1 + 2) * (3 + 4) * (5 + 6) + 7 * 8",
+      "1 + 2 * 3",
+      "1 + + 2",
+      "(4)",
+      "9 * 9 + 9",
+  };
+
+  // Every source parses exactly like it would with a parser of its own
+  for (const std::string& source : sources) {
+    auto reused = session.parse("no_source.c", source);
+
+    Lexer lexer("no_source.c", source);
+    TokenStream stream = TokenStream(lexer, 10);
+    auto fresh = Parser(stream, grammar).parse();
+
+    assert(reused.has_value() == fresh.has_value());
+    if (!fresh) continue;
+    const ASTProgram& program = **reused;
+    assert(program.root == fresh->root);
+    assert(program.errors.size() == fresh->errors.size());
+    assert(program.storage.exprs.size() == fresh->storage.exprs.size());
+    assert(program.storage.binary_exprs.size() ==
+           fresh->storage.binary_exprs.size());
+    for (size_t i = 0; i < program.storage.literals.size(); ++i) {
+      assert(program.storage.literals[i].literal.integer ==
+             fresh->storage.literals[i].literal.integer);
+    }
+  }
+
+  // Once the storage has grown to size, later sources reuse its memory
+  const ASTProgram* program = *session.parse("no_source.c", sources[0]);
+  const ExprAST* exprs = program->storage.exprs.data();
+  const BinaryExprAST* binary_exprs = program->storage.binary_exprs.data();
+  for (const std::string& source : sources) {
+    auto result = session.parse("no_source.c", source);
+    if (!result) continue;
+    assert((*result)->storage.exprs.data() == exprs);
+    assert((*result)->storage.binary_exprs.data() == binary_exprs);
+  }
+
+  std::cout << "Parse session test passed!\n";
+}
+
+void testTableCache() {
+  // Equal grammars living in different places share one table
+  Grammar first = makeExprGrammar();
+  Grammar second = makeExprGrammar();
+  const ActionTable& table = TableCache::tableFor(first);
+  assert(&table == &TableCache::tableFor(second));
+
+  // Concurrent requests all observe the same, fully built table
+  std::vector<const ActionTable*> seen(8, nullptr);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < seen.size(); ++i) {
+    workers.emplace_back([&seen, i] {
+      Grammar grammar = makeExprGrammar();
+      seen[i] = &TableCache::tableFor(grammar);
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  for (const ActionTable* other : seen) assert(other == &table);
+
+  // A different grammar gets its own table
+  Grammar changed;
+  for (size_t i = 0; i + 1 < first.size(); ++i) changed.add(first[i]);
+  assert(&TableCache::tableFor(changed) != &table);
+
+  std::cout << "Table cache test passed!\n";
+}
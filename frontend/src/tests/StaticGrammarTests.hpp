@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+#include "parser/ActionTable.hpp"
+#include "parser/Parser.hpp"
+#include "parser/StaticGrammar.hpp"
+#include "parser/TableCache.hpp"
+#include "tests/ParseEventTests.hpp"
+#include "tests/ParserTests.hpp"
+
+using namespace compiler;
+
+// The whole automaton is known to the compiler
+static_assert(StaticTable<EXPR_GRAMMAR>.stateCount() == 12);
+static_assert(StaticTable<EXPR_GRAMMAR>.actionFrom(0, SymbolTable::ENDOF)
+                  .type == Action::ERROR);
+
+void testStaticGrammar() {
+  constexpr const auto& table = StaticTable<EXPR_GRAMMAR>;
+
+  // The compile-time table must match the runtime one cell for cell
+  Grammar grammar = EXPR_GRAMMAR.toGrammar();
+  ActionTable runtime(grammar, 1);
+
+  assert(runtime.stateCount() == table.stateCount());
+  assert(runtime.symbols.terminalCount() == table.terminalCount());
+  assert(runtime.symbols.nonTerminalCount() == table.nonTerminalCount());
+
+  for (size_t id = 0; id < runtime.symbols.size(); ++id) {
+    assert(runtime.symbols.symbolOf(id) == table.symbols[id]);
+  }
+
+  for (size_t rule = 0; rule < grammar.size(); ++rule) {
+    assert(runtime.lhsOf(rule) == table.lhsOf(rule));
+    assert(grammar[rule].rhs.size() == table.rule_length[rule]);
+  }
+  for (NonTerminal lhs : {NonTerminal::EXPR, NonTerminal::TERM}) {
+    const SymbolId nt = runtime.symbols.idOf(lhs) - table.terminalCount();
+    assert(std::ranges::equal(
+        runtime.rulesOf(lhs),
+        std::span(table.lhs_rules.data() + table.lhs_offsets[nt],
+                  table.lhs_offsets[nt + 1] - table.lhs_offsets[nt])));
+  }
+
+  for (size_t state = 0; state < table.stateCount(); ++state) {
+    for (SymbolId t = 0; t < table.terminalCount(); ++t) {
+      assert(runtime.actionFrom(state, t) == table.actionFrom(state, t));
+    }
+    for (SymbolId nt = table.terminalCount();
+         nt < table.terminalCount() + table.nonTerminalCount(); ++nt) {
+      assert(runtime.gotoFrom(state, nt) == table.gotoFrom(state, nt));
+    }
+  }
+
+  // The runtime table made from the static one reads its arrays in place
+  // and only misses the conflicts
+  const ActionTable& adopted = TableCache::tableFor(grammar, table.prebuilt());
+  assert(&adopted == &TableCache::tableFor(grammar, table.prebuilt()));
+  assert(&adopted != &TableCache::tableFor(grammar));
+  assert(adopted.actions.data() == table.actions.data());
+  assert(adopted.gotos.data() == table.gotos.data());
+  assert(adopted.expectedTerminals(0).data() ==
+         table.expected_terminals.data() + table.expected_offsets[0]);
+  assert(adopted.stateCount() == runtime.stateCount());
+  assert(adopted.conflictCount() == 0);
+  for (size_t state = 0; state < table.stateCount(); ++state) {
+    assert(std::ranges::equal(adopted.expectedTerminals(state),
+                              runtime.expectedTerminals(state)));
+    assert(std::ranges::equal(adopted.exampleRules(state),
+                              runtime.exampleRules(state)));
+  }
+
+  // A parser drives it like the table built at runtime
+  const std::string_view source = "1 + 2 * (3 + 4) * 5";
+  EventCounter built;
+  {
+    Lexer lexer("static.c", source);
+    TokenStream stream = TokenStream(lexer, 8);
+    Parser parser = Parser(stream, grammar);
+    assert(parser.parseEvents(built));
+  }
+  {
+    Lexer lexer("static.c", source);
+    TokenStream stream = TokenStream(lexer, 8);
+    Parser parser = Parser(stream, grammar, table);
+    EventCounter counter;
+    assert(parser.parseEvents(counter));
+    assert(counter.shifts == built.shifts);
+    assert(counter.reductions == built.reductions);
+  }
+  {
+    Lexer lexer("static.c", source);
+    TokenStream stream = TokenStream(lexer, 8);
+    Parser parser = Parser(stream, grammar, table);
+    auto result = parser.parse();
+    assert(result && result->errors.empty());
+    assert(result->storage.binary_exprs.size() == 4);
+  }
+
+  std::cout << "Static grammar test passed!\n";
+}
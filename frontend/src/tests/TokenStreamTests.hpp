@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "ParseEventTests.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+#include "tokens/TokenStream.hpp"
+
+using namespace compiler;
+
+// Drains a stream, one word per token and "error" for a lexer error
+inline std::string drainTokens(TokenStream& stream, std::string_view source,
+                               size_t limit) {
+  std::string out;
+  for (size_t i = 0; i < limit; ++i) {
+    Lexer::LexerResult result = stream.next();
+    if (!result) {
+      out += "error";
+      break;
+    }
+    if (result->type == TokenType::ENDOF) break;
+    out += result->toString(source) + " ";
+  }
+  return out;
+}
+
+void testTokenStream() {
+  // A lexer error while prefilling comes after the tokens lexed before it
+  {
+    const std::string_view source = "a + b * c ` d";
+    Lexer lexer("stream.c", source);
+    TokenStream stream = TokenStream(lexer, 10);
+    assert(drainTokens(stream, source, 20) == "a + b * c error");
+    assert(stream.span().start == 8 && stream.span().end == 9);
+
+    // It keeps standing for the rest of the source
+    assert(!stream.next());
+  }
+
+  // Same for one hit while the buffer refills
+  {
+    const std::string_view source = "a + b * c - d / e ` f";
+    Lexer lexer("stream.c", source);
+    TokenStream stream = TokenStream(lexer, 5);
+    assert(drainTokens(stream, source, 20) == "a + b * c - d / e error");
+  }
+
+  // The parser sees every token before the error, and only then fails on
+  // the lexer error
+  {
+    const Grammar grammar = makeExprGrammar();
+    Lexer lexer("stream.c", "1 + 2 * 3 + 4 `");
+    TokenStream stream = TokenStream(lexer, 5);
+    Parser parser = Parser(stream, grammar);
+
+    EventCounter counter;
+    Parser::EventResult result = parser.parseEvents(counter);
+    assert(!result && result.error().type == ParserErrorType::LEXER_ERROR);
+    assert(counter.shifts == 7);
+  }
+
+  std::cout << "Token stream test passed!\n";
+}
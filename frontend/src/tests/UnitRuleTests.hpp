@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast/CExprGrammar.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/ActionTable.hpp"
+#include "parser/Parser.hpp"
+
+using namespace compiler;
+
+// Random C expression, every token separated by a space. `depth` bounds the
+// nesting so the corpus stays small.
+inline void generateCExpr(std::mt19937& rng, size_t depth,
+                          std::ostringstream& out) {
+  static constexpr const char* BINARY[] = {
+      "||", "&&", "|", "^",  "&", "==", "!=", "<", ">", "<=",
+      ">=", "<<", ">>", "+", "-", "*",  "/",  "%", ","};
+  static constexpr const char* ASSIGN[] = {"=",  "+=", "-=", "*=",  "/=", "%=",
+                                           "<<=", ">>=", "&=", "^=", "|="};
+  static constexpr const char* PREFIX[] = {"++", "--", "&", "*",
+                                           "+",  "-",  "~", "!"};
+  static constexpr const char* NAMES[] = {"a", "b", "c", "d"};
+
+  auto pick = [&](auto& options) {
+    return options[rng() % std::size(options)];
+  };
+
+  switch (depth == 0 ? rng() % 2 : rng() % 8) {
+    case 0:
+      out << pick(NAMES);
+      break;
+    case 1:
+      out << rng() % 100;
+      break;
+    case 2:
+    case 3:
+      generateCExpr(rng, depth - 1, out);
+      out << ' ' << pick(BINARY) << ' ';
+      generateCExpr(rng, depth - 1, out);
+      break;
+    case 4:
+      // Only a unary expression can be assigned to, keep it apart
+      out << "( " << pick(NAMES) << ' ' << pick(ASSIGN) << ' ';
+      generateCExpr(rng, depth - 1, out);
+      out << " )";
+      break;
+    case 5:
+      out << pick(PREFIX) << ' ';
+      generateCExpr(rng, depth - 1, out);
+      break;
+    case 6:
+      out << '(' << ' ';
+      generateCExpr(rng, depth - 1, out);
+      out << ' ' << ')' << (rng() % 2 ? " ++" : "");
+      break;
+    case 7:
+      generateCExpr(rng, depth - 1, out);
+      out << " ? ";
+      generateCExpr(rng, depth - 1, out);
+      out << " : ";
+      generateCExpr(rng, depth - 1, out);
+      break;
+  }
+}
+
+// S-expression of a parsed expression, unit rules leave no trace in it.
+// Names are spelled out when the source is given, uids are printed if not.
+inline void dumpCExpr(const ASTStorage& ast, Handle<ExprAST> expr,
+                      std::ostringstream& out, std::string_view source = {}) {
+  const ExprAST& node = ast[expr];
+  switch (node.type) {
+    case ExprAST::Type::ID:
+      if (source.empty()) {
+        out << ast.ids[node.index].uid;
+      } else {
+        out << ast.ids[node.index].id.view(source);
+      }
+      break;
+    case ExprAST::Type::LITERAL:
+      out << ast.literals[node.index].literal.integer;
+      break;
+    case ExprAST::Type::PAREN_EXPR:
+      out << "(";
+      dumpCExpr(ast, {node.index}, out, source);
+      out << ")";
+      break;
+    case ExprAST::Type::BINARY_EXPR: {
+      const BinaryExprAST& binary = ast.binary_exprs[node.index];
+      out << "(" << PunctuatorHandler::toString(binary.op) << " ";
+      dumpCExpr(ast, binary.left, out, source);
+      out << " ";
+      dumpCExpr(ast, binary.right, out, source);
+      out << ")";
+      break;
+    }
+    case ExprAST::Type::UNARY_EXPR:
+    case ExprAST::Type::POSTFIX_EXPR: {
+      const UnaryExprAST& unary = ast.unary_exprs[node.index];
+      out << "(" << PunctuatorHandler::toString(unary.op)
+          << (node.type == ExprAST::Type::POSTFIX_EXPR ? "post " : " ");
+      dumpCExpr(ast, unary.operand, out, source);
+      out << ")";
+      break;
+    }
+    case ExprAST::Type::CONDITIONAL_EXPR: {
+      const ConditionalExprAST& cond = ast.conditional_exprs[node.index];
+      out << "(? ";
+      dumpCExpr(ast, cond.condition, out, source);
+      out << " ";
+      dumpCExpr(ast, cond.then_expr, out, source);
+      out << " ";
+      dumpCExpr(ast, cond.else_expr, out, source);
+      out << ")";
+      break;
+    }
+    case ExprAST::Type::ERROR:
+      out << "<error>";
+      break;
+  }
+}
+
+// Everything a parse produced that both tables must agree on
+inline std::string dumpCParse(const Parser::ParserResult& result) {
+  std::ostringstream out;
+  if (!result) {
+    out << "fail " << static_cast<int>(result.error().type);
+    if (result.error().unex_symbol_error) {
+      const UnexpectedSymbolError& error = *result.error().unex_symbol_error;
+      out << " " << error.found.toString() << " at "
+          << error.lexer_state.column;
+    }
+    return out.str();
+  }
+  out << result->errors.size() << " ";
+  dumpCExpr(result->storage, {result->root}, out);
+  return out.str();
+}
+
+inline std::string parseCExpr(const Grammar& grammar, const ActionTable& table,
+                              const std::string& input) {
+  Lexer lexer("no_source.c", input);
+  TokenStream stream = TokenStream(lexer, 10);
+  Parser parser = Parser(stream, grammar, table);
+  return dumpCParse(parser.parse());
+}
+
+void testUnitRuleElimination() {
+  const Grammar grammar = C_EXPR_GRAMMAR.toGrammar();
+  const ActionTable plain(grammar, 1);
+  const ActionTable skipping(grammar, 1, /*skip_unit_rules=*/true);
+
+  // The merged states come on top of the LR(0) ones, at most one each
+  assert(skipping.stateCount() > plain.stateCount());
+  assert(skipping.stateCount() <= 2 * plain.stateCount());
+
+  // Precedence and associativity survive the shortcut
+  assert(parseCExpr(grammar, skipping, "1 + 2 * 3") == "0 (+ 1 (* 2 3))");
+  assert(parseCExpr(grammar, skipping, "1 - 2 - 3") == "0 (- (- 1 2) 3)");
+  assert(parseCExpr(grammar, skipping, "1 ? 2 : 3 ? 4 : 5") ==
+         "0 (? 1 2 (? 3 4 5))");
+  assert(parseCExpr(grammar, skipping, "- 1 ++ || ! 2") ==
+         "0 (|| (- (++post 1)) (! 2))");
+
+  // Differential test, a generated corpus and a broken copy of every
+  // expression in it must parse the same with both tables
+  std::mt19937 rng(20240611);
+  size_t broken = 0;
+  for (size_t i = 0; i < 500; ++i) {
+    std::ostringstream out;
+    generateCExpr(rng, 1 + i % 6, out);
+    const std::string input = out.str();
+    const std::string expected = parseCExpr(grammar, plain, input);
+    assert(expected.starts_with("0 "));
+    assert(parseCExpr(grammar, skipping, input) == expected);
+
+    // Drop one token
+    std::vector<std::string> tokens;
+    std::istringstream words(input);
+    for (std::string word; words >> word;) tokens.push_back(word);
+    tokens.erase(tokens.begin() + rng() % tokens.size());
+
+    std::string mutated;
+    for (const std::string& token : tokens) mutated += token + " ";
+    const std::string mutated_expected = parseCExpr(grammar, plain, mutated);
+    broken += !mutated_expected.starts_with("0 ");
+    assert(parseCExpr(grammar, skipping, mutated) == mutated_expected);
+  }
+  assert(broken > 0);
+
+  std::cout << "Unit rule elimination test passed!\n";
+}
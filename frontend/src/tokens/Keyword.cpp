@@ -38,6 +38,11 @@ namespace compiler {
         {"noreturn", Keyword::NORETURN},
         {"noexcept", Keyword::NOEXCEPT},
         {"pure", Keyword::PURE},
+        {"return", Keyword::RETURN},
+        {"struct", Keyword::STRUCT},
+        {"union", Keyword::UNION},
+        {"enum", Keyword::ENUM},
+        {"sizeof", Keyword::SIZEOF},
         {"void", Keyword::VOID},
         {"bool", Keyword::BOOL},
         {"char", Keyword::CHAR},
@@ -135,6 +140,16 @@ namespace compiler {
         return "noexcept";
       case Keyword::PURE:
         return "pure";
+      case Keyword::RETURN:
+        return "return";
+      case Keyword::STRUCT:
+        return "struct";
+      case Keyword::UNION:
+        return "union";
+      case Keyword::ENUM:
+        return "enum";
+      case Keyword::SIZEOF:
+        return "sizeof";
       case Keyword::VOID:
         return "void";
       case Keyword::BOOL:
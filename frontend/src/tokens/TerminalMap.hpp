@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Tokens.hpp"
+
+namespace compiler {
+
+  /**
+   * @brief Maps every kind of token to the terminal id a grammar gave it.
+   *
+   *        Keywords and punctuators each have a row indexed by their byte
+   *        value, every other token is mapped by its type alone, so all
+   *        literal kinds share the one literal terminal. Built once per
+   *        parse table and handed to the lexer, which stamps the id on every
+   *        token it produces.
+   */
+  struct TerminalMap {
+    std::array<uint16_t, 256> by_type;
+    std::array<uint16_t, 256> keywords;
+    std::array<uint16_t, 256> punctuators;
+
+    /**
+     * @brief Returns the terminal id of a token, NO_TERMINAL if the grammar
+     *        has no terminal for it.
+     *
+     * @param token
+     * @return uint16_t
+     */
+    uint16_t terminalOf(const Token& token) const {
+      switch (token.type) {
+        case TokenType::KEYWORD:
+          return keywords[static_cast<uint8_t>(token.value.keyword)];
+        case TokenType::PUNCTUATOR:
+          return punctuators[static_cast<uint8_t>(token.value.punctuator)];
+        default:
+          return by_type[static_cast<uint8_t>(token.type)];
+      }
+    }
+  };
+}  // namespace compiler
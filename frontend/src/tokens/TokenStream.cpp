@@ -5,7 +5,7 @@
 namespace compiler {
 
   TokenStream::TokenStream(Lexer& lexer, uint8_t buffer_size) noexcept
-      : lexer(lexer), bpos(0), buffer_size(buffer_size) {
+      : lexer(lexer), bpos(0), buffer_size(buffer_size), error_pos(0) {
     // Check buffer size before moving on
     if (buffer_size < 5) {
       std::cerr << "Buffer size for token stream needs"
@@ -14,8 +14,21 @@ namespace compiler {
 
     // Separate a new token buffer
     buffer = new Token[buffer_size]{};
+    spans = new Span[buffer_size]{};
+    last_span = {0, 0};
+    fill();
+  }
 
+  TokenStream::~TokenStream() noexcept {
+    // Free buffer from memory
+    delete[] buffer;
+    delete[] spans;
+  }
+
+  void TokenStream::fill() noexcept {
     // Pre-fill the buffer with the first N amount of tokens.
+    bpos = 0;
+    lex_error.reset();
     do {
       Lexer::LexerResult result = lexer.advance();
 
@@ -26,10 +39,12 @@ namespace compiler {
                   << error.state.column << " on token "
                   << error.state.last_token.toString(lexer.source) << ": "
                   << error.toString() << "\n";
+        stopAt(std::move(error));
         break;
       }
 
       // Fill the buffer and move to the next slot.
+      spans[bpos] = lexedSpan(*result);
       buffer[bpos++] = *result;
 
       // If we reached the end, stop filling the buffer
@@ -42,31 +57,51 @@ namespace compiler {
     bpos = 0;
   }
 
-  TokenStream::~TokenStream() noexcept {
-    // Free buffer from memory
-    delete[] buffer;
-  }
-
   Lexer::LexerResult TokenStream::next() {
-    // Advance to the next token
-    Lexer::LexerResult result = lexer.advance();
-
-    // Check for any token defect
-    if (!result) {
-      return result;
+    // Every token before the error was handed out, the error stands for
+    // the rest of the source
+    if (lex_error && bpos == error_pos) {
+      return std::unexpected(*lex_error);
     }
 
     // If there are no more tokens left, meaning we reached ENDOF
     // it will keep returning ENDOF token.
-    if (!hasNext()) return result;
+    if (!hasNext()) {
+      Lexer::LexerResult result = lexer.advance();
+      if (result) last_span = lexedSpan(*result);
+      return result;
+    }
 
     // Cache the current token and consume it from buffer by
-    // replacing it with the next token from the lexer.
+    // replacing it with the next token from the lexer. Once the lexer has
+    // failed nothing is lexed anymore, the buffer only drains.
+    // The position wraps at the buffer size itself, wrapping at the range
+    // of `bpos` would skip slots of buffers that do not divide it.
     Token token = peek();
-    buffer[bpos++ % buffer_size] = *result;
+    last_span = spans[bpos];
+    if (!lex_error) {
+      Lexer::LexerResult result = lexer.advance();
+      if (result) {
+        spans[bpos] = lexedSpan(*result);
+        buffer[bpos] = *result;
+      } else {
+        stopAt(result.error());
+      }
+    }
+    bpos = (bpos + 1) % buffer_size;
     return token;
   }
 
+  void TokenStream::stopAt(LexerError error) noexcept {
+    // The slot at `bpos` is the one after the last token lexed. It reads
+    // as the end of the tokens for anyone peeking that far.
+    lex_error = std::move(error);
+    error_pos = bpos;
+    buffer[bpos] = Token::endOF();
+    spans[bpos] = {static_cast<uint32_t>(lexer.pos),
+                   static_cast<uint32_t>(lexer.pos)};
+  }
+
   const Token& TokenStream::peek() const noexcept {
     // Return the current token being pointed in buffer.
     return buffer[bpos % buffer_size];
@@ -83,8 +118,37 @@ namespace compiler {
     return buffer[bpos % buffer_size].type != TokenType::ENDOF;
   }
 
-  const LexerState& TokenStream::state() const noexcept {
+  LexerState TokenStream::state() const noexcept {
     return lexer.state();
   }
 
+  std::string_view TokenStream::source() const noexcept {
+    return lexer.source;
+  }
+
+  void TokenStream::reset(std::string_view filename, std::string_view source,
+                          size_t offset) noexcept {
+    lexer.reset(filename, source);
+    if (offset > 0) lexer.seek(offset);
+    fill();
+  }
+
+  std::string_view TokenStream::filename() const noexcept {
+    return lexer.filename;
+  }
+
+  TokenStream::Span TokenStream::lexedSpan(const Token& token) const noexcept {
+    // The end of file is reported without starting a token
+    const size_t start =
+        token.type == TokenType::ENDOF ? lexer.pos : lexer.token_start_pos;
+    return {static_cast<uint32_t>(start), static_cast<uint32_t>(lexer.pos)};
+  }
+
+  void TokenStream::mapTerminals(const TerminalMap& map) noexcept {
+    lexer.mapTerminals(&map);
+    for (uint8_t i = 0; i < buffer_size; ++i) {
+      buffer[i].terminal = map.terminalOf(buffer[i]);
+    }
+  }
+
 }  // namespace compiler
\ No newline at end of file
@@ -1,10 +1,22 @@
 #pragma once
 
+#include <optional>
+
 #include "lexer/Lexer.hpp"
 
 namespace compiler {
 
   class TokenStream final {
+  public:
+    /**
+     * @brief Where a token lies in the source, as byte offsets.
+     *
+     */
+    struct Span {
+      uint32_t start;
+      uint32_t end;
+    };
+
   public:
     /**
      * @brief Construct a new Token Stream object
@@ -15,6 +27,9 @@ namespace compiler {
     explicit TokenStream(Lexer& lexer, uint8_t buffer_size) noexcept;
     ~TokenStream() noexcept;
 
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+
   public:
     /**
      * @brief Checks if there is a next token in the stream.
@@ -45,18 +60,72 @@ namespace compiler {
      */
     Lexer::LexerResult next();
 
+    /**
+     * @brief Returns where the token last returned by next() lies in the
+     *        source.
+     *
+     * @return Span
+     */
+    Span span() const noexcept { return last_span; }
+
     /**
      * @brief Returns the current state of the lexer.
      *
-     * @return const LexerState&
+     * @return LexerState
+     */
+    LexerState state() const noexcept;
+
+    /**
+     * @brief Returns the source code the tokens are read from.
+     *
+     * @return std::string_view
      */
-    const LexerState& state() const noexcept;
+    std::string_view source() const noexcept;
+
+    /**
+     * @brief Returns the name of the source the tokens are read from.
+     *
+     * @return std::string_view
+     */
+    std::string_view filename() const noexcept;
+
+    /**
+     * @brief Maps every token of the stream to its terminal id, including
+     *        the ones already buffered. The map must outlive the stream.
+     *
+     * @param map
+     */
+    void mapTerminals(const TerminalMap& map) noexcept;
+
+    /**
+     * @brief Restarts the lexer on a new source and refills the token
+     *        buffer in place.
+     *
+     * @param filename
+     * @param source
+     * @param offset where to start lexing, between two tokens
+     */
+    void reset(std::string_view filename, std::string_view source,
+               size_t offset = 0) noexcept;
+
+  private:
+    void fill() noexcept;
+    void stopAt(LexerError error) noexcept;
+    Span lexedSpan(const Token& token) const noexcept;
 
   private:
     Lexer& lexer;
     uint8_t bpos;
     uint8_t buffer_size;
     Token* buffer;
+    Span* spans;
+    Span last_span;
+
+    // The lexer stops at its first error. The error takes the buffer slot
+    // of the token it stopped, so it is only handed out once every token
+    // lexed before it has been.
+    std::optional<LexerError> lex_error;
+    uint8_t error_pos;
   };
 
 }  // namespace compiler
\ No newline at end of file
@@ -98,13 +98,17 @@ namespace compiler {
     EndOfFile eof;          // End of file
   };
 
+  // Terminal id of a token the lexer has no grammar to map for.
+  constexpr uint16_t NO_TERMINAL = static_cast<uint16_t>(-1);
+
   /**
    * @brief Representation of a token. This holds the value and the type of what
-   *        it is.
+   *        it is, and the terminal id the parser's grammar gave it.
    *
    */
   struct Token {
     TokenType type;
+    uint16_t terminal = NO_TERMINAL;
     TokenValue value;
 
     std::string toString(std::string_view source) const noexcept;
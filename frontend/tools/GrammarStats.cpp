@@ -0,0 +1,302 @@
+// Reports what a grammar costs the parser: its states, the conflicts left
+// in its table with the items behind them, how full the action and goto
+// tables are, what they would take under other encodings and how long each
+// phase of their construction took.
+//
+// Run it before and after a grammar change to see what the change costs.
+//
+// usage: grammar_stats [grammar]
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast/CExprGrammar.hpp"
+#include "ast/CGrammar.hpp"
+#include "parser/ActionTable.hpp"
+#include "parser/Grammar.hpp"
+
+using namespace compiler;
+
+namespace {
+  struct NamedGrammar {
+    const char* name;
+    Grammar (*make)();
+  };
+
+  // Grammars the tool knows about, the first one is the default
+  constexpr NamedGrammar GRAMMARS[] = {
+      {"c_expr", [] { return C_EXPR_GRAMMAR.toGrammar(); }},
+      {"c", [] { return C_GRAMMAR.toGrammar(); }},
+  };
+
+  std::string itemString(const Grammar& grammar, uint32_t rule,
+                         size_t dot) {
+    const Rule r = grammar[rule];
+    std::string text =
+        Symbol{.type = Symbol::Type::NON_TERMINAL, .nonterminal = r.lhs}
+            .toString() +
+        " ->";
+    for (size_t i = 0; i <= r.rhs.size(); ++i) {
+      if (i == dot) text += " .";
+      if (i < r.rhs.size()) text += " " + r.rhs[i].toString();
+    }
+    return text;
+  }
+
+  std::string actionString(const Action& action) {
+    switch (action.type) {
+      case Action::SHIFT:
+        return "shift " + std::to_string(action.next_state);
+      case Action::REDUCE:
+        return "reduce " + std::to_string(action.rule_index);
+      case Action::ACCEPT:
+        return "accept";
+      default:
+        return "error";
+    }
+  }
+
+  // The items of a state that call for an action of a conflict cell
+  std::vector<std::string> itemsBehind(const Grammar& grammar,
+                                       const ActionTable& table, size_t state,
+                                       SymbolId terminal,
+                                       const Action& action) {
+    std::vector<std::string> items;
+    for (const ActionTable::Item& item : table.states[state]) {
+      std::span<const Symbol> rhs = grammar.rhsOf(item.rule_index);
+      const bool complete = item.dot_position == rhs.size();
+      const bool matches =
+          action.type == Action::SHIFT
+              ? !complete &&
+                    table.symbols.idOf(rhs[item.dot_position]) == terminal
+              : complete && (action.type == Action::ACCEPT ||
+                             item.rule_index == action.rule_index);
+      if (matches) {
+        items.push_back(
+            itemString(grammar, item.rule_index, item.dot_position));
+      }
+    }
+    return items;
+  }
+
+  void reportConflicts(const Grammar& grammar, const ActionTable& table) {
+    // Cells where the table's own resolution is an action the lookahead
+    // rules out, the parser takes a wrong turn there
+    size_t misresolved = 0;
+    for (size_t state = 0; state < table.states.size(); ++state) {
+      for (SymbolId t = 0; t < table.symbols.terminalCount(); ++t) {
+        std::span<const Action> actions = table.conflictsAt(state, t);
+        misresolved += !actions.empty() &&
+                       !(actions.front() == table.actionFrom(state, t));
+      }
+    }
+
+    std::cout << "conflicts (SLR(1) lookaheads): " << table.conflictCount()
+              << " cells, " << misresolved << " resolved against them\n";
+
+    for (size_t state = 0; state < table.states.size(); ++state) {
+      for (SymbolId t = 0; t < table.symbols.terminalCount(); ++t) {
+        std::span<const Action> actions = table.conflictsAt(state, t);
+        if (actions.size() < 2) continue;
+
+        std::cout << "  state " << state << " on "
+                  << table.symbols.symbolOf(t).toString() << ", resolved to "
+                  << actionString(actions.front()) << "\n";
+        for (const Action& action : actions) {
+          std::cout << "    " << actionString(action) << "\n";
+          for (const std::string& item :
+               itemsBehind(grammar, table, state, t, action)) {
+            std::cout << "      [" << item << "]\n";
+          }
+        }
+      }
+    }
+  }
+
+  // Cells of a table flattened to one code each, `empty` for blank cells
+  struct Cells {
+    size_t rows;
+    size_t columns;
+    std::vector<uint64_t> codes;
+    uint64_t empty;
+    size_t cell_bytes;
+  };
+
+  Cells actionCells(const ActionTable& table) {
+    Cells cells{table.stateCount(), table.symbols.terminalCount(), {},
+                Action::ERROR, sizeof(Action)};
+    for (const Action& action : table.actions) {
+      cells.codes.push_back(
+          (static_cast<uint64_t>(action.type) << 32) |
+          (action.type == Action::REDUCE || action.type == Action::SHIFT
+               ? action.rule_index
+               : 0));
+    }
+    return cells;
+  }
+
+  Cells gotoCells(const ActionTable& table) {
+    return {table.stateCount(), table.symbols.nonTerminalCount(),
+            std::vector<uint64_t>(table.gotos.begin(), table.gotos.end()),
+            static_cast<uint32_t>(-1), sizeof(uint32_t)};
+  }
+
+  size_t usedCells(const Cells& cells) {
+    return std::count_if(cells.codes.begin(), cells.codes.end(),
+                         [&](uint64_t code) { return code != cells.empty; });
+  }
+
+  // An unordered_map from (row, column) to the cell, blank cells left out
+  size_t hashBytes(const Cells& cells) {
+    std::unordered_map<uint64_t, uint64_t> map;
+    for (size_t i = 0; i < cells.codes.size(); ++i) {
+      if (cells.codes[i] != cells.empty) map.emplace(i, cells.codes[i]);
+    }
+    const size_t node_bytes = sizeof(void*) + sizeof(uint64_t) +
+                              std::max(cells.cell_bytes, sizeof(uint64_t));
+    return map.size() * node_bytes + map.bucket_count() * sizeof(void*);
+  }
+
+  // The columns of every row that differ from its most common cell, the
+  // only ones an encoding with a default per row has to store
+  std::vector<std::vector<size_t>> significantColumns(const Cells& cells) {
+    std::vector<std::vector<size_t>> rows(cells.rows);
+    for (size_t r = 0; r < cells.rows; ++r) {
+      const uint64_t* row = &cells.codes[r * cells.columns];
+      std::unordered_map<uint64_t, size_t> counts;
+      for (size_t c = 0; c < cells.columns; ++c) ++counts[row[c]];
+      const uint64_t fallback =
+          std::max_element(counts.begin(), counts.end(),
+                           [](const auto& a, const auto& b) {
+                             return a.second < b.second;
+                           })
+              ->first;
+      for (size_t c = 0; c < cells.columns; ++c) {
+        if (row[c] != fallback) rows[r].push_back(c);
+      }
+    }
+    return rows;
+  }
+
+  // Row displacement with a default per row: the significant cells of all
+  // rows are overlaid in one array where a check entry tells which row a
+  // slot belongs to.
+  size_t compressedBytes(const Cells& cells) {
+    const std::vector<std::vector<size_t>> rows = significantColumns(cells);
+
+    // Densest rows first, first fit for each
+    std::vector<size_t> order(cells.rows);
+    for (size_t r = 0; r < cells.rows; ++r) order[r] = r;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return rows[a].size() > rows[b].size();
+    });
+
+    std::vector<bool> taken;
+    size_t length = 0;
+    for (size_t r : order) {
+      if (rows[r].empty()) continue;
+      size_t base = 0;
+      while (std::any_of(rows[r].begin(), rows[r].end(), [&](size_t c) {
+        return base + c < taken.size() && taken[base + c];
+      })) {
+        ++base;
+      }
+      for (size_t c : rows[r]) {
+        if (base + c >= taken.size()) taken.resize(base + c + 1, false);
+        taken[base + c] = true;
+      }
+      length = std::max(length, base + rows[r].back() + 1);
+    }
+
+    // Base and default per row, a cell and a check per slot
+    return cells.rows * (sizeof(uint32_t) + cells.cell_bytes) +
+           length * (cells.cell_bytes + sizeof(uint32_t));
+  }
+
+  void reportTable(const char* title, const ActionTable& table) {
+    const Cells actions = actionCells(table);
+    const Cells gotos = gotoCells(table);
+
+    // LR(0) states reduce on every terminal, so most action rows are
+    // full. The cells that differ from their row's default tell more.
+    auto density = [](const char* name, const Cells& cells) {
+      const size_t used = usedCells(cells);
+      size_t significant = 0;
+      for (const std::vector<size_t>& row : significantColumns(cells)) {
+        significant += row.size();
+      }
+      std::cout << "    " << std::left << std::setw(8) << name << std::right
+                << used << " / " << cells.codes.size() << " cells ("
+                << std::fixed << std::setprecision(1)
+                << 100.0 * used / std::max<size_t>(cells.codes.size(), 1)
+                << "%), " << significant << " beside the row defaults\n";
+    };
+    auto memory = [&](const char* name, size_t action_bytes,
+                      size_t goto_bytes) {
+      std::cout << "    " << std::left << std::setw(12) << name << std::right
+                << std::setw(8) << action_bytes + goto_bytes << " ("
+                << action_bytes << " + " << goto_bytes << ")\n";
+    };
+
+    std::cout << title << ": " << table.stateCount() << " states\n"
+              << "  density\n";
+    density("action", actions);
+    density("goto", gotos);
+
+    std::cout << "  memory in bytes (action + goto)\n";
+    memory("dense", actions.codes.size() * actions.cell_bytes,
+           gotos.codes.size() * gotos.cell_bytes);
+    memory("hash", hashBytes(actions), hashBytes(gotos));
+    memory("compressed", compressedBytes(actions), compressedBytes(gotos));
+
+    const ActionTable::BuildTimes& times = table.buildTimes();
+    std::cout << "  construction in us\n";
+    for (const auto& [name, time] :
+         {std::pair{"rules", times.rules}, {"states", times.states},
+          {"tables", times.tables}, {"unit rules", times.unit_rules},
+          {"conflicts", times.conflicts},
+          {"diagnostics", times.diagnostics}}) {
+      std::cout << "    " << std::left << std::setw(12) << name << std::right
+                << std::setw(8) << time.count() / 1000 << "\n";
+    }
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  const NamedGrammar* named = &GRAMMARS[0];
+  if (argc > 1) {
+    named = nullptr;
+    for (const NamedGrammar& candidate : GRAMMARS) {
+      if (std::strcmp(candidate.name, argv[1]) == 0) named = &candidate;
+    }
+  }
+  if (argc > 2 || named == nullptr) {
+    std::cerr << "usage: grammar_stats [grammar]\ngrammars:";
+    for (const NamedGrammar& candidate : GRAMMARS) {
+      std::cerr << " " << candidate.name;
+    }
+    std::cerr << "\n";
+    return 1;
+  }
+
+  const Grammar grammar = named->make();
+  const ActionTable table(grammar, 1);
+  const ActionTable skipping(grammar, 1, /*skip_unit_rules=*/true);
+
+  std::cout << "grammar " << named->name << ": " << grammar.size()
+            << " rules, " << table.symbols.terminalCount() << " terminals, "
+            << table.symbols.nonTerminalCount() << " non-terminals\n"
+            << "LR(0) states: " << table.states.size() << "\n"
+            << "LALR(1) states: " << table.states.size()
+            << " (the LR(0) cores, only lookaheads differ)\n";
+
+  reportConflicts(grammar, table);
+  reportTable("table", table);
+  reportTable("table skipping unit rules", skipping);
+  return 0;
+}
@@ -0,0 +1,230 @@
+// Emits the LR automaton of the C expression grammar as C++ code.
+//
+// Every state becomes a labelled block that switches over the terminal id
+// of the lookahead and jumps straight to the next state, every rule a block
+// that runs its reduction and switches over the uncovered state to find its
+// goto. The result defines Parser::parseDirect(), which the parser runs
+// instead of its table-driven loop when it is built with
+// FRONTEND_DIRECT_PARSER and handed this exact grammar.
+//
+// usage: parser_codegen <output.cpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ast/CExprGrammar.hpp"
+#include "parser/ActionTable.hpp"
+#include "parser/Grammar.hpp"
+
+using namespace compiler;
+
+namespace {
+  // Where the generated code comes from
+  constexpr const char* GRAMMAR_HEADER = "ast/CExprGrammar.hpp";
+  constexpr const char* GRAMMAR_NAME = "C_EXPR_GRAMMAR";
+
+  std::string hex(uint64_t value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "0x%016llxull",
+                  static_cast<unsigned long long>(value));
+    return buffer;
+  }
+
+  // Writes `case a: case b: ...` for a group of ids, a few per line
+  void emitCases(std::ostream& out, const std::vector<size_t>& ids,
+                 const char* indent) {
+    for (size_t i = 0; i < ids.size(); ++i) {
+      out << (i % 6 == 0 ? indent : " ") << "case " << ids[i] << ":";
+      if (i % 6 == 5 || i + 1 == ids.size()) out << "\n";
+    }
+  }
+
+  void emitAction(std::ostream& out, const Action& action,
+                  const char* indent) {
+    switch (action.type) {
+      case Action::SHIFT:
+        out << indent << "SHIFT(" << action.next_state << ");\n";
+        break;
+      case Action::REDUCE:
+        out << indent << "goto reduce_" << action.rule_index << ";\n";
+        break;
+      case Action::ACCEPT:
+        out << indent << "return accept();\n";
+        break;
+      case Action::ERROR:
+        out << indent << "goto error;\n";
+        break;
+    }
+  }
+
+  void emitState(std::ostream& out, const ActionTable& table, size_t state) {
+    const size_t terminal_count = table.symbols.terminalCount();
+
+    // Group the terminals by action, the most common one becomes the
+    // default of the switch. LR(0) states reduce on every terminal they
+    // do not shift, so most states end up with a handful of cases.
+    std::vector<Action> actions;
+    std::vector<std::vector<size_t>> terminals;
+    for (size_t t = 0; t < terminal_count; ++t) {
+      const Action action = table.actionFrom(state, t);
+      size_t group = 0;
+      while (group < actions.size() && !(actions[group] == action)) ++group;
+      if (group == actions.size()) {
+        actions.push_back(action);
+        terminals.emplace_back();
+      }
+      terminals[group].push_back(t);
+    }
+
+    size_t common = 0;
+    for (size_t group = 1; group < actions.size(); ++group) {
+      if (terminals[group].size() > terminals[common].size()) common = group;
+    }
+
+    out << "  state_" << state << ":\n";
+    if (actions.size() == 1) {
+      emitAction(out, actions[0], "    ");
+      return;
+    }
+
+    out << "    switch (*lookahead) {\n";
+    for (size_t group = 0; group < actions.size(); ++group) {
+      if (group == common) continue;
+      emitCases(out, terminals[group], "      ");
+      emitAction(out, actions[group], "        ");
+    }
+    out << "      default:\n";
+    emitAction(out, actions[common], "        ");
+    out << "    }\n";
+  }
+
+  void emitReduction(std::ostream& out, const Grammar& grammar,
+                     const ActionTable& table, size_t rule) {
+    const Grammar::Record& record = grammar.recordOf(rule);
+    const SymbolId lhs = table.lhsOf(rule);
+
+    out << "  reduce_" << rule << ":\n";
+    out << "    rhs = symbols.peekTop(" << record.length << ");\n";
+    if (record.handler) {
+      out << "    node = grammar.recordOf(" << rule
+          << ").handler(program.storage, rhs);\n";
+    } else if (record.length == 0) {
+      out << "    node = NO_INDEX;\n";
+    } else {
+      out << "    node = rhs.front().node;\n";
+    }
+    out << "    symbols.pop(" << record.length << ");\n";
+
+    // Goto on the LHS from whichever state the pop uncovered
+    std::map<ActionTable::State, std::vector<size_t>> targets;
+    for (size_t state = 0; state < table.stateCount(); ++state) {
+      const ActionTable::State target = table.gotoFrom(state, lhs);
+      if (target != ActionTable::NO_STATE) targets[target].push_back(state);
+    }
+
+    out << "    switch (symbols.peekTop().state) {\n";
+    for (const auto& [target, states] : targets) {
+      emitCases(out, states, "      ");
+      out << "        GOTO(" << lhs << ", " << target << ");\n";
+    }
+    out << "      default:\n";
+    out << "        return ParserError::makeInternalError();\n";
+    out << "    }\n";
+  }
+
+  void emitParser(std::ostream& out, const Grammar& grammar,
+                  const ActionTable& table) {
+    out << "// Generated by parser_codegen from " << GRAMMAR_NAME
+        << ", do not edit.\n\n";
+    out << "#include \"" << GRAMMAR_HEADER << "\"\n";
+    out << "#include \"parser/Parser.hpp\"\n\n";
+    out << "namespace compiler {\n\n";
+
+    out << "  bool Parser::hasDirectCode(const Grammar& grammar) {\n";
+    out << "    static const Grammar generated = " << GRAMMAR_NAME
+        << ".toGrammar();\n";
+    out << "    return GrammarHash{}(grammar) == "
+        << hex(GrammarHash{}(grammar)) << " &&\n";
+    out << "           grammar == generated;\n";
+    out << "  }\n\n";
+
+    // SHIFT pushes the token and moves on to the next one, GOTO pushes the
+    // reduced non-terminal. Both jump to the state they pushed.
+    out << R"(#define SHIFT(next)                                          \
+  do {                                                       \
+    symbols.push({action_table.symbols.symbolOf(*lookahead), \
+                  next, shiftNode()});                       \
+    lookahead = nextSymbol();                                \
+    if (!lookahead) return std::unexpected(lookahead.error()); \
+    if (recovering > 0) --recovering;                        \
+    goto state_##next;                                       \
+  } while (0)
+
+#define GOTO(lhs, next)                                           \
+  do {                                                            \
+    symbols.push({action_table.symbols.symbolOf(lhs), next, node}); \
+    goto state_##next;                                            \
+  } while (0)
+
+)";
+
+    out << "  Parser::ParseStatus Parser::parseDirect() {\n";
+    out << "    std::span<const ASTSymbolState> rhs;\n";
+    out << "    Index node = NO_INDEX;\n\n";
+    out << "    if (!lookahead) return std::unexpected(lookahead.error());\n";
+    out << "    goto state_0;\n\n";
+
+    for (size_t state = 0; state < table.stateCount(); ++state) {
+      emitState(out, table, state);
+    }
+    out << "\n";
+    for (size_t rule = 1; rule < grammar.size(); ++rule) {
+      emitReduction(out, grammar, table, rule);
+    }
+
+    out << "\n  error:\n";
+    out << "    if (recovering == 0) {\n";
+    out << "      program.errors.push_back(actionError());\n";
+    out << "    }\n";
+    out << "    if (!recover()) {\n";
+    out << "      return std::unexpected(std::move(program.errors.front()));\n";
+    out << "    }\n";
+    out << "    if (!lookahead) return std::unexpected(lookahead.error());\n";
+    out << "    switch (symbols.peekTop().state) {\n";
+    for (size_t state = 0; state < table.stateCount(); ++state) {
+      out << "      case " << state << ": goto state_" << state << ";\n";
+    }
+    out << "      default:\n";
+    out << "        return ParserError::makeInternalError();\n";
+    out << "    }\n";
+    out << "  }\n\n";
+
+    out << "#undef GOTO\n";
+    out << "#undef SHIFT\n";
+    out << "}  // namespace compiler\n";
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "usage: parser_codegen <output.cpp>\n";
+    return 1;
+  }
+
+  // Same table the parser gets from the TableCache, so the generated state
+  // numbers match its diagnostics.
+  const Grammar grammar = C_EXPR_GRAMMAR.toGrammar();
+  const ActionTable table(grammar, 0);
+
+  std::ofstream out(argv[1]);
+  if (!out) {
+    std::cerr << "parser_codegen: cannot write " << argv[1] << "\n";
+    return 1;
+  }
+  emitParser(out, grammar, table);
+  return out ? 0 : 1;
+}